@@ -0,0 +1,157 @@
+#ifndef __GENESIS_EMULATION_THREAD_H__
+#define __GENESIS_EMULATION_THREAD_H__
+
+#include "smd/smd.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+
+namespace genesis
+{
+
+/* Runs emulation on a dedicated thread, so the front-end thread can present frames and handle input
+ * without stalling emulation. Completed frames are passed through the VDP framebuffer (lock-free),
+ * the only other synchronization point is an explicit pause request at the frame end.
+ *
+ * VDP frame end callback is owned by this class. */
+class emulation_thread
+{
+public:
+	emulation_thread(genesis::smd& smd) : m_smd(smd)
+	{
+		m_smd.vdp().on_frame_end([this]() { on_frame_end(); });
+		m_thread = std::thread([this]() { run(); });
+	}
+
+	~emulation_thread()
+	{
+		request_stop_and_join();
+	}
+
+	// is emulation still running (it stops on request or on exception)
+	bool is_running() const
+	{
+		return m_running.load(std::memory_order_acquire);
+	}
+
+	// stop emulation and wait for the thread, rethrows the exception emulation was stopped by (if any)
+	void stop()
+	{
+		request_stop_and_join();
+
+		if(m_exception != nullptr)
+			std::rethrow_exception(std::exchange(m_exception, nullptr));
+	}
+
+	/* Pause emulation at the next frame end and call func while it is paused,
+	 * so func can safely access emulated state (e.g. to draw debug views).
+	 * If emulation is already stopped, func is called right away. */
+	template <class Callable>
+	void with_paused(Callable func)
+	{
+		std::unique_lock lock(m_mutex);
+		m_pause_requested.store(true, std::memory_order_relaxed);
+		m_cv.wait(lock, [this]() { return m_paused || !is_running(); });
+
+		func();
+
+		m_pause_requested.store(false, std::memory_order_relaxed);
+		lock.unlock();
+		m_cv.notify_all();
+	}
+
+private:
+	void request_stop_and_join()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_stop_requested.store(true, std::memory_order_relaxed);
+		}
+		m_cv.notify_all();
+
+		if(m_thread.joinable())
+			m_thread.join();
+	}
+
+	void run()
+	{
+		try
+		{
+			const auto batch_frames = 60;
+			auto frames = 0;
+
+			auto start = std::chrono::high_resolution_clock::now();
+			auto start_mclk = m_smd.mclk();
+
+			while(!m_stop_requested.load(std::memory_order_relaxed))
+			{
+				m_smd.run_frame();
+				++frames;
+
+				if(frames == batch_frames)
+				{
+					auto stop = std::chrono::high_resolution_clock::now();
+					auto dur = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
+					double ns_per_cycle = double(dur.count()) / (m_smd.mclk() - start_mclk);
+					std::cout << "ns per cycle: " << ns_per_cycle << '\n';
+
+					start = stop;
+					start_mclk = m_smd.mclk();
+					frames = 0;
+				}
+			}
+		}
+		catch(...)
+		{
+			m_exception = std::current_exception();
+		}
+
+		{
+			std::lock_guard lock(m_mutex);
+			m_running.store(false, std::memory_order_release);
+		}
+		m_cv.notify_all();
+	}
+
+	// called by the emulation thread, it is the only point where emulation can be paused
+	void on_frame_end()
+	{
+		// do not take the lock if pause was not requested
+		if(!m_pause_requested.load(std::memory_order_relaxed))
+			return;
+
+		std::unique_lock lock(m_mutex);
+		m_paused = true;
+		m_cv.notify_all();
+		m_cv.wait(lock, [this]() {
+			return !m_pause_requested.load(std::memory_order_relaxed) || m_stop_requested.load(std::memory_order_relaxed);
+		});
+		m_paused = false;
+	}
+
+private:
+	genesis::smd& m_smd;
+	std::thread m_thread;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+
+	std::atomic<bool> m_running = true;
+	std::atomic<bool> m_pause_requested = false;
+	std::atomic<bool> m_stop_requested = false;
+	bool m_paused = false;
+
+	std::exception_ptr m_exception;
+};
+
+} // namespace genesis
+
+#endif // __GENESIS_EMULATION_THREAD_H__
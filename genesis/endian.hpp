@@ -51,6 +51,15 @@ void sys_to_little(T& val)
 }
 
 
+// convert value between the system byte order and the specified one
+template <class T>
+void sys_convert(T& val, std::endian byte_order)
+{
+	if(byte_order != std::endian::native)
+		swap(val);
+}
+
+
 [[maybe_unused]] static void swap_nibbles(std::uint8_t& val)
 {
 	val = (val >> 4) | (val << 4);
@@ -0,0 +1,258 @@
+#include "io_ports/input_device.h"
+#include "rom.h"
+#include "smd/smd.h"
+
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+
+using namespace genesis;
+
+/* Headless runner: executes N frames without any video/input and reports emulation throughput. */
+
+class null_input_device : public io_ports::input_device
+{
+public:
+	bool is_key_pressed(io_ports::key_type) override
+	{
+		return false;
+	}
+};
+
+struct options
+{
+	std::string_view rom_path;
+	std::uint64_t frames = 600;
+	bool json = false;
+	// sampled device timing slows emulation down, so throughput is measured without it by default
+	bool profile = false;
+	smd::m68k_mode m68k_mode = smd::m68k_mode::cycle_accurate;
+	unsigned render_threads = 0;
+};
+
+struct report
+{
+	std::string rom_title;
+	std::uint64_t frames;
+	std::uint64_t mclk;
+	std::chrono::nanoseconds wall_time;
+	smd::profile profile;
+	bool profiled;
+};
+
+void print_usage(const char* prog_path)
+{
+	std::cout << "Usage ." << std::filesystem::path::preferred_separator << prog_path
+			  << " <path to rom> [--frames N] [--json] [--profile] [--m68k-instruction-level]"
+			  << " [--render-threads N]\n";
+}
+
+// the whole string must be a number which fits into T
+template <class T>
+bool parse_number(std::string_view str, T& value)
+{
+	auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+	return ec == std::errc{} && ptr == str.data() + str.size();
+}
+
+bool parse_options(int args, char* argv[], options& opts)
+{
+	if(args < 2)
+		return false;
+
+	opts.rom_path = argv[1];
+
+	for(int i = 2; i < args; ++i)
+	{
+		std::string_view arg = argv[i];
+
+		if(arg == "--json")
+		{
+			opts.json = true;
+		}
+		else if(arg == "--profile")
+		{
+			opts.profile = true;
+		}
+		else if(arg == "--m68k-instruction-level")
+		{
+			opts.m68k_mode = smd::m68k_mode::instruction_level;
+		}
+		else if(arg == "--render-threads" && i + 1 < args)
+		{
+			if(!parse_number(argv[++i], opts.render_threads))
+				return false;
+		}
+		else if(arg == "--frames" && i + 1 < args)
+		{
+			if(!parse_number(argv[++i], opts.frames) || opts.frames == 0)
+				return false;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// header strings are padded with spaces or NULs
+std::string_view trim_padding(std::string_view str)
+{
+	constexpr std::string_view padding{" \0", 2};
+
+	auto first = str.find_first_not_of(padding);
+	if(first == std::string_view::npos)
+		return {};
+
+	return str.substr(first, str.find_last_not_of(padding) - first + 1);
+}
+
+std::string get_rom_title(const genesis::rom& rom)
+{
+	const auto& header = rom.header();
+
+	auto overseas = trim_padding(header.game_name_overseas);
+	if(!overseas.empty())
+		return std::string{overseas};
+	return std::string{trim_padding(header.game_name_domestic)};
+}
+
+std::string json_escape(std::string_view str)
+{
+	std::stringstream ss;
+	for(char c : str)
+	{
+		switch(c)
+		{
+		case '"':
+			ss << "\\\"";
+			break;
+		case '\\':
+			ss << "\\\\";
+			break;
+		default:
+			if(static_cast<unsigned char>(c) < 0x20)
+				ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+			else
+				ss << c;
+		}
+	}
+	return ss.str();
+}
+
+double to_ms(std::chrono::nanoseconds ns)
+{
+	return ns.count() / 1'000'000.0;
+}
+
+double per_second(std::uint64_t value, std::chrono::nanoseconds ns)
+{
+	return value * 1'000'000'000.0 / ns.count();
+}
+
+double share(std::chrono::nanoseconds part, std::chrono::nanoseconds total)
+{
+	return total.count() == 0 ? 0 : part.count() * 100.0 / total.count();
+}
+
+void print_text(const report& rep)
+{
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "ROM: " << rep.rom_title << '\n';
+	std::cout << "Frames: " << rep.frames << '\n';
+	std::cout << "Master cycles: " << rep.mclk << '\n';
+	std::cout << "Wall time: " << to_ms(rep.wall_time) << " ms\n";
+	std::cout << "Frames per second: " << per_second(rep.frames, rep.wall_time) << '\n';
+	std::cout << "Master cycles per second: " << per_second(rep.mclk, rep.wall_time) << '\n';
+	std::cout << "ns per master cycle: " << double(rep.wall_time.count()) / rep.mclk << '\n';
+
+	if(!rep.profiled)
+		return;
+
+	auto print_device = [&rep](std::string_view name, const smd::device_profile& prof) {
+		auto time = rep.profile.time(prof);
+		std::cout << "  " << std::setw(5) << std::left << name << std::right << to_ms(time) << " ms ("
+				  << share(time, rep.wall_time) << "%), " << prof.calls << " calls\n";
+	};
+
+	std::cout << "Device time (sampled):\n";
+	print_device("m68k", rep.profile.m68k);
+	print_device("z80", rep.profile.z80);
+	print_device("vdp", rep.profile.vdp);
+}
+
+void print_json(const report& rep)
+{
+	auto device = [&rep](const smd::device_profile& prof) {
+		std::stringstream ss;
+		auto time = rep.profile.time(prof);
+		ss << "{\"time_ms\": " << to_ms(time) << ", \"share\": " << share(time, rep.wall_time) / 100
+		   << ", \"calls\": " << prof.calls << "}";
+		return ss.str();
+	};
+
+	std::cout << "{\n";
+	std::cout << "  \"rom\": \"" << json_escape(rep.rom_title) << "\",\n";
+	std::cout << "  \"frames\": " << rep.frames << ",\n";
+	std::cout << "  \"mclk\": " << rep.mclk << ",\n";
+	std::cout << "  \"wall_time_ms\": " << to_ms(rep.wall_time) << ",\n";
+	std::cout << "  \"frames_per_second\": " << per_second(rep.frames, rep.wall_time) << ",\n";
+	std::cout << "  \"mclk_per_second\": " << per_second(rep.mclk, rep.wall_time) << ",\n";
+	std::cout << "  \"ns_per_mclk\": " << double(rep.wall_time.count()) / rep.mclk;
+
+	if(rep.profiled)
+	{
+		std::cout << ",\n  \"devices\": {\n";
+		std::cout << "    \"m68k\": " << device(rep.profile.m68k) << ",\n";
+		std::cout << "    \"z80\": " << device(rep.profile.z80) << ",\n";
+		std::cout << "    \"vdp\": " << device(rep.profile.vdp) << "\n";
+		std::cout << "  }";
+	}
+
+	std::cout << "\n}\n";
+}
+
+int main(int args, char* argv[])
+{
+	options opts;
+	if(!parse_options(args, argv, opts))
+	{
+		print_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	try
+	{
+		genesis::rom rom(opts.rom_path);
+		genesis::smd smd(rom, std::make_shared<null_input_device>(), opts.m68k_mode);
+		smd.enable_profiling(opts.profile);
+		smd.vdp().set_render_threads(opts.render_threads);
+
+		auto start = std::chrono::steady_clock::now();
+
+		for(std::uint64_t frame = 0; frame < opts.frames; ++frame)
+			smd.run_frame();
+		smd.vdp().wait_render();
+
+		auto stop = std::chrono::steady_clock::now();
+
+		report rep{get_rom_title(rom), opts.frames, smd.mclk(), stop - start, smd.profiling_data(), opts.profile};
+		if(opts.json)
+			print_json(rep);
+		else
+			print_text(rep);
+	}
+	catch(const std::exception& e)
+	{
+		std::cerr << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,418 @@
+#include "inflate.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+
+namespace genesis
+{
+
+namespace
+{
+
+[[noreturn]] void corrupted_stream(const char* reason)
+{
+	throw std::runtime_error(std::string("failed to inflate: ") + reason);
+}
+
+/* LSB-first bit reader, keeps up to 64 bits buffered */
+class bit_reader
+{
+public:
+	bit_reader(std::span<const std::uint8_t> input) : m_pos(input.data()), m_end(input.data() + input.size())
+	{
+	}
+
+	std::uint32_t peek(unsigned num)
+	{
+		if(m_count < num)
+			refill();
+		return static_cast<std::uint32_t>(m_buffer & ((std::uint64_t(1) << num) - 1));
+	}
+
+	void consume(unsigned num)
+	{
+		// zero bytes past the end are only allowed to be peeked
+		if(m_count < num + m_overrun * 8)
+			corrupted_stream("unexpected end of stream");
+
+		m_buffer >>= num;
+		m_count -= num;
+	}
+
+	std::uint32_t bits(unsigned num)
+	{
+		auto val = peek(num);
+		consume(num);
+		return val;
+	}
+
+	void align_to_byte()
+	{
+		consume(m_count % 8);
+	}
+
+	/* must be aligned to byte */
+	void copy_bytes(std::uint8_t* dest, std::size_t num)
+	{
+		for(; num > 0 && m_count > m_overrun * 8; --num)
+			*dest++ = static_cast<std::uint8_t>(bits(8));
+
+		if(num > static_cast<std::size_t>(m_end - m_pos))
+			corrupted_stream("unexpected end of stream");
+
+		std::memcpy(dest, m_pos, num);
+		m_pos += num;
+	}
+
+private:
+	void refill()
+	{
+		while(m_count <= 56)
+		{
+			if(m_pos != m_end)
+				m_buffer |= std::uint64_t(*m_pos++) << m_count;
+			else
+				++m_overrun;
+			m_count += 8;
+		}
+	}
+
+private:
+	const std::uint8_t* m_pos;
+	const std::uint8_t* m_end;
+
+	std::uint64_t m_buffer = 0;
+	unsigned m_count = 0;
+	unsigned m_overrun = 0;
+};
+
+/* Canonical Huffman decoder: short codes are decoded with a single table lookup,
+ * longer ones fall back to the bit-by-bit canonical decoding. */
+class huffman_table
+{
+public:
+	static constexpr unsigned max_bits = 15;
+	static constexpr unsigned fast_bits = 10;
+
+	void build(const std::uint8_t* lengths, unsigned num)
+	{
+		m_counts.fill(0);
+		m_fast.fill(0);
+
+		for(unsigned sym = 0; sym < num; ++sym)
+			++m_counts[lengths[sym]];
+		m_counts[0] = 0;
+
+		// check for over-subscribed code, incomplete codes are allowed (i.e. single distance code)
+		int left = 1;
+		for(unsigned len = 1; len <= max_bits; ++len)
+		{
+			left = (left << 1) - m_counts[len];
+			if(left < 0)
+				corrupted_stream("over-subscribed Huffman code");
+		}
+
+		std::array<std::uint16_t, max_bits + 1> offsets{};
+		for(unsigned len = 1; len < max_bits; ++len)
+			offsets[len + 1] = offsets[len] + m_counts[len];
+
+		std::array<std::uint16_t, max_bits + 1> next_code{};
+		for(unsigned len = 1, code = 0; len <= max_bits; ++len)
+		{
+			code = (code + m_counts[len - 1]) << 1;
+			next_code[len] = static_cast<std::uint16_t>(code);
+		}
+
+		for(unsigned sym = 0; sym < num; ++sym)
+		{
+			unsigned len = lengths[sym];
+			if(len == 0)
+				continue;
+
+			m_symbols[offsets[len]++] = static_cast<std::uint16_t>(sym);
+
+			if(len > fast_bits)
+				continue;
+
+			// codes are stored MSB-first, but read LSB-first
+			unsigned code = next_code[len]++;
+			unsigned reversed = 0;
+			for(unsigned i = 0; i < len; ++i, code >>= 1)
+				reversed = (reversed << 1) | (code & 1);
+
+			for(unsigned idx = reversed; idx < m_fast.size(); idx += 1 << len)
+				m_fast[idx] = static_cast<std::uint16_t>(sym | (len << 9));
+		}
+	}
+
+	unsigned decode(bit_reader& reader) const
+	{
+		auto entry = m_fast[reader.peek(fast_bits)];
+		if(entry != 0)
+		{
+			reader.consume(entry >> 9);
+			return entry & 0x1FF;
+		}
+
+		int code = 0;
+		int first = 0;
+		int index = 0;
+		for(unsigned len = 1; len <= max_bits; ++len)
+		{
+			code |= reader.bits(1);
+			int count = m_counts[len];
+			if(code - count < first)
+				return m_symbols[index + (code - first)];
+
+			index += count;
+			first = (first + count) << 1;
+			code <<= 1;
+		}
+
+		corrupted_stream("invalid Huffman code");
+	}
+
+private:
+	std::array<std::uint16_t, max_bits + 1> m_counts;
+	std::array<std::uint16_t, 288> m_symbols;
+
+	// symbol | (code length << 9), 0 if code is longer than fast_bits
+	std::array<std::uint16_t, 1 << fast_bits> m_fast;
+};
+
+constexpr std::array<std::uint16_t, 29> length_base = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+													   31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::array<std::uint8_t, 29> length_extra = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+													   2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+constexpr std::array<std::uint16_t, 30> dist_base = {1,	   2,	 3,	   4,	 5,	   7,	 9,	   13,	  17,	 25,
+													 33,   49,	 65,   97,	 129,  193,	 257,  385,	  513,	 769,
+													 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr std::array<std::uint8_t, 30> dist_extra = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+													 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+class inflater
+{
+public:
+	inflater(std::span<const std::uint8_t> input, std::span<std::uint8_t> output) : m_reader(input), m_out(output)
+	{
+	}
+
+	std::size_t run()
+	{
+		bool last_block = false;
+		while(!last_block)
+		{
+			last_block = m_reader.bits(1) == 1;
+
+			switch(m_reader.bits(2))
+			{
+			case 0:
+				stored_block();
+				break;
+
+			case 1:
+				codes(fixed_tables().first, fixed_tables().second);
+				break;
+
+			case 2:
+				dynamic_block();
+				break;
+
+			default:
+				corrupted_stream("invalid block type");
+			}
+		}
+
+		return m_pos;
+	}
+
+private:
+	void stored_block()
+	{
+		m_reader.align_to_byte();
+
+		auto len = m_reader.bits(16);
+		auto nlen = m_reader.bits(16);
+		if(len != (~nlen & 0xFFFF))
+			corrupted_stream("invalid stored block length");
+
+		check_space(len);
+		m_reader.copy_bytes(m_out.data() + m_pos, len);
+		m_pos += len;
+	}
+
+	void dynamic_block()
+	{
+		static constexpr std::array<std::uint8_t, 19> order = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+															   11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+		unsigned nlen = m_reader.bits(5) + 257;
+		unsigned ndist = m_reader.bits(5) + 1;
+		unsigned ncode = m_reader.bits(4) + 4;
+		if(nlen > 286 || ndist > 30)
+			corrupted_stream("bad counts");
+
+		std::array<std::uint8_t, 320> lengths{};
+		for(unsigned i = 0; i < ncode; ++i)
+			lengths[order[i]] = static_cast<std::uint8_t>(m_reader.bits(3));
+
+		huffman_table lencode;
+		lencode.build(lengths.data(), 19);
+
+		for(unsigned i = 0; i < nlen + ndist;)
+		{
+			unsigned sym = lencode.decode(m_reader);
+			if(sym < 16)
+			{
+				lengths[i++] = static_cast<std::uint8_t>(sym);
+				continue;
+			}
+
+			std::uint8_t len = 0;
+			unsigned repeat = 0;
+			if(sym == 16)
+			{
+				if(i == 0)
+					corrupted_stream("repeat with no first length");
+				len = lengths[i - 1];
+				repeat = 3 + m_reader.bits(2);
+			}
+			else if(sym == 17)
+			{
+				repeat = 3 + m_reader.bits(3);
+			}
+			else
+			{
+				repeat = 11 + m_reader.bits(7);
+			}
+
+			if(i + repeat > nlen + ndist)
+				corrupted_stream("too many lengths");
+
+			while(repeat-- > 0)
+				lengths[i++] = len;
+		}
+
+		if(lengths[256] == 0)
+			corrupted_stream("no end-of-block code");
+
+		huffman_table lit;
+		huffman_table dist;
+		lit.build(lengths.data(), nlen);
+		dist.build(lengths.data() + nlen, ndist);
+
+		codes(lit, dist);
+	}
+
+	void codes(const huffman_table& lit, const huffman_table& dist)
+	{
+		while(true)
+		{
+			unsigned sym = lit.decode(m_reader);
+			if(sym < 256)
+			{
+				check_space(1);
+				m_out[m_pos++] = static_cast<std::uint8_t>(sym);
+				continue;
+			}
+
+			if(sym == 256)
+				return;
+
+			sym -= 257;
+			if(sym >= length_base.size())
+				corrupted_stream("invalid length symbol");
+			std::size_t len = length_base[sym] + m_reader.bits(length_extra[sym]);
+
+			unsigned dsym = dist.decode(m_reader);
+			if(dsym >= dist_base.size())
+				corrupted_stream("invalid distance symbol");
+			std::size_t distance = dist_base[dsym] + m_reader.bits(dist_extra[dsym]);
+
+			if(distance > m_pos)
+				corrupted_stream("distance is too far back");
+			check_space(len);
+
+			std::uint8_t* dest = m_out.data() + m_pos;
+			const std::uint8_t* src = dest - distance;
+			if(distance >= len)
+			{
+				std::memcpy(dest, src, len);
+			}
+			else
+			{
+				// overlapped copy repeats the pattern
+				for(std::size_t i = 0; i < len; ++i)
+					dest[i] = src[i];
+			}
+
+			m_pos += len;
+		}
+	}
+
+	void check_space(std::size_t num) const
+	{
+		if(m_out.size() - m_pos < num)
+			corrupted_stream("output buffer is too small");
+	}
+
+	static const std::pair<huffman_table, huffman_table>& fixed_tables()
+	{
+		static const auto tables = []() {
+			std::array<std::uint8_t, 288> lengths;
+			std::fill(lengths.begin(), lengths.begin() + 144, std::uint8_t(8));
+			std::fill(lengths.begin() + 144, lengths.begin() + 256, std::uint8_t(9));
+			std::fill(lengths.begin() + 256, lengths.begin() + 280, std::uint8_t(7));
+			std::fill(lengths.begin() + 280, lengths.end(), std::uint8_t(8));
+
+			std::pair<huffman_table, huffman_table> t;
+			t.first.build(lengths.data(), 288);
+
+			std::fill(lengths.begin(), lengths.begin() + 30, std::uint8_t(5));
+			t.second.build(lengths.data(), 30);
+			return t;
+		}();
+
+		return tables;
+	}
+
+private:
+	bit_reader m_reader;
+	std::span<std::uint8_t> m_out;
+	std::size_t m_pos = 0;
+};
+
+} // namespace
+
+std::size_t inflate(std::span<const std::uint8_t> input, std::span<std::uint8_t> output)
+{
+	return inflater(input, output).run();
+}
+
+std::uint32_t crc32(std::span<const std::uint8_t> data)
+{
+	static const auto table = []() {
+		std::array<std::uint32_t, 256> t;
+		for(std::uint32_t n = 0; n < 256; ++n)
+		{
+			std::uint32_t c = n;
+			for(int k = 0; k < 8; ++k)
+				c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+			t[n] = c;
+		}
+		return t;
+	}();
+
+	std::uint32_t crc = 0xFFFFFFFF;
+	for(auto byte : data)
+		crc = table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+	return crc ^ 0xFFFFFFFF;
+}
+
+} // namespace genesis
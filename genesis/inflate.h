@@ -0,0 +1,21 @@
+#ifndef __INFLATE_H__
+#define __INFLATE_H__
+
+#include <cstdint>
+#include <span>
+
+
+namespace genesis
+{
+
+/* Decode raw DEFLATE stream (RFC 1951) straight into the output buffer.
+ * Returns the number of written bytes, throws std::runtime_error if the stream is corrupted
+ * or doesn't fit into the output buffer. */
+std::size_t inflate(std::span<const std::uint8_t> input, std::span<std::uint8_t> output);
+
+/* CRC-32 as used by gzip/zip containers */
+std::uint32_t crc32(std::span<const std::uint8_t> data);
+
+} // namespace genesis
+
+#endif // __INFLATE_H__
@@ -26,6 +26,8 @@ cpu::cpu(std::shared_ptr<memory::addressable> external_memory, std::shared_ptr<i
 
 	m_int_riser = std::make_unique<impl::interrupt_riser>(regs, _bus, exman);
 
+	m_translation_cache = std::make_unique<impl::translation_cache>(regs, _bus, *external_memory);
+
 	reset();
 }
 
@@ -72,6 +74,78 @@ void cpu::cycle()
 	// tracer->post_cycle();
 }
 
+std::uint32_t cpu::execute_one()
+{
+	std::uint32_t cycles = replay_translated();
+	if(cycles != 0)
+		return cycles;
+
+	do
+	{
+		cycle();
+		++cycles;
+
+		// external device has to make progress first
+		if(busm.bus_granted() || busm.is_waiting())
+			break;
+
+		cycles += skip_cycles();
+	} while(!is_idle());
+
+	return cycles;
+}
+
+std::uint32_t cpu::skip_cycles()
+{
+	// Fast-forward cycles in which all units, but one, just wait for it.
+	// External inputs (IPL, bus requests) cannot change during execute_one, so running the interrupt riser
+	// and the idle bus manager once has the same effect as running them every skipped cycle.
+
+	if(busm.in_bus_cycle())
+	{
+		m_int_riser->cycle();
+
+		std::uint32_t cycles = 0;
+		while(busm.in_bus_cycle() && !busm.is_waiting())
+		{
+			busm.cycle();
+			++cycles;
+		}
+
+		return cycles;
+	}
+
+	if(busm.is_idle())
+	{
+		int cycles = scheduler.skip_wait_cycles();
+		if(cycles != 0)
+		{
+			m_int_riser->cycle();
+			busm.cycle();
+		}
+
+		return static_cast<std::uint32_t>(cycles);
+	}
+
+	return 0;
+}
+
+std::uint32_t cpu::replay_translated()
+{
+	if(!is_idle())
+		return 0;
+
+	// The first cycle of an instruction checks interrupts before it starts executing. Running the riser
+	// here and once more in cycle() has the same effect as IPL cannot change during execute_one.
+	m_int_riser->cycle();
+
+	// replay only if nothing but the instruction itself can happen
+	if(exman.is_raised_any() || busm.bus_granted() || _bus.is_set(bus::BR) || _bus.is_set(bus::BERR))
+		return 0;
+
+	return m_translation_cache->replay();
+}
+
 bool cpu::is_idle() const
 {
 	return busm.is_idle() && scheduler.is_idle() && inst_unit->is_idle() && excp_unit->is_idle();
@@ -10,6 +10,7 @@
 #include "impl/exception_unit.hpp"
 #include "impl/interrupt_riser.h"
 #include "impl/trace_riser.hpp"
+#include "impl/translation_cache.h"
 #include "interrupting_device.h"
 
 #include <memory>
@@ -32,6 +33,13 @@ public:
 	void cycle();
 	void reset();
 
+	// Execute the current instruction (or exception processing) at once.
+	// Execution stops earlier if CPU has to wait for an external device (i.e. the bus is granted
+	// or memory is busy), the next call continues from the same point.
+	// Instructions without data memory access are replayed from the translation cache when possible.
+	// Returns the number of elapsed cycles, it's always the same as if cycle() is called instead.
+	std::uint32_t execute_one();
+
 	cpu_registers& registers()
 	{
 		return regs;
@@ -49,6 +57,10 @@ public:
 
 	void set_interrupt(std::uint8_t priority);
 
+private:
+	std::uint32_t skip_cycles();
+	std::uint32_t replay_translated();
+
 protected:
 	cpu_registers regs;
 	cpu_bus _bus;
@@ -64,6 +76,7 @@ protected:
 	std::unique_ptr<m68k::exception_unit> excp_unit;
 	std::unique_ptr<impl::trace_riser> tracer;
 	std::unique_ptr<impl::interrupt_riser> m_int_riser;
+	std::unique_ptr<impl::translation_cache> m_translation_cache;
 };
 
 } // namespace genesis::m68k
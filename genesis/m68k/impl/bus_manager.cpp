@@ -86,6 +86,46 @@ std::uint8_t bus_manager::get_vector_number() const
 	return vector_number.value();
 }
 
+bool bus_manager::in_bus_cycle() const
+{
+	using enum bus_cycle_state;
+	switch(state)
+	{
+	// first cycles are always performed along with the bus scheduler
+	case IDLE:
+	case READ0:
+	case WRITE0:
+	case RMW_READ0:
+	case IAC0:
+	// last cycles notify the client
+	case READ3:
+	case WRITE3:
+	case RMW_WRITE3:
+	case IAC3:
+		return false;
+
+	default:
+		return true;
+	}
+}
+
+bool bus_manager::is_waiting() const
+{
+	using enum bus_cycle_state;
+	switch(state)
+	{
+	case READ_WAIT:
+	case WRITE_WAIT:
+	case RMW_READ_WAIT:
+	case RMW_WRITE_WAIT:
+	case IAC_WAIT:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
 void bus_manager::assert_idle(std::source_location loc) const
 {
 	if(!is_idle())
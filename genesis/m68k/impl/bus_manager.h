@@ -1,6 +1,7 @@
 #ifndef __M68K_BUS_MANAGER_H__
 #define __M68K_BUS_MANAGER_H__
 
+#include "continuation.hpp"
 #include "exception_manager.h"
 #include "m68k/cpu_bus.hpp"
 #include "m68k/cpu_registers.hpp"
@@ -8,7 +9,6 @@
 #include "memory/addressable.h"
 
 #include <cstdint>
-#include <functional>
 #include <memory>
 #include <optional>
 
@@ -75,14 +75,8 @@ private:
 
 
 public:
-	using on_complete = std::function<void()>;
-	using on_modify = std::function<std::uint8_t(std::uint8_t)>;
-
-private:
-	// all callbacks are restricted in size to the size of a pointer
-	// this is required for std::function small-size optimizations
-	// (though it's not guaranteed by standard, so we purely rely on implementation)
-	constexpr const static std::size_t max_callable_size = sizeof(void*);
+	using on_complete = continuation<void()>;
+	using on_modify = continuation<std::uint8_t(std::uint8_t)>;
 
 public:
 	bus_manager(m68k::cpu_bus& bus, m68k::cpu_registers& regs, exception_manager& exman,
@@ -98,7 +92,6 @@ public:
 	template <class Callable = std::nullptr_t>
 	void init_write(std::uint32_t address, std::uint8_t data, Callable cb = nullptr)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		assert_idle();
 
 		start_new_operation(address, addr_space::DATA, bus_cycle_state::WRITE0, cb);
@@ -109,7 +102,6 @@ public:
 	template <class Callable = std::nullptr_t>
 	void init_write(std::uint32_t address, std::uint16_t data, Callable cb = nullptr)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		assert_idle();
 
 		start_new_operation(address, addr_space::DATA, bus_cycle_state::WRITE0, cb);
@@ -120,8 +112,6 @@ public:
 	template <class OnModify, class OnComplete = std::nullptr_t>
 	void init_read_modify_write(std::uint32_t address, OnModify modify, addr_space space, OnComplete cb = nullptr)
 	{
-		static_assert(sizeof(OnModify) <= max_callable_size);
-		static_assert(sizeof(OnComplete) <= max_callable_size);
 		assert_idle();
 
 		modify_cb = modify;
@@ -133,12 +123,11 @@ public:
 	}
 
 	template <class Callable = std::nullptr_t>
-	void init_read_modify_write(std::uint32_t address, on_modify&& modify, addr_space space, Callable cb)
+	void init_read_modify_write(std::uint32_t address, on_modify modify, addr_space space, Callable cb)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		assert_idle();
 
-		modify_cb = std::move(modify);
+		modify_cb = modify;
 		start_new_operation(address, space, bus_cycle_state::RMW_READ0, cb);
 		byte_operation = true;
 	}
@@ -146,7 +135,6 @@ public:
 	template <class Callable = std::nullptr_t>
 	void init_read_byte(std::uint32_t address, addr_space space, Callable cb = nullptr)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		assert_idle();
 
 		start_new_operation(address, space, bus_cycle_state::READ0, cb);
@@ -156,7 +144,6 @@ public:
 	template <class Callable = std::nullptr_t>
 	void init_read_word(std::uint32_t address, addr_space space, Callable cb = nullptr)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		assert_idle();
 
 		start_new_operation(address, space, bus_cycle_state::READ0, cb);
@@ -177,7 +164,6 @@ public:
 	template <class Callable = std::nullptr_t>
 	void init_interrupt_ack(std::uint8_t ipl, Callable on_complete = nullptr)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		assert_idle();
 
 		if(ipl == 0 || ipl > 7)
@@ -191,6 +177,14 @@ public:
 
 	std::uint8_t get_vector_number() const;
 
+	/* instruction-level execution interface */
+
+	// bus cycle is in progress and its next cycle doesn't complete it (so nobody else is notified)
+	bool in_bus_cycle() const;
+
+	// bus cycle waits for an external device to respond
+	bool is_waiting() const;
+
 private:
 	void assert_idle(std::source_location loc = std::source_location::current()) const;
 
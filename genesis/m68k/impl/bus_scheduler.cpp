@@ -23,8 +23,7 @@ bus_scheduler::bus_scheduler(m68k::cpu_registers& regs, m68k::bus_manager& busm)
 void bus_scheduler::reset()
 {
 	current_op.reset();
-	while(!queue.empty())
-		queue.pop();
+	queue.reset();
 	pq.reset();
 	curr_wait_cycles = 0;
 }
@@ -230,6 +229,17 @@ void bus_scheduler::wait(int cycles)
 	queue.emplace(op_type::WAIT, wait_op);
 }
 
+int bus_scheduler::skip_wait_cycles()
+{
+	if(curr_wait_cycles <= 1)
+		return 0;
+
+	// the last cycle completes the wait operation, so it has to be done as usual
+	int skipped = curr_wait_cycles - 1;
+	curr_wait_cycles = 1;
+	return skipped;
+}
+
 void bus_scheduler::call_impl(callback cb)
 {
 	call_operation call_op{cb};
@@ -338,7 +348,7 @@ void bus_scheduler::start_operation(operation& op)
 
 	case op_type::RMW: {
 		rmw_operation& rmw = std::get<rmw_operation>(op.op);
-		busm.init_read_modify_write(rmw.addr, std::move(rmw.modify), addr_space::DATA,
+		busm.init_read_modify_write(rmw.addr, rmw.modify, addr_space::DATA,
 									[this]() { run_cycless_operations(); });
 		break;
 	}
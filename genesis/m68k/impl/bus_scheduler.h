@@ -2,12 +2,12 @@
 #define __M68K_BUS_SCHEDULER_H__
 
 #include "bus_manager.h"
+#include "continuation.hpp"
 #include "m68k/cpu_registers.hpp"
 #include "prefetch_queue.hpp"
+#include "static_queue.hpp"
 
-#include <functional>
 #include <optional>
-#include <queue>
 #include <variant>
 
 
@@ -30,14 +30,8 @@ enum class read_imm_flags
 // TODO: maybe back to scheduler?
 class bus_scheduler
 {
-private:
-	// all callbacks are restricted in size to the size of the pointer
-	// this is required for std::function small-size optimizations
-	// (though it's not guaranteed by standard, so we purely rely on implementation)
-	constexpr const static std::size_t max_callable_size = sizeof(void*);
-
 public:
-	using on_read_complete = std::function<void(std::uint32_t /*data*/, size_type)>;
+	using on_read_complete = continuation<void(std::uint32_t /*data*/, size_type)>;
 
 public:
 	bus_scheduler(m68k::cpu_registers& regs, m68k::bus_manager& busm);
@@ -56,21 +50,18 @@ public:
 	template <class Callable>
 	void read(std::uint32_t addr, size_type size, addr_space space, Callable on_complete)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		read_impl(addr, size, space, on_complete);
 	}
 
 	template <class Callable = std::nullptr_t>
 	void read_imm(size_type size, Callable on_complete = nullptr)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		read_imm_impl(size, on_complete);
 	}
 
 	template <class Callable = std::nullptr_t>
 	void read_imm(size_type size, read_imm_flags flags, Callable on_complete = nullptr)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		read_imm_impl(size, on_complete, flags);
 	}
 
@@ -79,14 +70,12 @@ public:
 	template <class Callable>
 	void read_modify_write(std::uint32_t addr, Callable modify)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		read_modify_write_impl(addr, modify);
 	}
 
 	template <class Callable>
 	void int_ack(std::uint8_t ipl, Callable on_complete)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		int_ack_impl(ipl, on_complete);
 	}
 
@@ -100,7 +89,6 @@ public:
 	template <class Callable>
 	void call(Callable cb)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		call_impl(cb);
 	}
 
@@ -109,6 +97,9 @@ public:
 
 	void push(std::uint32_t data, size_type size, order order = order::msw_first);
 
+	// skip all but the last cycle of the current wait operation, returns the number of skipped cycles
+	int skip_wait_cycles();
+
 private:
 	enum class op_type
 	{
@@ -149,14 +140,14 @@ private:
 		size_type size;
 	};
 
-	using on_modify = std::function<std::uint8_t(std::uint8_t)>;
+	using on_modify = continuation<std::uint8_t(std::uint8_t)>;
 	struct rmw_operation
 	{
 		std::uint32_t addr;
 		on_modify modify;
 	};
 
-	using int_ack_complete = std::function<void(std::uint8_t /* vector number */)>;
+	using int_ack_complete = continuation<void(std::uint8_t /* vector number */)>;
 	struct int_ack_operation
 	{
 		std::uint8_t ipl; // interrupt priority level
@@ -168,7 +159,7 @@ private:
 		int cycles;
 	};
 
-	using callback = std::function<void()>;
+	using callback = continuation<void()>;
 	struct call_operation
 	{
 		callback cb;
@@ -187,6 +178,7 @@ private:
 		int offset = 0;
 	};
 
+	// all operations are trivially copyable, so the queue is just a ring of plain records
 	struct operation
 	{
 		op_type type;
@@ -221,8 +213,7 @@ private:
 	m68k::bus_manager& busm;
 	m68k::prefetch_queue pq;
 
-	// TODO: replace to const size queue
-	std::queue<operation> queue;
+	static_queue<operation> queue;
 	std::optional<operation> current_op;
 	std::uint32_t data = 0;
 	int curr_wait_cycles = 0;
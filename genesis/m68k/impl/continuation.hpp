@@ -0,0 +1,69 @@
+#ifndef __M68K_CONTINUATION_HPP__
+#define __M68K_CONTINUATION_HPP__
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+
+namespace genesis::m68k
+{
+
+template <class Signature>
+class continuation;
+
+// Callback stored inline: a pointer-sized trivially copyable callable (usually a lambda capturing this)
+// plus a pointer to the function invoking it. Copying is a plain memcpy, no heap allocations are involved,
+// so continuations can be kept in fixed-size operation records.
+template <class R, class... Args>
+class continuation<R(Args...)>
+{
+public:
+	constexpr const static std::size_t max_callable_size = sizeof(void*);
+
+public:
+	continuation() = default;
+	continuation(std::nullptr_t)
+	{
+	}
+
+	template <class Callable>
+		requires(!std::is_same_v<std::decay_t<Callable>, continuation> &&
+				 !std::is_same_v<std::decay_t<Callable>, std::nullptr_t>)
+	continuation(Callable cb)
+	{
+		static_assert(sizeof(Callable) <= max_callable_size);
+		static_assert(alignof(Callable) <= alignof(void*));
+		static_assert(std::is_trivially_copyable_v<Callable> && std::is_trivially_destructible_v<Callable>);
+
+		::new(static_cast<void*>(storage)) Callable(cb);
+		invoker = [](const std::byte* st, Args... args) -> R {
+			return (*std::launder(reinterpret_cast<const Callable*>(st)))(args...);
+		};
+	}
+
+	R operator()(Args... args) const
+	{
+		return invoker(storage, args...);
+	}
+
+	bool operator==(std::nullptr_t) const
+	{
+		return invoker == nullptr;
+	}
+
+	explicit operator bool() const
+	{
+		return invoker != nullptr;
+	}
+
+private:
+	using invoker_t = R (*)(const std::byte*, Args...);
+
+	invoker_t invoker = nullptr;
+	alignas(void*) std::byte storage[max_callable_size] = {};
+};
+
+} // namespace genesis::m68k
+
+#endif // __M68K_CONTINUATION_HPP__
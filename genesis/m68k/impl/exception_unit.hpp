@@ -6,6 +6,8 @@
 #include "exception_manager.h"
 #include "pc_corrector.hpp"
 
+#include <functional>
+
 
 namespace genesis::m68k
 {
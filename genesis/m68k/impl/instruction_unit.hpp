@@ -13,6 +13,7 @@
 #include "privilege_checker.hpp"
 #include "timings.hpp"
 
+#include <array>
 #include <iostream>
 
 
@@ -35,9 +36,23 @@ private:
 		wait_scheduler,
 	};
 
+	using handler = exec_state (*)(instruction_unit&);
+
+	/* Everything required to start executing an opcode, resolved ahead of time for all 64K opcodes.
+	 * Runs of decoded instructions are cached by PC in impl::translation_cache. */
+	struct decoded_opcode
+	{
+		handler exec;
+		inst_type inst;
+		bool privileged;
+	};
+
+	using dispatch_table = std::array<decoded_opcode, 0xFFFF + 1>;
+
 public:
 	instruction_unit(m68k::cpu_registers& regs, exception_manager& exman, cpu_bus& bus, m68k::bus_scheduler& scheduler)
-		: regs(regs), dec(regs, scheduler), exman(exman), bus(bus), scheduler(scheduler)
+		: regs(regs), dec(regs, scheduler), exman(exman), bus(bus), scheduler(scheduler),
+		  m_dispatch_table(get_dispatch_table())
 	{
 		reset();
 	}
@@ -81,6 +96,19 @@ public:
 			m_unit_state = unit_state::idle;
 	}
 
+	// what prepare_executing finds for the opcode
+	static const decoded_opcode& lookup(std::uint16_t opcode)
+	{
+		return get_dispatch_table()[opcode];
+	}
+
+	// what the dispatch table is built from: decoding and resolving the handler per opcode
+	static decoded_opcode resolve(std::uint16_t opcode)
+	{
+		auto inst = opcode_decoder::decode(opcode);
+		return {find_handler(inst), inst, impl::privilege_checker::is_privileged(inst)};
+	}
+
 private:
 	exec_state prepare_executing()
 	{
@@ -88,12 +116,15 @@ private:
 		opcode = regs.IRD;
 		regs.SIRD = regs.IRD;
 		regs.SPC = regs.PC;
-		curr_inst = decode_opcode(opcode);
+
+		const auto& decoded = m_dispatch_table[opcode];
+		curr_inst = decoded.inst;
+		curr_handler = decoded.exec;
 
 		if(check_illegal_instruction(curr_inst, opcode))
 			return exec_state::done;
 
-		if(check_privilege_violations(curr_inst))
+		if(check_privilege_violations(decoded))
 			return exec_state::done;
 
 		regs.PC += 2;
@@ -143,7 +174,33 @@ private:
 
 	exec_state execute()
 	{
-		switch(curr_inst)
+		return curr_handler(*this);
+	}
+
+	template <exec_state (instruction_unit::*Handler)()>
+	static exec_state invoke(instruction_unit& unit)
+	{
+		return (unit.*Handler)();
+	}
+
+	static const dispatch_table& get_dispatch_table()
+	{
+		static const auto table = build_dispatch_table();
+		return table;
+	}
+
+	static dispatch_table build_dispatch_table()
+	{
+		dispatch_table table;
+		for(std::size_t opcode = 0; opcode < table.size(); ++opcode)
+			table[opcode] = resolve(static_cast<std::uint16_t>(opcode));
+
+		return table;
+	}
+
+	static handler find_handler(inst_type inst)
+	{
+		switch(inst)
 		{
 		case inst_type::ADD:
 		case inst_type::SUB:
@@ -151,12 +208,12 @@ private:
 		case inst_type::OR:
 		case inst_type::EOR:
 		case inst_type::CMP:
-			return alu_mode_handler();
+			return &invoke<&instruction_unit::alu_mode_handler>;
 
 		case inst_type::ADDA:
 		case inst_type::SUBA:
 		case inst_type::CMPA:
-			return alu_address_mode_handler();
+			return &invoke<&instruction_unit::alu_address_mode_handler>;
 
 		case inst_type::ADDI:
 		case inst_type::ANDI:
@@ -164,183 +221,191 @@ private:
 		case inst_type::ORI:
 		case inst_type::EORI:
 		case inst_type::CMPI:
-			return alu_imm_handler();
+			return &invoke<&instruction_unit::alu_imm_handler>;
 
 		case inst_type::ADDQ:
 		case inst_type::SUBQ:
-			return alu_quick_handler();
+			return &invoke<&instruction_unit::alu_quick_handler>;
 
 		case inst_type::CMPM:
-			return rm_postinc_handler();
+			return &invoke<&instruction_unit::rm_postinc_handler>;
 
 		case inst_type::NEG:
 		case inst_type::NEGX:
 		case inst_type::NOT:
 		case inst_type::CLR:
 		case inst_type::NBCD:
-			return unary_handler();
+			return &invoke<&instruction_unit::unary_handler>;
 
 		case inst_type::ADDX:
 		case inst_type::SUBX:
-			return rm_predec_handler();
+			return &invoke<&instruction_unit::rm_predec_handler>;
 
 		case inst_type::NOP:
-			return nop_hanlder();
+			return &invoke<&instruction_unit::nop_hanlder>;
 
 		case inst_type::MOVE:
-			return move_handler();
+			return &invoke<&instruction_unit::move_handler>;
 
 		case inst_type::MOVEQ:
-			return moveq_handler();
+			return &invoke<&instruction_unit::moveq_handler>;
 
 		case inst_type::MOVEA:
-			return movea_handler();
+			return &invoke<&instruction_unit::movea_handler>;
 
 		case inst_type::MOVEMtoMEM:
 		case inst_type::MOVEMtoREG:
-			return movem_handler();
+			return &invoke<&instruction_unit::movem_handler>;
 
 		case inst_type::MOVEP:
-			return movep_handler();
+			return &invoke<&instruction_unit::movep_handler>;
 
 		case inst_type::MOVEfromSR:
-			return move_from_sr_handler();
+			return &invoke<&instruction_unit::move_from_sr_handler>;
 
 		case inst_type::MOVEtoSR:
-			return move_to_sr_handler();
+			return &invoke<&instruction_unit::move_to_sr_handler>;
 
 		case inst_type::MOVE_USP:
-			return move_usp_handler();
+			return &invoke<&instruction_unit::move_usp_handler>;
 
 		case inst_type::MOVEtoCCR:
-			return move_to_ccr_handler();
+			return &invoke<&instruction_unit::move_to_ccr_handler>;
 
 		case inst_type::ANDItoCCR:
 		case inst_type::ORItoCCR:
 		case inst_type::EORItoCCR:
-			return alu_to_ccr_handler();
+			return &invoke<&instruction_unit::alu_to_ccr_handler>;
 
 		case inst_type::ANDItoSR:
 		case inst_type::ORItoSR:
 		case inst_type::EORItoSR:
-			return alu_to_sr_handler();
+			return &invoke<&instruction_unit::alu_to_sr_handler>;
 
 		case inst_type::ASLRreg:
 		case inst_type::ROLRreg:
 		case inst_type::LSLRreg:
 		case inst_type::ROXLRreg:
-			return shift_reg_handler();
+			return &invoke<&instruction_unit::shift_reg_handler>;
 
 		case inst_type::ASLRmem:
 		case inst_type::ROLRmem:
 		case inst_type::LSLRmem:
 		case inst_type::ROXLRmem:
-			return shift_mem_handler();
+			return &invoke<&instruction_unit::shift_mem_handler>;
 
 		case inst_type::TST:
-			return tst_handler();
+			return &invoke<&instruction_unit::tst_handler>;
 
 		case inst_type::MULU:
 		case inst_type::MULS:
-			return mul_handler();
+			return &invoke<&instruction_unit::mul_handler>;
 
 		case inst_type::TRAP:
-			return trap_handler();
+			return &invoke<&instruction_unit::trap_handler>;
 
 		case inst_type::TRAPV:
-			return trapv_handler();
+			return &invoke<&instruction_unit::trapv_handler>;
 
 		case inst_type::DIVU:
 		case inst_type::DIVS:
-			return div_handler();
+			return &invoke<&instruction_unit::div_handler>;
 
 		case inst_type::EXT:
-			return ext_handler();
+			return &invoke<&instruction_unit::ext_handler>;
 
 		case inst_type::EXG:
-			return exg_handler();
+			return &invoke<&instruction_unit::exg_handler>;
 
 		case inst_type::SWAP:
-			return swap_handler();
+			return &invoke<&instruction_unit::swap_handler>;
 
 		case inst_type::BTSTreg:
-			return btst_reg_handler();
+			return &invoke<&instruction_unit::btst_reg_handler>;
 
 		case inst_type::BTSTimm:
-			return btst_imm_handler();
+			return &invoke<&instruction_unit::btst_imm_handler>;
 
 		case inst_type::BSETreg:
 		case inst_type::BCLRreg:
 		case inst_type::BCHGreg:
-			return bit_reg_handler();
+			return &invoke<&instruction_unit::bit_reg_handler>;
 
 		case inst_type::BSETimm:
 		case inst_type::BCLRimm:
 		case inst_type::BCHGimm:
-			return bit_imm_handler();
+			return &invoke<&instruction_unit::bit_imm_handler>;
 
 		case inst_type::RTE:
 		case inst_type::RTR:
-			return ret_handler();
+			return &invoke<&instruction_unit::ret_handler>;
 
 		case inst_type::RTS:
-			return rts_handler();
+			return &invoke<&instruction_unit::rts_handler>;
 
 		case inst_type::JMP:
-			return jmp_handler();
+			return &invoke<&instruction_unit::jmp_handler>;
 
 		case inst_type::CHK:
-			return chk_handler();
+			return &invoke<&instruction_unit::chk_handler>;
 
 		case inst_type::JSR:
-			return jsr_handler();
+			return &invoke<&instruction_unit::jsr_handler>;
 
 		case inst_type::BSR:
-			return bsr_handler();
+			return &invoke<&instruction_unit::bsr_handler>;
 
 		case inst_type::LEA:
-			return lea_handler();
+			return &invoke<&instruction_unit::lea_handler>;
 
 		case inst_type::PEA:
-			return pea_handler();
+			return &invoke<&instruction_unit::pea_handler>;
 
 		case inst_type::LINK:
-			return link_handler();
+			return &invoke<&instruction_unit::link_handler>;
 
 		case inst_type::UNLK:
-			return unlk_handler();
+			return &invoke<&instruction_unit::unlk_handler>;
 
 		case inst_type::BCC:
-			return bcc_handler();
+			return &invoke<&instruction_unit::bcc_handler>;
 
 		case inst_type::DBCC:
-			return dbcc_handler();
+			return &invoke<&instruction_unit::dbcc_handler>;
 
 		case inst_type::SCC:
-			return scc_handler();
+			return &invoke<&instruction_unit::scc_handler>;
 
 		case inst_type::ABCDreg:
 		case inst_type::SBCDreg:
-			return bcd_reg_handler();
+			return &invoke<&instruction_unit::bcd_reg_handler>;
 
 		case inst_type::ABCDmem:
 		case inst_type::SBCDmem:
-			return bcd_mem_handler();
+			return &invoke<&instruction_unit::bcd_mem_handler>;
 
 		case inst_type::RESET:
-			return reset_handler();
+			return &invoke<&instruction_unit::reset_handler>;
 
 		case inst_type::TAS:
-			return tas_handler();
+			return &invoke<&instruction_unit::tas_handler>;
 
 		case inst_type::STOP:
-			throw not_implemented();
+			return &invoke<&instruction_unit::stop_handler>;
+
+		case inst_type::NONE:
+			return nullptr; // illegal instruction
 
 		default:
-			throw internal_error("Unknown instruction: " + std::to_string((int)curr_inst));
+			throw internal_error("Unknown instruction: " + std::to_string((int)inst));
 		}
 	}
 
+	exec_state stop_handler()
+	{
+		throw not_implemented();
+	}
+
 	exec_state alu_mode_handler()
 	{
 		switch(exec_stage++)
@@ -1902,19 +1967,14 @@ private:
 		return size_type::BYTE;
 	}
 
-	static inst_type decode_opcode(std::uint16_t opcode)
-	{
-		return opcode_decoder::decode(opcode);
-	}
-
 	static bool bit_is_set(std::uint32_t data, std::uint8_t bit_number)
 	{
 		return ((data >> bit_number) & 1) == 1;
 	}
 
-	bool check_privilege_violations(inst_type inst)
+	bool check_privilege_violations(const decoded_opcode& decoded)
 	{
-		if(impl::privilege_checker::is_authorized(inst, regs))
+		if(!decoded.privileged || regs.flags.S == 1)
 			return false;
 
 		exman.rise_privilege_violations();
@@ -1976,9 +2036,11 @@ private:
 	exception_manager& exman;
 	cpu_bus& bus;
 	m68k::bus_scheduler& scheduler;
+	const dispatch_table& m_dispatch_table;
 
 	std::uint16_t opcode = 0;
 	inst_type curr_inst;
+	handler curr_handler = nullptr;
 	std::uint8_t exec_stage;
 
 	unit_state m_unit_state;
@@ -92,6 +92,39 @@ constexpr bool validate_opcodes()
 static_assert(validate_opcodes());
 
 
+/* Fixed bits of the template, so most of templates could be rejected without tokenizing */
+struct fixed_bits
+{
+	std::uint16_t mask = 0;
+	std::uint16_t value = 0;
+};
+
+constexpr fixed_bits get_fixed_bits(std::string_view inst_template)
+{
+	fixed_bits bits;
+	for(std::size_t i = 0; i < inst_template.size(); ++i)
+	{
+		// only 0/1 chars are fixed, placeholders never contain them
+		if(inst_template[i] != '0' && inst_template[i] != '1')
+			continue;
+
+		std::uint16_t bit = 1 << (15 - i);
+		bits.mask |= bit;
+		if(inst_template[i] == '1')
+			bits.value |= bit;
+	}
+
+	return bits;
+}
+
+constexpr auto opcodes_fixed_bits = []() {
+	std::array<fixed_bits, std::size(opcodes)> bits;
+	for(std::size_t i = 0; i < bits.size(); ++i)
+		bits[i] = get_fixed_bits(opcodes[i].inst_template);
+	return bits;
+}();
+
+
 class opcode_builder
 {
 public:
@@ -100,26 +133,25 @@ public:
 	static auto build_opcode_map()
 	{
 		std::array<inst_type, 0xFFFF + 1> opcode_map;
-		opcode_map.fill(inst_type::NONE);
+		for(std::size_t opcode = 0; opcode < opcode_map.size(); ++opcode)
+			opcode_map[opcode] = match(static_cast<std::uint16_t>(opcode));
 
-		std::uint16_t opcode = 0;
-		while(true)
+		return opcode_map;
+	}
+
+	static inst_type match(std::uint16_t opcode)
+	{
+		for(std::size_t i = 0; i < std::size(opcodes); ++i)
 		{
-			for(auto inst : opcodes)
-			{
-				if(matches(opcode, inst))
-				{
-					opcode_map.at(opcode) = inst.inst;
-					break;
-				}
-			}
+			auto bits = opcodes_fixed_bits[i];
+			if((opcode & bits.mask) != bits.value)
+				continue;
 
-			if(opcode == 0xFFFF)
-				break;
-			++opcode;
+			if(matches(opcode, opcodes[i]))
+				return opcodes[i].inst;
 		}
 
-		return opcode_map;
+		return inst_type::NONE;
 	}
 
 private:
@@ -210,11 +242,15 @@ private:
 };
 
 
-const auto opcode_map = opcode_builder::build_opcode_map();
-
 m68k::inst_type opcode_decoder::decode(std::uint16_t opcode)
 {
-	return opcode_map.at(opcode);
+	static const auto opcode_map = opcode_builder::build_opcode_map();
+	return opcode_map[opcode];
+}
+
+m68k::inst_type opcode_decoder::match(std::uint16_t opcode)
+{
+	return opcode_builder::match(opcode);
 }
 
 } // namespace genesis::m68k
@@ -196,7 +196,11 @@ class opcode_decoder
 public:
 	opcode_decoder() = delete;
 
+	/* Lookup in the precomputed table of all 64K opcodes */
 	static m68k::inst_type decode(std::uint16_t opcode);
+
+	/* Match opcode against opcodes[] templates, used to build the decoding table */
+	static m68k::inst_type match(std::uint16_t opcode);
 };
 
 } // namespace genesis::m68k
@@ -2,6 +2,7 @@
 #define __M68K_PREFETCH_QUEUE_HPP__
 
 #include "bus_manager.h"
+#include "continuation.hpp"
 #include "m68k/cpu_registers.hpp"
 
 
@@ -20,13 +21,7 @@ private:
 	};
 
 public:
-	using on_complete = std::function<void()>;
-
-private:
-	// all callbacks are restricted in size to the size of the pointer
-	// this is required for std::function small-size optimizations
-	// (though it's not guaranteed by standard, so we purely rely on implementation)
-	constexpr const static std::size_t max_callable_size = sizeof(void*);
+	using on_complete = continuation<void()>;
 
 public:
 	prefetch_queue(m68k::cpu_registers& regs, m68k::bus_manager& busm) : regs(regs), busm(busm)
@@ -49,7 +44,6 @@ public:
 	template <class Callable = std::nullptr_t>
 	void init_fetch_ird(Callable cb = nullptr)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		assert_idle();
 
 		busm.init_read_word(regs.PC, addr_space::PROGRAM, [this]() { on_read_finished(); });
@@ -62,7 +56,6 @@ public:
 	template <class Callable = std::nullptr_t>
 	void init_fetch_irc(Callable cb = nullptr)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		assert_idle();
 
 		busm.init_read_word(regs.PC + 2, addr_space::PROGRAM, [this]() { on_read_finished(); });
@@ -75,7 +68,6 @@ public:
 	template <class Callable = std::nullptr_t>
 	void init_fetch_one(Callable cb = nullptr)
 	{
-		static_assert(sizeof(Callable) <= max_callable_size);
 		assert_idle();
 
 		busm.init_read_word(regs.PC + 2, addr_space::PROGRAM, [this]() { on_read_finished(); });
@@ -2,7 +2,6 @@
 #define __M68K_PRIVILEGE_CHECKER_HPP__
 
 #include "instruction_type.h"
-#include "m68k/cpu_registers.hpp"
 
 namespace genesis::m68k::impl
 {
@@ -12,11 +11,8 @@ class privilege_checker
 public:
 	privilege_checker() = delete;
 
-	static bool is_authorized(m68k::inst_type inst, const m68k::cpu_registers& regs)
+	constexpr static bool is_privileged(m68k::inst_type inst)
 	{
-		if(regs.flags.S == 1)
-			return true;
-
 		switch(inst)
 		{
 		case inst_type::MOVEtoSR:
@@ -27,10 +23,10 @@ public:
 		case inst_type::RTE:
 		case inst_type::RESET:
 		case inst_type::STOP:
-			return false;
+			return true;
 
 		default:
-			return true;
+			return false;
 		}
 	}
 };
@@ -0,0 +1,896 @@
+#include "translation_cache.h"
+
+#include "endian.hpp"
+#include "instruction_unit.hpp"
+#include "operations.hpp"
+#include "timings.hpp"
+
+
+namespace genesis::m68k::impl
+{
+
+namespace
+{
+
+// address bus is 24 bits only
+constexpr std::uint32_t address_mask = 0xFFFFFF;
+
+// long enough for usual loops, but keeps decoding of a run that is left early cheap
+constexpr std::size_t max_run_length = 32;
+
+// all runs are dropped when the limit is reached
+constexpr std::size_t max_blocks = 1 << 16;
+
+bool bit_is_set(std::uint32_t data, std::uint8_t bit_number)
+{
+	return ((data >> bit_number) & 1) == 1;
+}
+
+std::optional<size_type> dec_size(std::uint16_t opcode)
+{
+	switch((opcode >> 6) & 0b11)
+	{
+	case 0b00:
+		return size_type::BYTE;
+	case 0b01:
+		return size_type::WORD;
+	case 0b10:
+		return size_type::LONG;
+	default:
+		return std::nullopt;
+	}
+}
+
+std::optional<size_type> dec_move_size(std::uint16_t opcode)
+{
+	switch((opcode >> 12) & 0b11)
+	{
+	case 0b01:
+		return size_type::BYTE;
+	case 0b11:
+		return size_type::WORD;
+	case 0b10:
+		return size_type::LONG;
+	default:
+		return std::nullopt;
+	}
+}
+
+// operands which are decoded without accessing data memory
+bool is_register_or_imm(addressing_mode mode)
+{
+	return mode == addressing_mode::data_reg || mode == addressing_mode::addr_reg || mode == addressing_mode::imm;
+}
+
+std::uint16_t read_word(const memory::direct_region& region, std::uint32_t address)
+{
+	return region.read<std::uint16_t>(address & address_mask);
+}
+
+/* the same as instruction_unit stores the result */
+
+void store(data_register& d, size_type size, std::uint32_t res)
+{
+	if(size == size_type::BYTE)
+		d.B = (std::uint8_t)res;
+	else if(size == size_type::WORD)
+		d.W = (std::uint16_t)res;
+	else
+		d.LW = res;
+}
+
+void store(operand& op, size_type size, std::uint32_t res)
+{
+	if(op.is_data_reg())
+	{
+		store(op.data_reg(), size, res);
+	}
+	else if(op.is_addr_reg())
+	{
+		if(size == size_type::WORD)
+			op.addr_reg().W = (std::uint16_t)res;
+		else if(size == size_type::LONG)
+			op.addr_reg().LW = res;
+		else
+			throw internal_error();
+	}
+}
+
+} // namespace
+
+translation_cache::translation_cache(m68k::cpu_registers& regs, m68k::cpu_bus& bus, memory::addressable& memory)
+	: m_regs(regs), m_bus(bus), m_memory(memory)
+{
+}
+
+std::uint32_t translation_cache::replay()
+{
+	if(m_blocks.size() >= max_blocks)
+		clear();
+
+	micro_op* op = next_op();
+	if(op == nullptr)
+		return 0;
+
+	if(!matches(*op))
+	{
+		// the run was overwritten, decode it again next time
+		m_block->translated = false;
+		m_block = nullptr;
+		return 0;
+	}
+
+	m_regs.SIRD = m_regs.IRD;
+	m_regs.SPC = m_regs.PC;
+	m_regs.PC += 2;
+
+	return op->exec(*this, *op);
+}
+
+void translation_cache::clear()
+{
+	m_blocks.clear();
+	m_block = nullptr;
+	m_index = 0;
+}
+
+translation_cache::block& translation_cache::find(std::uint32_t pc)
+{
+	auto& blk = m_blocks[pc];
+	if(blk == nullptr)
+		blk = std::make_unique<block>(block{pc, false, {}, {}});
+	return *blk;
+}
+
+translation_cache::micro_op* translation_cache::next_op()
+{
+	// continue the current run if PC didn't go anywhere else
+	bool in_run = m_block != nullptr;
+	if(in_run && m_index == 0)
+		in_run = m_block->pc == m_regs.PC;
+	else if(in_run)
+		in_run = m_index < m_block->ops.size() && m_block->ops[m_index].pc == m_regs.PC;
+
+	if(!in_run)
+	{
+		m_block = &find(m_regs.PC);
+		m_index = 0;
+	}
+
+	if(!m_block->translated)
+		translate(*m_block);
+
+	if(m_index >= m_block->ops.size())
+	{
+		m_block = nullptr;
+		return nullptr;
+	}
+
+	return &m_block->ops[m_index];
+}
+
+void translation_cache::translate(block& blk)
+{
+	blk.ops.clear();
+	blk.translated = true;
+
+	if(blk.pc % 2 != 0)
+		return;
+
+	auto region = m_memory.direct_access(blk.pc & address_mask);
+	if(!region)
+		return;
+
+	blk.region = *region;
+
+	std::uint32_t pc = blk.pc;
+	while(blk.ops.size() < max_run_length)
+	{
+		auto op = decode(pc, blk.region);
+		if(!op)
+			break;
+
+		blk.ops.push_back(*op);
+		if(op->inst == inst_type::BCC || op->inst == inst_type::DBCC)
+			break;
+
+		pc += op->length * 2;
+	}
+}
+
+bool translation_cache::matches(const micro_op& op) const
+{
+	// prefetch queue holds the opcode and the first extension word,
+	// the rest is read from memory when the instruction is executed
+	if(m_regs.IRD != op.opcode)
+		return false;
+
+	if(op.length > 1 && m_regs.IRC != op.ext[0])
+		return false;
+
+	if(op.length > 2 && m_block->region.writable)
+		return read_word(m_block->region, op.pc + 4) == op.ext[1];
+
+	return true;
+}
+
+std::optional<translation_cache::micro_op> translation_cache::decode(std::uint32_t pc,
+																	 const memory::direct_region& region)
+{
+	const std::uint32_t address = pc & address_mask;
+	if(!region.contains(address, address + 1))
+		return std::nullopt;
+
+	micro_op op{};
+	op.pc = pc;
+	op.opcode = region.read<std::uint16_t>(address);
+	for(std::uint32_t i = 0; i < op.ext.size(); ++i)
+	{
+		std::uint32_t ext_address = address + (i + 1) * 2;
+		if(region.contains(ext_address, ext_address + 1))
+			op.ext[i] = region.read<std::uint16_t>(ext_address);
+	}
+
+	const auto& decoded = instruction_unit::lookup(op.opcode);
+	if(decoded.privileged)
+		return std::nullopt;
+
+	const std::uint16_t opcode = op.opcode;
+	op.inst = decoded.inst;
+	op.mode = ea_decoder::decode_mode(opcode & 0xFF);
+	op.ea_reg = opcode & 0x7;
+	op.reg = (opcode >> 9) & 0x7;
+	op.length = 1;
+
+	// immediate data follows the opcode
+	auto read_imm = [&op](size_type size) {
+		if(size == size_type::LONG)
+			op.data = (std::uint32_t(op.ext[0]) << 16) | op.ext[1];
+		else if(size == size_type::WORD)
+			op.data = op.ext[0];
+		else
+			op.data = endian::lsb(op.ext[0]);
+
+		op.length += size == size_type::LONG ? 2 : 1;
+	};
+
+	auto set_target = [this, &op](std::uint32_t target) {
+		if(target % 2 != 0)
+			return false;
+
+		auto target_region = m_memory.direct_access(target & address_mask);
+		if(!target_region || !target_region->contains(target & address_mask, (target & address_mask) + 3))
+			return false;
+
+		op.data = target;
+		op.target_region = *target_region;
+		return true;
+	};
+
+	std::uint8_t wait_cycles = 0;
+
+	switch(op.inst)
+	{
+	case inst_type::ADD:
+	case inst_type::SUB:
+	case inst_type::AND:
+	case inst_type::OR:
+	case inst_type::EOR:
+	case inst_type::CMP: {
+		auto size = dec_size(opcode);
+		if(!size || !is_register_or_imm(op.mode))
+			return std::nullopt;
+
+		// result is written to the effective address
+		if(bit_is_set(opcode, 8) && op.mode != addressing_mode::data_reg)
+			return std::nullopt;
+
+		op.size = *size;
+		if(op.mode == addressing_mode::imm)
+			read_imm(op.size);
+
+		op.exec = &invoke<&translation_cache::alu_mode>;
+		wait_cycles = timings::alu_mode(op.inst, op.mode, (opcode >> 6) & 0x7);
+		break;
+	}
+
+	case inst_type::ADDA:
+	case inst_type::SUBA:
+	case inst_type::CMPA: {
+		if(!is_register_or_imm(op.mode))
+			return std::nullopt;
+
+		const std::uint8_t opmode = (opcode >> 6) & 0x7;
+		op.size = opmode == 0b011 ? size_type::WORD : size_type::LONG;
+		if(op.mode == addressing_mode::imm)
+			read_imm(op.size);
+
+		op.exec = &invoke<&translation_cache::alu_address_mode>;
+		wait_cycles = timings::alu_mode(op.inst, op.mode, opmode);
+		break;
+	}
+
+	case inst_type::ADDI:
+	case inst_type::SUBI:
+	case inst_type::ANDI:
+	case inst_type::ORI:
+	case inst_type::EORI:
+	case inst_type::CMPI: {
+		auto size = dec_size(opcode);
+		if(!size || op.mode != addressing_mode::data_reg)
+			return std::nullopt;
+
+		op.size = *size;
+		read_imm(op.size);
+
+		op.exec = &invoke<&translation_cache::alu_imm>;
+		wait_cycles = timings::alu_size(op.inst, op.mode, op.size);
+		break;
+	}
+
+	case inst_type::ADDQ:
+	case inst_type::SUBQ: {
+		auto size = dec_size(opcode);
+		if(!size || (op.mode != addressing_mode::data_reg && op.mode != addressing_mode::addr_reg))
+			return std::nullopt;
+
+		if(op.mode == addressing_mode::addr_reg && *size == size_type::BYTE)
+			return std::nullopt;
+
+		op.size = *size;
+		op.data = op.reg == 0 ? 8 : op.reg;
+
+		op.exec = &invoke<&translation_cache::alu_quick>;
+		wait_cycles = timings::alu_size(op.inst, op.mode, op.size);
+		break;
+	}
+
+	case inst_type::NEG:
+	case inst_type::NEGX:
+	case inst_type::NOT:
+	case inst_type::CLR:
+	case inst_type::NBCD: {
+		auto size = dec_size(opcode);
+		if(!size || op.mode != addressing_mode::data_reg)
+			return std::nullopt;
+
+		op.size = *size;
+		op.exec = &invoke<&translation_cache::unary>;
+		wait_cycles = timings::alu_size(op.inst, op.mode, op.size);
+		break;
+	}
+
+	case inst_type::MOVE: {
+		auto size = dec_move_size(opcode);
+		std::uint8_t ea_move = ((opcode >> 3) & 0b111000) | op.reg;
+		if(!size || !is_register_or_imm(op.mode) || ea_decoder::decode_mode(ea_move) != addressing_mode::data_reg)
+			return std::nullopt;
+
+		op.size = *size;
+		if(op.mode == addressing_mode::imm)
+			read_imm(op.size);
+
+		op.exec = &invoke<&translation_cache::move>;
+		break;
+	}
+
+	case inst_type::MOVEA:
+		if(!is_register_or_imm(op.mode))
+			return std::nullopt;
+
+		op.size = bit_is_set(opcode, 12) ? size_type::WORD : size_type::LONG;
+		if(op.mode == addressing_mode::imm)
+			read_imm(op.size);
+
+		op.exec = &invoke<&translation_cache::movea>;
+		break;
+
+	case inst_type::MOVEQ:
+		op.exec = &invoke<&translation_cache::moveq>;
+		break;
+
+	case inst_type::TST: {
+		auto size = dec_size(opcode);
+		if(!size || !is_register_or_imm(op.mode))
+			return std::nullopt;
+
+		op.size = *size;
+		if(op.mode == addressing_mode::imm)
+			read_imm(op.size);
+
+		op.exec = &invoke<&translation_cache::tst>;
+		break;
+	}
+
+	case inst_type::ASLRreg:
+	case inst_type::ROLRreg:
+	case inst_type::LSLRreg:
+	case inst_type::ROXLRreg: {
+		auto size = dec_size(opcode);
+		if(!size)
+			return std::nullopt;
+
+		op.size = *size;
+		op.exec = &invoke<&translation_cache::shift_reg>;
+		break;
+	}
+
+	case inst_type::MULU:
+	case inst_type::MULS:
+		if(!is_register_or_imm(op.mode))
+			return std::nullopt;
+
+		op.size = size_type::WORD;
+		if(op.mode == addressing_mode::imm)
+			read_imm(op.size);
+
+		op.exec = &invoke<&translation_cache::mul>;
+		break;
+
+	case inst_type::EXT:
+		op.exec = &invoke<&translation_cache::ext>;
+		break;
+
+	case inst_type::EXG: {
+		std::uint8_t opmode = (opcode >> 3) & 0b11111;
+		if(opmode != 0b01000 && opmode != 0b01001 && opmode != 0b10001)
+			return std::nullopt;
+
+		op.exec = &invoke<&translation_cache::exg>;
+		wait_cycles = timings::exg();
+		break;
+	}
+
+	case inst_type::SWAP:
+		op.exec = &invoke<&translation_cache::swap>;
+		break;
+
+	case inst_type::NOP:
+		op.exec = &invoke<&translation_cache::nop>;
+		break;
+
+	case inst_type::BTSTreg:
+		if(op.mode != addressing_mode::data_reg && op.mode != addressing_mode::imm)
+			return std::nullopt;
+
+		op.size = size_type::BYTE;
+		if(op.mode == addressing_mode::imm)
+			read_imm(op.size);
+
+		op.exec = &invoke<&translation_cache::btst>;
+		wait_cycles = timings::btst(op.mode);
+		break;
+
+	case inst_type::BTSTimm:
+		if(op.mode != addressing_mode::data_reg)
+			return std::nullopt;
+
+		op.size = size_type::BYTE;
+		read_imm(op.size);
+
+		op.exec = &invoke<&translation_cache::btst>;
+		wait_cycles = timings::btst(op.mode);
+		break;
+
+	case inst_type::BSETreg:
+	case inst_type::BCLRreg:
+	case inst_type::BCHGreg:
+	case inst_type::BSETimm:
+	case inst_type::BCLRimm:
+	case inst_type::BCHGimm:
+		if(op.mode != addressing_mode::data_reg)
+			return std::nullopt;
+
+		op.size = size_type::BYTE;
+		if(!bit_is_set(opcode, 8))
+			read_imm(op.size);
+
+		op.exec = &invoke<&translation_cache::bit>;
+		break;
+
+	case inst_type::SCC:
+		if(op.mode != addressing_mode::data_reg)
+			return std::nullopt;
+
+		op.size = size_type::BYTE;
+		op.exec = &invoke<&translation_cache::scc>;
+		break;
+
+	case inst_type::ABCDreg:
+	case inst_type::SBCDreg:
+		op.exec = &invoke<&translation_cache::bcd_reg>;
+		wait_cycles = timings::bcd_reg();
+		break;
+
+	case inst_type::LEA:
+		switch(op.mode)
+		{
+		case addressing_mode::indir:
+			break;
+
+		case addressing_mode::index_indir:
+		case addressing_mode::index_pc:
+			// decoding the brief extension word
+			wait_cycles = 2;
+			op.length = 2;
+			break;
+
+		case addressing_mode::disp_indir:
+		case addressing_mode::abs_short:
+		case addressing_mode::disp_pc:
+			op.length = 2;
+			break;
+
+		case addressing_mode::abs_long:
+			op.length = 3;
+			break;
+
+		default:
+			return std::nullopt;
+		}
+
+		op.exec = &invoke<&translation_cache::lea>;
+		wait_cycles += timings::lea(op.mode);
+		break;
+
+	case inst_type::BCC: {
+		std::int16_t disp = std::int8_t(opcode & 0xFF);
+		if(disp == 0)
+		{
+			disp = std::int16_t(op.ext[0]);
+			op.length = 2;
+		}
+
+		if(!set_target(pc + 2 + disp))
+			return std::nullopt;
+
+		op.exec = &invoke<&translation_cache::bcc>;
+		break;
+	}
+
+	case inst_type::DBCC:
+		op.length = 2;
+		if(!set_target(pc + 2 + std::int16_t(op.ext[0])))
+			return std::nullopt;
+
+		op.exec = &invoke<&translation_cache::dbcc>;
+		break;
+
+	default:
+		return std::nullopt;
+	}
+
+	// extension words and the words prefetched after them have to be in the same region
+	if(!region.contains(address, address + op.length * 2 + 3))
+		return std::nullopt;
+
+	op.cycles = op.length * 4 + wait_cycles;
+	return op;
+}
+
+operand translation_cache::ea_operand(const micro_op& op)
+{
+	if(op.mode == addressing_mode::data_reg)
+		return {m_regs.D(op.ea_reg), op.size};
+	if(op.mode == addressing_mode::addr_reg)
+		return {m_regs.A(op.ea_reg), op.size};
+	return {op.data, op.size};
+}
+
+std::uint32_t translation_cache::prefetch_one(const micro_op& op, std::uint32_t wait_cycles)
+{
+	// PC has been advanced by reading all extension words
+	const std::uint32_t pc = op.pc + op.length * 2;
+	if(op.length != 1)
+		m_regs.IRD = read_word(m_block->region, pc);
+	else
+		m_regs.IRD = m_regs.IRC;
+
+	m_regs.IR = m_regs.IRD;
+	m_regs.IRC = read_word(m_block->region, pc + 2);
+	m_regs.PC = pc;
+
+	// leave the bus as the last program read does
+	m_bus.set(bus::RW);
+	m_bus.address(pc + 2);
+	m_bus.data(m_regs.IRC);
+
+	++m_index;
+	return op.cycles + wait_cycles;
+}
+
+std::uint32_t translation_cache::prefetch_two(const memory::direct_region& region, std::uint32_t pc, block*& link,
+											  std::uint32_t wait_cycles)
+{
+	m_regs.IRD = m_regs.IR = read_word(region, pc);
+	m_regs.IRC = read_word(region, pc + 2);
+	m_regs.PC = pc;
+
+	m_bus.set(bus::RW);
+	m_bus.address(pc + 2);
+	m_bus.data(m_regs.IRC);
+
+	// continue with the run at the new PC, remember it to skip the lookup next time
+	if(link == nullptr)
+		link = &find(pc);
+
+	m_block = link;
+	m_index = 0;
+
+	return 8 + wait_cycles;
+}
+
+std::uint32_t translation_cache::alu_mode(micro_op& op)
+{
+	auto& reg = m_regs.D(op.reg);
+	auto ea = ea_operand(op);
+
+	if(!bit_is_set(op.opcode, 8))
+	{
+		std::uint32_t res = operations::alu(op.inst, reg, ea, op.size, m_regs.flags);
+		store(reg, op.size, res);
+	}
+	else
+	{
+		std::uint32_t res = operations::alu(op.inst, ea, reg, op.size, m_regs.flags);
+		store(ea, op.size, res);
+	}
+
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::alu_address_mode(micro_op& op)
+{
+	auto& reg = m_regs.A(op.reg);
+	reg.LW = operations::alu(op.inst, ea_operand(op), reg.LW, op.size, m_regs.flags);
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::alu_imm(micro_op& op)
+{
+	auto dest = ea_operand(op);
+	std::uint32_t res = operations::alu(op.inst, dest, op.data, op.size, m_regs.flags);
+	if(op.inst != inst_type::CMPI)
+		store(dest, op.size, res);
+
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::alu_quick(micro_op& op)
+{
+	auto dest = ea_operand(op);
+	std::uint32_t res = operations::aluq(op.inst, std::uint8_t(op.data), dest, op.size, m_regs.flags);
+	store(dest, op.size, res);
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::unary(micro_op& op)
+{
+	auto dest = ea_operand(op);
+	std::uint32_t res = operations::alu(op.inst, dest, op.size, m_regs.flags);
+	store(dest, op.size, res);
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::move(micro_op& op)
+{
+	std::uint32_t res = operations::alu(op.inst, ea_operand(op), op.size, m_regs.flags);
+	store(m_regs.D(op.reg), op.size, res);
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::movea(micro_op& op)
+{
+	m_regs.A(op.reg).LW = operations::movea(ea_operand(op), op.size);
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::moveq(micro_op& op)
+{
+	std::int32_t data = std::int8_t(op.opcode & 0xFF);
+	operations::move(data, size_type::LONG, m_regs.flags);
+	m_regs.D(op.reg).LW = data;
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::tst(micro_op& op)
+{
+	operations::tst(ea_operand(op), op.size, m_regs.flags);
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::shift_reg(micro_op& op)
+{
+	std::uint32_t shift_count;
+	if(bit_is_set(op.opcode, 5))
+		shift_count = m_regs.D(op.reg).B;
+	else
+		shift_count = op.reg == 0 ? 8 : op.reg;
+
+	auto& reg = m_regs.D(op.ea_reg);
+	bool is_left_shift = bit_is_set(op.opcode, 8);
+
+	std::uint32_t res = operations::shift(op.inst, reg, shift_count, is_left_shift, op.size, m_regs.flags);
+	store(reg, op.size, res);
+
+	return prefetch_one(op, timings::reg_shift(shift_count, op.size));
+}
+
+std::uint32_t translation_cache::mul(micro_op& op)
+{
+	auto ea = ea_operand(op);
+	auto& dest = m_regs.D(op.reg);
+	std::uint32_t src = operations::value(ea, size_type::WORD);
+
+	std::uint32_t res = operations::alu(op.inst, src, dest, size_type::WORD, m_regs.flags);
+	store(dest, size_type::LONG, res);
+
+	return prefetch_one(op, timings::mul(op.inst, src));
+}
+
+std::uint32_t translation_cache::ext(micro_op& op)
+{
+	auto& reg = m_regs.D(op.ea_reg);
+	size_type size = bit_is_set(op.opcode, 6) ? size_type::WORD : size_type::BYTE;
+
+	std::uint32_t res = operations::ext(reg, size, m_regs.flags);
+	store(reg, size == size_type::WORD ? size_type::LONG : size_type::WORD, res);
+
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::exg(micro_op& op)
+{
+	std::uint8_t opmode = (op.opcode >> 3) & 0b11111;
+	if(opmode == 0b01000)
+		operations::exg(m_regs.D(op.reg), m_regs.D(op.ea_reg));
+	else if(opmode == 0b01001)
+		operations::exg(m_regs.A(op.reg), m_regs.A(op.ea_reg));
+	else
+		operations::exg(m_regs.D(op.reg), m_regs.A(op.ea_reg));
+
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::swap(micro_op& op)
+{
+	auto& reg = m_regs.D(op.ea_reg);
+	reg.LW = operations::swap(reg, m_regs.flags);
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::nop(micro_op& op)
+{
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::btst(micro_op& op)
+{
+	// either BTST Dn,<ea> or BTST #<data>,Dn
+	auto dest = ea_operand(op);
+	if(op.inst == inst_type::BTSTreg)
+		operations::btst(m_regs.D(op.reg), dest, m_regs.flags);
+	else
+		operations::btst(op.data, dest, m_regs.flags);
+
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::bit(micro_op& op)
+{
+	auto dest = ea_operand(op);
+
+	std::uint8_t bit_number;
+	std::uint32_t res;
+	if(bit_is_set(op.opcode, 8))
+	{
+		auto& reg = m_regs.D(op.reg);
+		bit_number = operations::bit_number(reg, dest);
+		res = operations::bit(op.inst, reg, dest, m_regs.flags);
+	}
+	else
+	{
+		bit_number = operations::bit_number(op.data, dest);
+		res = operations::bit(op.inst, op.data, dest, m_regs.flags);
+	}
+
+	store(dest, size_type::LONG, res);
+	return prefetch_one(op, timings::bit(op.inst, op.mode, bit_number));
+}
+
+std::uint32_t translation_cache::scc(micro_op& op)
+{
+	bool cond = operations::cond_test((op.opcode >> 8) & 0b1111, m_regs.flags);
+
+	auto dest = ea_operand(op);
+	store(dest, size_type::BYTE, cond ? 0xFF : 0);
+
+	return prefetch_one(op, timings::scc(cond, op.mode));
+}
+
+std::uint32_t translation_cache::bcd_reg(micro_op& op)
+{
+	auto& dest = m_regs.D(op.reg);
+	auto& src = m_regs.D(op.ea_reg);
+
+	std::uint32_t res = operations::alu(op.inst, src, dest, size_type::BYTE, m_regs.flags);
+	store(dest, size_type::BYTE, res);
+
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::lea(micro_op& op)
+{
+	// IRC still holds the first extension word and PC points to it, as when ea_decoder decodes the address
+	std::uint32_t address;
+	switch(op.mode)
+	{
+	case addressing_mode::indir:
+		address = m_regs.A(op.ea_reg).LW;
+		break;
+
+	case addressing_mode::disp_indir:
+		address = (std::int32_t)m_regs.A(op.ea_reg).LW + std::int32_t((std::int16_t)op.ext[0]);
+		break;
+
+	case addressing_mode::index_indir:
+		address = ea_decoder::dec_brief_reg(m_regs.A(op.ea_reg).LW, m_regs);
+		break;
+
+	case addressing_mode::abs_short:
+		address = (std::int16_t)op.ext[0];
+		break;
+
+	case addressing_mode::abs_long:
+		address = (std::uint32_t(op.ext[0]) << 16) | op.ext[1];
+		break;
+
+	case addressing_mode::disp_pc:
+		address = m_regs.PC + (std::int16_t)op.ext[0];
+		break;
+
+	case addressing_mode::index_pc:
+		address = ea_decoder::dec_brief_reg(m_regs.PC, m_regs);
+		break;
+
+	default:
+		throw internal_error();
+	}
+
+	m_regs.A(op.reg).LW = address;
+	return prefetch_one(op);
+}
+
+std::uint32_t translation_cache::bcc(micro_op& op)
+{
+	bool cond = operations::cond_test((op.opcode >> 8) & 0b1111, m_regs.flags);
+	std::uint32_t wait_cycles = timings::bcc(cond);
+
+	if(cond)
+		return prefetch_two(op.target_region, op.data, op.taken, wait_cycles);
+
+	if(op.length == 2)
+		return prefetch_two(m_block->region, op.pc + 4, op.not_taken, wait_cycles);
+
+	return prefetch_one(op, wait_cycles);
+}
+
+std::uint32_t translation_cache::dbcc(micro_op& op)
+{
+	bool cond = operations::cond_test((op.opcode >> 8) & 0b1111, m_regs.flags);
+	std::uint32_t wait_cycles = timings::dbcc(cond);
+
+	if(!cond)
+	{
+		auto& reg = m_regs.D(op.ea_reg);
+		--reg.W;
+
+		bool take_branch = std::int16_t(reg.W) != -1;
+		if(take_branch)
+			return prefetch_two(op.target_region, op.data, op.taken, wait_cycles);
+	}
+
+	return prefetch_two(m_block->region, op.pc + 4, op.not_taken, wait_cycles);
+}
+
+} // namespace genesis::m68k::impl
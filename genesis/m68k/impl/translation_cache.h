@@ -0,0 +1,139 @@
+#ifndef __M68K_TRANSLATION_CACHE_H__
+#define __M68K_TRANSLATION_CACHE_H__
+
+#include "ea_decoder.hpp"
+#include "instruction_type.h"
+#include "m68k/cpu_bus.hpp"
+#include "m68k/cpu_registers.hpp"
+#include "memory/addressable.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+
+namespace genesis::m68k::impl
+{
+
+/* Runs of decoded instructions cached by PC for the instruction-level execution (see cpu::execute_one).
+ *
+ * Every instruction of a run is decoded ahead of time into a micro-op: the operation, register operands,
+ * extension words and the cycles it takes. Only instructions which don't access data memory are translated
+ * (register, immediate and quick operands, LEA, Bcc and DBcc), so replaying a micro-op leaves CPU in the same
+ * state and takes as many cycles as executing the instruction cycle by cycle. A run ends at a branch or at
+ * the first instruction which cannot be translated, such instruction is executed as usual.
+ *
+ * Runs are decoded from directly accessible memory (RAM/ROM) only. The opcode and extension words of a micro-op
+ * are compared with the prefetch queue and memory before it's replayed, so a run overwritten by anyone
+ * (CPU, DMA, Z80) is decoded again. */
+class translation_cache
+{
+public:
+	translation_cache(m68k::cpu_registers& regs, m68k::cpu_bus& bus, memory::addressable& memory);
+
+	// Execute the instruction at PC if it can be replayed. CPU must be idle and nothing (exceptions,
+	// bus requests) must be pending. Returns the number of elapsed cycles or 0 if the instruction
+	// has to be executed as usual.
+	std::uint32_t replay();
+
+private:
+	struct block;
+	struct micro_op;
+
+	using handler = std::uint32_t (*)(translation_cache&, micro_op&);
+
+	struct micro_op
+	{
+		handler exec;
+		inst_type inst;
+
+		std::uint32_t pc;
+		std::uint16_t opcode;
+		std::array<std::uint16_t, 2> ext;
+		std::uint8_t length; // in words, including the opcode
+
+		// cycles taken by the program reads and the static part of waits
+		std::uint8_t cycles;
+
+		size_type size;
+		addressing_mode mode; // mode of the effective address
+		std::uint8_t ea_reg;
+		std::uint8_t reg; // register encoded in bits 9-11
+
+		// immediate/quick data or the branch target
+		std::uint32_t data;
+
+		// branches only: memory of the target and the runs the branch led to last time
+		memory::direct_region target_region;
+		block* taken;
+		block* not_taken;
+	};
+
+	struct block
+	{
+		std::uint32_t pc;
+		bool translated;
+		memory::direct_region region;
+		std::vector<micro_op> ops;
+	};
+
+	void clear();
+	block& find(std::uint32_t pc);
+	void translate(block& blk);
+	std::optional<micro_op> decode(std::uint32_t pc, const memory::direct_region& region);
+	micro_op* next_op();
+	bool matches(const micro_op& op) const;
+
+	template <std::uint32_t (translation_cache::*Handler)(micro_op&)>
+	static std::uint32_t invoke(translation_cache& cache, micro_op& op)
+	{
+		return (cache.*Handler)(op);
+	}
+
+	/* replay handlers, see the same handlers of instruction_unit */
+	std::uint32_t alu_mode(micro_op& op);
+	std::uint32_t alu_address_mode(micro_op& op);
+	std::uint32_t alu_imm(micro_op& op);
+	std::uint32_t alu_quick(micro_op& op);
+	std::uint32_t unary(micro_op& op);
+	std::uint32_t move(micro_op& op);
+	std::uint32_t movea(micro_op& op);
+	std::uint32_t moveq(micro_op& op);
+	std::uint32_t tst(micro_op& op);
+	std::uint32_t shift_reg(micro_op& op);
+	std::uint32_t mul(micro_op& op);
+	std::uint32_t ext(micro_op& op);
+	std::uint32_t exg(micro_op& op);
+	std::uint32_t swap(micro_op& op);
+	std::uint32_t nop(micro_op& op);
+	std::uint32_t btst(micro_op& op);
+	std::uint32_t bit(micro_op& op);
+	std::uint32_t scc(micro_op& op);
+	std::uint32_t bcd_reg(micro_op& op);
+	std::uint32_t lea(micro_op& op);
+	std::uint32_t bcc(micro_op& op);
+	std::uint32_t dbcc(micro_op& op);
+
+	operand ea_operand(const micro_op& op);
+	std::uint32_t prefetch_one(const micro_op& op, std::uint32_t wait_cycles = 0);
+	std::uint32_t prefetch_two(const memory::direct_region& region, std::uint32_t pc, block*& link,
+							   std::uint32_t wait_cycles);
+
+private:
+	m68k::cpu_registers& m_regs;
+	m68k::cpu_bus& m_bus;
+	memory::addressable& m_memory;
+
+	std::unordered_map<std::uint32_t, std::unique_ptr<block>> m_blocks;
+
+	// the run and the micro-op to replay next
+	block* m_block = nullptr;
+	std::size_t m_index = 0;
+};
+
+} // namespace genesis::m68k::impl
+
+#endif // __M68K_TRANSLATION_CACHE_H__
@@ -1,23 +1,73 @@
+#include "emulation_thread.h"
 #include "rom.h"
 #include "rom_debug.hpp"
+#include "sdl/active_display.h"
+#include "sdl/debug_views.h"
 #include "sdl/input_device.h"
-#include "sdl/palette_display.h"
-#include "sdl/plane_display.h"
 #include "smd/smd.h"
 #include "string_utils.hpp"
 #include "time_utils.h"
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
 #include <filesystem>
 #include <iomanip>
 #include <iostream>
 #include <string_view>
+#include <thread>
 
 using namespace genesis;
 
 
+struct options
+{
+	std::string_view rom_path;
+	bool debug_views = false;
+	unsigned debug_refresh_rate = 10;
+};
+
 void print_usage(const char* prog_path)
 {
-	std::wcout << "Usage ." << std::filesystem::path::preferred_separator << prog_path << " <path to rom>\n";
+	std::wcout << "Usage ." << std::filesystem::path::preferred_separator << prog_path
+			   << " <path to rom> [--debug-views] [--debug-refresh-rate N]\n";
+}
+
+// the whole string must be a number which fits into T
+template <class T>
+bool parse_number(std::string_view str, T& value)
+{
+	auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+	return ec == std::errc{} && ptr == str.data() + str.size();
+}
+
+bool parse_options(int args, char* argv[], options& opts)
+{
+	if(args < 2)
+		return false;
+
+	opts.rom_path = argv[1];
+
+	for(int i = 2; i < args; ++i)
+	{
+		std::string_view arg = argv[i];
+
+		if(arg == "--debug-views")
+		{
+			opts.debug_views = true;
+		}
+		else if(arg == "--debug-refresh-rate" && i + 1 < args)
+		{
+			if(!parse_number(argv[++i], opts.debug_refresh_rate) || opts.debug_refresh_rate == 0)
+				return false;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return true;
 }
 
 void print_key_layout(const std::map<int /* SDLK */, io_ports::key_type>& layout)
@@ -41,6 +91,12 @@ void print_key_layout(const std::map<int /* SDLK */, io_ports::key_type>& layout
 		std::cout << std::setw(5) << io_ports::key_type_name(key) << " -> " << SDL_GetKeyName(sdl_key) << '\n';
 	}
 
+	for(auto view : sdl::debug_views::all_views)
+	{
+		std::cout << std::setw(5) << SDL_GetKeyName(sdl::debug_views::hot_key(view)) << " -> toggle "
+				  << sdl::debug_views::name(view) << " view\n";
+	}
+
 	std::cout << "====================\n";
 }
 
@@ -51,47 +107,6 @@ void measure_and_log(T func, std::string_view msg)
 	std::cout << "Executing " << msg << " took " << ms << " ms\n";
 }
 
-std::vector<std::unique_ptr<sdl::displayable>> create_displays(smd& smd, std::string_view rom_title)
-{
-	// TODO: interface between vdp/smd is not established yet, so use vdp::render directly
-
-	std::vector<std::unique_ptr<sdl::displayable>> displays;
-
-	displays.push_back(std::make_unique<sdl::palette_display>(smd.vdp().cram()));
-
-	using vdp::impl::plane_type;
-
-	displays.push_back(std::make_unique<sdl::plane_display>(
-		"plane a", [&smd]() { return smd.vdp().render().plane_width_in_pixels(plane_type::a); },
-		[&smd]() { return smd.vdp().render().plane_height_in_pixels(plane_type::a); },
-		[&smd](unsigned row_number, sdl::plane_display::row_buffer buffer) {
-			return smd.vdp().render().get_plane_row(genesis::vdp::impl::plane_type::a, row_number, buffer);
-		}));
-
-	displays.push_back(std::make_unique<sdl::plane_display>(
-		"plane b", [&smd]() { return smd.vdp().render().plane_width_in_pixels(plane_type::b); },
-		[&smd]() { return smd.vdp().render().plane_height_in_pixels(plane_type::b); },
-		[&smd](unsigned row_number, sdl::plane_display::row_buffer buffer) {
-			return smd.vdp().render().get_plane_row(genesis::vdp::impl::plane_type::b, row_number, buffer);
-		}));
-
-	displays.push_back(std::make_unique<sdl::plane_display>(
-		"sprites", [&smd]() { return smd.vdp().render().sprite_width_in_pixels(); },
-		[&smd]() { return smd.vdp().render().sprite_height_in_pixels(); },
-		[&smd](unsigned row_number, sdl::plane_display::row_buffer buffer) {
-			return smd.vdp().render().get_sprite_row(row_number, buffer);
-		}));
-
-	displays.push_back(std::make_unique<sdl::plane_display>(
-		rom_title, [&smd]() { return smd.vdp().render().active_display_width(); },
-		[&smd]() { return smd.vdp().render().active_display_height(); },
-		[&smd](unsigned row_number, sdl::plane_display::row_buffer buffer) {
-			return smd.vdp().render().get_active_display_row(row_number, buffer);
-		}));
-
-	return displays;
-}
-
 std::string get_rom_title(const genesis::rom& rom)
 {
 	const auto& header = rom.header();
@@ -102,7 +117,8 @@ std::string get_rom_title(const genesis::rom& rom)
 
 int main(int args, char* argv[])
 {
-	if(args != 2)
+	options opts;
+	if(!parse_options(args, argv, opts))
 	{
 		print_usage(argv[0]);
 		return EXIT_FAILURE;
@@ -110,7 +126,7 @@ int main(int args, char* argv[])
 
 	try
 	{
-		std::string_view rom_path = argv[1];
+		std::string_view rom_path = opts.rom_path;
 
 		std::cout << "Reading " << rom_path << '\n';
 		genesis::rom rom(rom_path);
@@ -135,52 +151,48 @@ int main(int args, char* argv[])
 
 		genesis::smd smd(rom, input_device);
 
-		auto displays = create_displays(smd, rom_title);
+		// debug views are opened on demand (by hot keys), the default front end pays only for the active display
+		sdl::debug_views debug_views(smd.vdp(), opts.debug_refresh_rate);
+		if(opts.debug_views)
+		{
+			for(auto view : sdl::debug_views::all_views)
+				debug_views.open(view);
+		}
+
+		// active display is rendered by VDP itself during emulation and picked up from the framebuffer
+		sdl::active_display active_display(rom_title, smd.vdp().framebuffer());
+
+		// emulation runs on its own thread, this thread presents frames, handles input and paces the output
+		emulation_thread emulation(smd);
 
-		smd.vdp().on_frame_end([&]() {
-			// measure_and_log([&]()
-			// {
-			for(auto& disp : displays)
-				disp->update();
+		using clock = std::chrono::steady_clock;
+		const auto present_period =
+			std::chrono::duration_cast<clock::duration>(std::chrono::nanoseconds(1'000'000'000 / 60));
+		auto next_present = clock::now();
 
+		while(emulation.is_running() && !(active_display.is_closed() && !debug_views.any_open()))
+		{
 			SDL_Event e;
 			while(SDL_PollEvent(&e) > 0)
 			{
-				for(auto& disp : displays)
-					disp->handle_event(e);
+				active_display.handle_event(e);
+				debug_views.handle_event(e);
 				input_device->handle_event(e);
 			}
-			// }, "render frame");
-		});
 
-		const auto batch_cycles = 10'000'000ull;
-		auto cycle = 0ull;
+			active_display.update();
 
-		auto start = std::chrono::high_resolution_clock::now();
+			// debug views read VDP state, so they are updated only while emulation is paused
+			auto now = clock::now();
+			if(debug_views.update_required(now))
+				emulation.with_paused([&]() { debug_views.update(now); });
 
-		while(true) // Don't really care about timings so far
-		{
-			smd.cycle();
-			++cycle;
-
-			if(cycle == batch_cycles)
-			{
-				auto stop = std::chrono::high_resolution_clock::now();
-				auto dur = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
-				auto ns_per_cycle = dur / cycle;
-				std::cout << "ns per cycle: " << ns_per_cycle.count() << '\n';
-
-				start = stop;
-				cycle = 0;
-
-				bool all_closed =
-					std::all_of(displays.cbegin(), displays.cend(), [](const auto& d) { return d->is_closed(); });
-				if(all_closed)
-				{
-					break;
-				}
-			}
+			// don't spin if presenting took less than a frame, skip the wait if it took longer
+			next_present = std::max(next_present + present_period, clock::now());
+			std::this_thread::sleep_until(next_present);
 		}
+
+		emulation.stop();
 	}
 	catch(const std::invalid_argument& e)
 	{
@@ -0,0 +1,102 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace genesis
+{
+
+#if defined(_WIN32)
+
+mapped_file::mapped_file(const std::filesystem::path& path)
+{
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+							  FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("failed to open file '" + path.string() + "'");
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		throw std::runtime_error("failed to get size of file '" + path.string() + "'");
+	}
+
+	m_size = static_cast<std::size_t>(size.QuadPart);
+	if(m_size == 0)
+	{
+		// empty files cannot be mapped
+		CloseHandle(file);
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if(mapping == nullptr)
+		throw std::runtime_error("failed to map file '" + path.string() + "'");
+
+	// the view keeps a reference to the mapping object
+	m_data = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	CloseHandle(mapping);
+	if(m_data == nullptr)
+		throw std::runtime_error("failed to map file '" + path.string() + "'");
+}
+
+mapped_file::~mapped_file()
+{
+	if(m_data != nullptr)
+		UnmapViewOfFile(m_data);
+}
+
+#else
+
+mapped_file::mapped_file(const std::filesystem::path& path)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if(fd == -1)
+		throw std::runtime_error("failed to open file '" + path.string() + "'");
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+	{
+		close(fd);
+		throw std::runtime_error("failed to open file '" + path.string() + "': not a regular file");
+	}
+
+	m_size = static_cast<std::size_t>(st.st_size);
+	if(m_size == 0)
+	{
+		// empty files cannot be mapped
+		close(fd);
+		return;
+	}
+
+	// the mapping stays valid after the descriptor is closed
+	void* addr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(addr == MAP_FAILED)
+		throw std::runtime_error("failed to map file '" + path.string() + "'");
+
+	m_data = static_cast<const std::uint8_t*>(addr);
+}
+
+mapped_file::~mapped_file()
+{
+	if(m_data != nullptr)
+		munmap(const_cast<std::uint8_t*>(m_data), m_size);
+}
+
+#endif
+
+} // namespace genesis
@@ -0,0 +1,40 @@
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+
+namespace genesis
+{
+
+/* Read-only memory mapping of the whole file.
+ * Bytes past the end of the file up to the end of the last page are zero-filled by OS. */
+class mapped_file
+{
+public:
+	mapped_file(const std::filesystem::path& path);
+	~mapped_file();
+
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+
+	std::span<const std::uint8_t> data() const
+	{
+		return {m_data, m_size};
+	}
+
+	std::size_t size() const
+	{
+		return m_size;
+	}
+
+private:
+	const std::uint8_t* m_data = nullptr;
+	std::size_t m_size = 0;
+};
+
+} // namespace genesis
+
+#endif // __MAPPED_FILE_H__
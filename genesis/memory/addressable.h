@@ -1,11 +1,51 @@
 #ifndef __MEMORY_ADDRESSABLE_H__
 #define __MEMORY_ADDRESSABLE_H__
 
+#include "endian.hpp"
+
+#include <bit>
 #include <cstdint>
+#include <cstring>
+#include <optional>
 
 namespace genesis::memory
 {
 
+/* Host memory directly backing [first_address; last_address] of the device address space */
+struct direct_region
+{
+	// points to the byte at first_address
+	std::uint8_t* data;
+
+	std::uint32_t first_address;
+	std::uint32_t last_address;
+
+	std::endian byte_order;
+	bool writable;
+
+	bool contains(std::uint32_t first, std::uint32_t last) const
+	{
+		return first_address <= first && last <= last_address;
+	}
+
+	// NOTE: address must belong to the region, it's not checked
+	template <class T>
+	T read(std::uint32_t address) const
+	{
+		T val;
+		std::memcpy(&val, data + (address - first_address), sizeof(T));
+		endian::sys_convert(val, byte_order);
+		return val;
+	}
+
+	template <class T>
+	void write(std::uint32_t address, T val) const
+	{
+		endian::sys_convert(val, byte_order);
+		std::memcpy(data + (address - first_address), &val, sizeof(T));
+	}
+};
+
 class addressable
 {
 public:
@@ -23,6 +63,14 @@ public:
 
 	virtual std::uint8_t latched_byte() const = 0;
 	virtual std::uint16_t latched_word() const = 0;
+
+	// Fast path for plain memory without side effects on read/write (RAM/ROM).
+	// Returns the directly accessible region containing the address,
+	// devices with side effects must be accessed via init_*/latched_* methods only.
+	virtual std::optional<direct_region> direct_access(std::uint32_t /* address */)
+	{
+		return std::nullopt;
+	}
 };
 
 }; // namespace genesis::memory
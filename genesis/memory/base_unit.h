@@ -76,6 +76,11 @@ public:
 		return m_latched_word.value();
 	}
 
+	std::optional<direct_region> direct_access(std::uint32_t /* address */) override
+	{
+		return direct_region{m_buffer.data(), 0, max_address(), m_byte_order, true};
+	}
+
 	/* direct interface */
 
 	template <class T>
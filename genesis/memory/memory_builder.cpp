@@ -3,7 +3,9 @@
 #include "exception.hpp"
 #include "string_utils.hpp"
 
+#include <algorithm>
 #include <functional>
+#include <map>
 #include <optional>
 #include <stdexcept>
 
@@ -26,80 +28,144 @@ bool is_intersect(const auto& device, std::uint32_t address)
 
 class composite_memory : public addressable
 {
+private:
+	/* Address space is split into pages of equal size. A page is either
+	 * - served by a single device (which covers the whole page), so lookup is just an index
+	 * - shared by a few devices, so lookup requires a short scan over these devices
+	 * - not served by any device */
+	static constexpr std::uint32_t page_bits = 8;
+	static constexpr std::uint32_t page_size = 1 << page_bits;
+
+	static constexpr std::uint16_t mixed_page = 0x8000;
+	static constexpr std::uint16_t unmapped_page = 0xFFFF;
+
+	struct mixed_page_range
+	{
+		std::uint32_t first;
+		std::uint32_t last;
+	};
+
 public:
 	/* Addressable interface */
 
 	std::uint32_t max_address() const override
 	{
-		std::uint32_t max_address = 0;
-		for(auto& dev : m_refs)
-			max_address = std::max(max_address, dev.end_address);
-		return max_address;
+		return m_max_address;
 	}
 
 	bool is_idle() const override
 	{
-		if(m_last_device.has_value() == false)
+		if(m_last_device == nullptr)
 		{
-			// there were not requests so far
+			// there were not requests so far or the last one was served directly
 			return true;
 		}
 
-		return m_last_device.value().memory_unit.get().is_idle();
+		return m_last_device->memory_unit.get().is_idle();
 	}
 
 	void init_write(std::uint32_t address, std::uint8_t data) override
 	{
 		assert_idle();
 
-		auto dev = find_device(address);
-		address = convert_address(dev, address);
-		dev.memory_unit.get().init_write(address, data);
+		auto dev_index = find_device(address);
+		if(auto& direct = m_direct[dev_index]; direct.writable && direct.contains(address, address))
+		{
+			direct.write(address, data);
+			m_last_device = nullptr;
+			return;
+		}
+
+		auto& dev = m_refs[dev_index];
+		dev.memory_unit.get().init_write(convert_address(dev, address), data);
 
-		m_last_device.emplace(dev);
+		m_last_device = &dev;
 	}
 
 	void init_write(std::uint32_t address, std::uint16_t data) override
 	{
 		assert_idle();
 
-		auto dev = find_device(address);
-		address = convert_address(dev, address);
-		dev.memory_unit.get().init_write(address, data);
+		auto dev_index = find_device(address);
+		if(auto& direct = m_direct[dev_index]; direct.writable && direct.contains(address, address + 1))
+		{
+			direct.write(address, data);
+			m_last_device = nullptr;
+			return;
+		}
+
+		auto& dev = m_refs[dev_index];
+		dev.memory_unit.get().init_write(convert_address(dev, address), data);
 
-		m_last_device.emplace(dev);
+		m_last_device = &dev;
 	}
 
 	void init_read_byte(std::uint32_t address) override
 	{
 		assert_idle();
 
-		auto dev = find_device(address);
-		address = convert_address(dev, address);
-		dev.memory_unit.get().init_read_byte(address);
+		auto dev_index = find_device(address);
+		if(auto& direct = m_direct[dev_index]; direct.data != nullptr && direct.contains(address, address))
+		{
+			m_latched_byte = direct.read<std::uint8_t>(address);
+			m_last_device = nullptr;
+			return;
+		}
+
+		auto& dev = m_refs[dev_index];
+		dev.memory_unit.get().init_read_byte(convert_address(dev, address));
 
-		m_last_device.emplace(dev);
+		m_last_device = &dev;
 	}
 
 	void init_read_word(std::uint32_t address) override
 	{
 		assert_idle();
 
-		auto dev = find_device(address);
-		address = convert_address(dev, address);
-		dev.memory_unit.get().init_read_word(address);
+		auto dev_index = find_device(address);
+		if(auto& direct = m_direct[dev_index]; direct.data != nullptr && direct.contains(address, address + 1))
+		{
+			m_latched_word = direct.read<std::uint16_t>(address);
+			m_last_device = nullptr;
+			return;
+		}
+
+		auto& dev = m_refs[dev_index];
+		dev.memory_unit.get().init_read_word(convert_address(dev, address));
 
-		m_last_device.emplace(dev);
+		m_last_device = &dev;
 	}
 
 	std::uint8_t latched_byte() const override
 	{
-		return m_last_device.value().memory_unit.get().latched_byte();
+		if(m_last_device == nullptr)
+			return m_latched_byte;
+		return m_last_device->memory_unit.get().latched_byte();
 	}
 
 	std::uint16_t latched_word() const override
 	{
-		return m_last_device.value().memory_unit.get().latched_word();
+		if(m_last_device == nullptr)
+			return m_latched_word;
+		return m_last_device->memory_unit.get().latched_word();
+	}
+
+	std::optional<direct_region> direct_access(std::uint32_t address) override
+	{
+		auto dev_index = try_find_device(address);
+		if(!dev_index.has_value())
+			return std::nullopt;
+
+		auto& dev = m_refs[dev_index.value()];
+		auto region = dev.memory_unit.get().direct_access(convert_address(dev, address));
+		if(!region.has_value())
+			return std::nullopt;
+
+		// convert to the composite address space
+		std::uint64_t last_address = std::uint64_t(region->last_address) + dev.start_address;
+		region->first_address += dev.start_address;
+		region->last_address = static_cast<std::uint32_t>(std::min<std::uint64_t>(last_address, dev.end_address));
+		return region;
 	}
 
 	/* Composite interface */
@@ -108,6 +174,8 @@ public:
 	{
 		m_refs = std::move(devices);
 		m_refs.shrink_to_fit();
+
+		build_pages();
 	}
 
 	void save_ptrs(std::vector<std::shared_ptr<addressable>> ptrs)
@@ -131,30 +199,118 @@ private:
 		}
 	}
 
-	addressable_device find_device(std::uint32_t address) const
+	std::uint16_t find_device(std::uint32_t address) const
 	{
-		for(auto& dev : m_refs)
+		auto dev_index = try_find_device(address);
+		if(!dev_index.has_value())
+			throw std::runtime_error("cannot find addressable device serving address " + su::hex_str(address));
+		return dev_index.value();
+	}
+
+	std::optional<std::uint16_t> try_find_device(std::uint32_t address) const
+	{
+		std::uint32_t page = address >> page_bits;
+		if(page >= m_pages.size())
+			return std::nullopt;
+
+		std::uint16_t entry = m_pages[page];
+		if(entry < mixed_page)
+			return entry;
+
+		if(entry != unmapped_page)
 		{
-			if(dev.start_address <= address && address <= dev.end_address)
-				return dev;
+			auto range = m_mixed_ranges[entry & ~mixed_page];
+			for(auto i = range.first; i < range.last; ++i)
+			{
+				auto& dev = m_refs[m_mixed_devices[i]];
+				if(dev.start_address <= address && address <= dev.end_address)
+					return m_mixed_devices[i];
+			}
 		}
 
-		throw std::runtime_error("cannot find addressable device serving address " + su::hex_str(address));
+		return std::nullopt;
 	}
 
-	static std::uint32_t convert_address(addressable_device dev, std::uint32_t address)
+	static std::uint32_t convert_address(const addressable_device& dev, std::uint32_t address)
 	{
 		return address - dev.start_address;
 	}
 
+	void build_pages()
+	{
+		if(m_refs.size() >= mixed_page)
+			throw internal_error("too many devices in a single address space");
+
+		m_max_address = 0;
+		for(auto& dev : m_refs)
+			m_max_address = std::max(m_max_address, dev.end_address);
+
+		std::uint32_t num_pages = (m_max_address >> page_bits) + 1;
+		m_pages.assign(num_pages, unmapped_page);
+
+		// devices which serve only part of the page
+		std::map<std::uint32_t /* page */, std::vector<std::uint16_t> /* devices */> partial_pages;
+
+		for(std::uint16_t i = 0; i < m_refs.size(); ++i)
+		{
+			auto& dev = m_refs[i];
+			for(std::uint32_t page = dev.start_address >> page_bits; page <= (dev.end_address >> page_bits); ++page)
+			{
+				std::uint32_t page_start = page << page_bits;
+				std::uint32_t page_end = page_start + (page_size - 1);
+
+				if(dev.start_address <= page_start && page_end <= dev.end_address)
+					m_pages[page] = i;
+				else
+					partial_pages[page].push_back(i);
+			}
+		}
+
+		for(auto& [page, devices] : partial_pages)
+		{
+			std::uint32_t first = m_mixed_devices.size();
+			m_mixed_devices.insert(m_mixed_devices.end(), devices.begin(), devices.end());
+
+			m_pages[page] = mixed_page | static_cast<std::uint16_t>(m_mixed_ranges.size());
+			m_mixed_ranges.push_back({first, static_cast<std::uint32_t>(m_mixed_devices.size())});
+		}
+
+		if(m_mixed_ranges.size() >= (unmapped_page & ~mixed_page))
+			throw internal_error("too many mixed pages in a single address space");
+
+		m_mixed_devices.shrink_to_fit();
+		m_mixed_ranges.shrink_to_fit();
+
+		// cache devices which could be accessed directly over the whole mapped range
+		m_direct.assign(m_refs.size(), direct_region{nullptr, 0, 0, std::endian::native, false});
+		for(std::uint16_t i = 0; i < m_refs.size(); ++i)
+		{
+			auto& dev = m_refs[i];
+			auto region = direct_access(dev.start_address);
+			if(region.has_value() && region->contains(dev.start_address, dev.end_address))
+				m_direct[i] = region.value();
+		}
+	}
+
 private:
 	std::vector<addressable_device> m_refs;
 
+	std::uint32_t m_max_address = 0;
+	std::vector<std::uint16_t> m_pages;
+	std::vector<std::uint16_t> m_mixed_devices;
+	std::vector<mixed_page_range> m_mixed_ranges;
+
+	// direct access region for every device (data is nullptr if device doesn't support it)
+	std::vector<direct_region> m_direct;
+
 	// keep ptrs to prevent deallocation
 	std::vector<std::shared_ptr<addressable>> m_shared_ptrs;
 	std::vector<std::unique_ptr<addressable>> m_unique_ptrs;
 
-	std::optional<addressable_device> m_last_device;
+	// nullptr if the last request was served directly
+	const addressable_device* m_last_device = nullptr;
+	std::uint8_t m_latched_byte = 0;
+	std::uint16_t m_latched_word = 0;
 };
 
 
@@ -23,6 +23,13 @@ public:
 		rise_access_violation(address, data);
 	}
 
+	std::optional<direct_region> direct_access(std::uint32_t address) override
+	{
+		auto region = memory_unit::direct_access(address);
+		region.value().writable = false;
+		return region;
+	}
+
 private:
 	template <class T>
 	static void rise_access_violation(std::uint32_t address, T data)
@@ -0,0 +1,51 @@
+#ifndef __MEMORY_ROM_MEMORY_UNIT_H__
+#define __MEMORY_ROM_MEMORY_UNIT_H__
+
+#include "base_unit.h"
+
+#include <memory>
+
+namespace genesis::memory
+{
+
+/* Cartridge ROM over externally owned read-only data (i.e. memory-mapped ROM file).
+ * Data is never copied, writes are ignored as there is nothing to write to on real hardware. */
+
+class rom_memory_unit : public base_unit
+{
+public:
+	/* in bytes [0 ; size - 1] */
+	rom_memory_unit(std::shared_ptr<const std::uint8_t> data, std::size_t size,
+					std::endian byte_order = std::endian::native)
+		// the buffer is never written, so casting away const is safe
+		: base_unit(std::span<std::uint8_t>(const_cast<std::uint8_t*>(data.get()), size), byte_order),
+		  m_data(std::move(data))
+	{
+	}
+
+	void init_write(std::uint32_t /* address */, std::uint8_t /* data */) override
+	{
+	}
+
+	void init_write(std::uint32_t /* address */, std::uint16_t /* data */) override
+	{
+	}
+
+	std::optional<direct_region> direct_access(std::uint32_t address) override
+	{
+		auto region = base_unit::direct_access(address);
+		region.value().writable = false;
+		return region;
+	}
+
+	// the buffer may be a read-only mapping, so direct writes are not allowed either
+	template <class T>
+	void write(std::uint32_t address, T data) = delete;
+
+private:
+	std::shared_ptr<const std::uint8_t> m_data;
+};
+
+} // namespace genesis::memory
+
+#endif // __MEMORY_ROM_MEMORY_UNIT_H__
@@ -2,27 +2,55 @@
 
 #include "endian.hpp"
 #include "exception.hpp"
+#include "inflate.h"
+#include "mapped_file.h"
 #include "string_utils.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
 #include <cstring>
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
 #include <ranges>
+#include <thread>
+#include <vector>
 
 
 namespace genesis
 {
 
+struct raw_rom
+{
+	// must be readable (and zero-padded) up to the even size
+	std::shared_ptr<const std::uint8_t> data;
+	std::size_t size;
+};
+
 class rom_parser
 {
 public:
 	virtual ~rom_parser() = default;
 
 	virtual std::vector<std::string_view> supported_extentions() const = 0;
-	virtual std::vector<std::uint8_t> read_raw_rom(std::ifstream&) const = 0;
+	virtual raw_rom read_raw_rom(const std::filesystem::path&) const = 0;
 };
 
+void check_rom_size(std::size_t size)
+{
+	if(size > rom::MAX_SIZE)
+		throw std::runtime_error("ROM is too big");
+
+	if(size < rom::MIN_SIZE)
+		throw std::runtime_error("ROM is too small");
+}
+
 class bin_rom_parser : public rom_parser
 {
 public:
@@ -31,37 +59,354 @@ public:
 		return {".bin", ".md"};
 	}
 
-	std::vector<std::uint8_t> read_raw_rom(std::ifstream& fs) const override
+	raw_rom read_raw_rom(const std::filesystem::path& rom_path) const override
+	{
+		// ROM is mapped as is, so no copy/padding is required.
+		// The tail of the last page is zero-filled, and if the size is page aligned it's already even.
+		auto file = std::make_shared<mapped_file>(rom_path);
+		check_rom_size(file->size());
+
+		auto data = file->data();
+		return {std::shared_ptr<const std::uint8_t>(std::move(file), data.data()), data.size()};
+	}
+};
+
+template <class T>
+T read_little(std::span<const std::uint8_t> buffer, std::size_t offset)
+{
+	if(offset + sizeof(T) > buffer.size())
+		throw std::runtime_error("ROM archive is corrupted");
+	T data;
+	std::memcpy(&data, buffer.data() + offset, sizeof(T));
+	endian::little_to_sys(data); // gzip/zip use little-endian format
+	return data;
+}
+
+// per-user cache directory, empty if it cannot be determined
+std::filesystem::path user_cache_dir()
+{
+#if defined(_WIN32)
+	wchar_t* local_app_data = nullptr;
+	std::size_t len = 0;
+	if(_wdupenv_s(&local_app_data, &len, L"LOCALAPPDATA") != 0 || local_app_data == nullptr)
+		return {};
+
+	std::filesystem::path base(local_app_data);
+	std::free(local_app_data);
+#else
+	std::filesystem::path base;
+	if(const char* xdg_cache = std::getenv("XDG_CACHE_HOME"); xdg_cache != nullptr && *xdg_cache == '/')
+		base = xdg_cache;
+	else if(const char* home = std::getenv("HOME"); home != nullptr && *home == '/')
+		base = std::filesystem::path(home) / ".cache";
+#endif
+
+	if(base.empty())
+		return {};
+	return base / "genesis" / "rom_cache";
+}
+
+/* Decompressed ROMs are cached on disk keyed by the hash of the archive,
+ * so repeat launches map the cached image instead of inflating it again.
+ * NOTE: cached ROMs are never evicted. */
+class rom_cache
+{
+public:
+	rom_cache(std::span<const std::uint8_t> archive)
+	{
+		// FNV-1a
+		std::uint64_t hash = 0xCBF29CE484222325;
+		for(auto byte : archive)
+			hash = (hash ^ byte) * 0x100000001B3;
+
+		auto dir = user_cache_dir();
+		if(!dir.empty())
+			m_path = dir / (su::hex_str(hash).substr(2) + '-' + std::to_string(archive.size()) + ".bin");
+	}
+
+	// the cached file is used only if it is exactly the ROM from the archive, otherwise it's removed
+	std::optional<raw_rom> load(std::size_t expected_size, std::uint32_t expected_crc) const
+	{
+		std::error_code ec;
+		if(m_path.empty() || !std::filesystem::exists(m_path, ec))
+			return std::nullopt;
+
+		try
+		{
+			auto file = std::make_shared<mapped_file>(m_path);
+			auto data = file->data();
+			if(data.size() == expected_size && crc32(data) == expected_crc)
+				return raw_rom{std::shared_ptr<const std::uint8_t>(std::move(file), data.data()), data.size()};
+		}
+		catch(const std::runtime_error&)
+		{
+		}
+
+		std::filesystem::remove(m_path, ec);
+		return std::nullopt;
+	}
+
+	// cache is best effort, so failures are ignored
+	void store(std::span<const std::uint8_t> data) const
+	{
+		if(m_path.empty())
+			return;
+
+		std::error_code ec;
+		std::filesystem::create_directories(m_path.parent_path(), ec);
+		if(ec)
+			return;
+
+		// the cache is private to the user
+		std::filesystem::permissions(m_path.parent_path(), std::filesystem::perms::owner_all,
+									 std::filesystem::perm_options::replace, ec);
+		if(ec)
+			return;
+
+		// write to temporary file first, so other instances never see partially written ROM,
+		// the name is unique per process as several instances may store the same ROM at once
+		auto tmp_path = m_path;
+		tmp_path += '.' + su::hex_str(unique_suffix()).substr(2) + ".tmp";
+
+		{
+			std::ofstream fs(tmp_path, std::ios_base::binary | std::ios_base::trunc);
+			fs.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+			if(!fs.good())
+			{
+				fs.close();
+				std::filesystem::remove(tmp_path, ec);
+				return;
+			}
+		}
+
+		std::filesystem::rename(tmp_path, m_path, ec);
+	}
+
+private:
+	static std::uint32_t unique_suffix()
+	{
+		auto thread_hash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+		auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+		return static_cast<std::uint32_t>(std::random_device{}() ^ thread_hash ^ now);
+	}
+
+	std::filesystem::path m_path;
+};
+
+/* Base parser for compressed containers: ROM is inflated straight into the final ROM buffer */
+class compressed_rom_parser : public rom_parser
+{
+protected:
+	enum class method
+	{
+		stored,
+		deflate,
+	};
+
+	struct entry
+	{
+		std::span<const std::uint8_t> data;
+		method compression;
+		std::size_t size;
+		std::uint32_t crc;
+	};
+
+	virtual entry find_entry(std::span<const std::uint8_t> archive) const = 0;
+
+public:
+	raw_rom read_raw_rom(const std::filesystem::path& rom_path) const override
+	{
+		mapped_file file(rom_path);
+		auto rom_entry = find_entry(file.data());
+		check_rom_size(rom_entry.size);
+
+		rom_cache cache(file.data());
+		if(auto cached = cache.load(rom_entry.size, rom_entry.crc))
+			return cached.value();
+
+		// allocate one more byte for odd sized ROMs, so it's readable up to the even size
+		const std::size_t buffer_size = (rom_entry.size + 1) & ~std::size_t(1);
+		auto buffer = std::make_shared_for_overwrite<std::uint8_t[]>(buffer_size);
+		buffer[buffer_size - 1] = 0;
+
+		std::span<std::uint8_t> rom_data(buffer.get(), rom_entry.size);
+		if(rom_entry.compression == method::stored)
+		{
+			if(rom_entry.data.size() != rom_entry.size)
+				throw std::runtime_error("ROM archive is corrupted");
+			std::memcpy(rom_data.data(), rom_entry.data.data(), rom_entry.size);
+		}
+		else if(inflate(rom_entry.data, rom_data) != rom_entry.size)
+		{
+			throw std::runtime_error("ROM archive is corrupted: unexpected decompressed size");
+		}
+
+		if(crc32(rom_data) != rom_entry.crc)
+			throw std::runtime_error("ROM archive is corrupted: CRC mismatch");
+
+		cache.store(rom_data);
+
+		const std::uint8_t* data = buffer.get();
+		return {std::shared_ptr<const std::uint8_t>(std::move(buffer), data), rom_entry.size};
+	}
+};
+
+class gzip_rom_parser : public compressed_rom_parser
+{
+public:
+	std::vector<std::string_view> supported_extentions() const override
+	{
+		return {".gz"};
+	}
+
+protected:
+	entry find_entry(std::span<const std::uint8_t> archive) const override
+	{
+		const std::size_t HEADER_SIZE = 10;
+		const std::size_t TRAILER_SIZE = 8;
+
+		if(archive.size() < HEADER_SIZE + TRAILER_SIZE || archive[0] != 0x1F || archive[1] != 0x8B)
+			throw std::runtime_error("ROM archive is corrupted: not a gzip file");
+
+		if(archive[2] != 8)
+			throw std::runtime_error("ROM archive: unsupported gzip compression method");
+
+		const std::uint8_t FHCRC = 1 << 1;
+		const std::uint8_t FEXTRA = 1 << 2;
+		const std::uint8_t FNAME = 1 << 3;
+		const std::uint8_t FCOMMENT = 1 << 4;
+
+		std::uint8_t flags = archive[3];
+		std::size_t offset = HEADER_SIZE;
+
+		if(flags & FEXTRA)
+			offset += 2 + read_little<std::uint16_t>(archive, offset);
+
+		auto skip_string = [&]() {
+			while(offset < archive.size() && archive[offset] != 0)
+				++offset;
+			++offset; // skip zero terminator
+		};
+
+		if(flags & FNAME)
+			skip_string();
+		if(flags & FCOMMENT)
+			skip_string();
+		if(flags & FHCRC)
+			offset += 2;
+
+		if(offset + TRAILER_SIZE > archive.size())
+			throw std::runtime_error("ROM archive is corrupted");
+
+		const std::size_t trailer = archive.size() - TRAILER_SIZE;
+		return {archive.subspan(offset, trailer - offset), method::deflate,
+				read_little<std::uint32_t>(archive, trailer + 4), read_little<std::uint32_t>(archive, trailer)};
+	}
+};
+
+class zip_rom_parser : public compressed_rom_parser
+{
+public:
+	zip_rom_parser(std::vector<std::string_view> rom_extentions) : m_rom_extentions(std::move(rom_extentions))
+	{
+	}
+
+	std::vector<std::string_view> supported_extentions() const override
+	{
+		return {".zip"};
+	}
+
+protected:
+	entry find_entry(std::span<const std::uint8_t> archive) const override
 	{
-		std::vector<std::uint8_t> rom;
-		// rom.reserve(rom::MAX_SIZE);
+		const std::uint32_t END_OF_CENTRAL_DIR_SIG = 0x06054B50;
+		const std::uint32_t CENTRAL_DIR_SIG = 0x02014B50;
+		const std::uint32_t LOCAL_HEADER_SIG = 0x04034B50;
+		const std::size_t END_OF_CENTRAL_DIR_SIZE = 22;
+		const std::size_t MAX_COMMENT_SIZE = 0xFFFF;
+
+		if(archive.size() < END_OF_CENTRAL_DIR_SIZE)
+			throw std::runtime_error("ROM archive is corrupted: not a zip file");
 
-		fs.clear();
-		fs.seekg(0);
-		for(char c; fs.get(c);)
+		// end of central directory record is followed by the variable length comment
+		std::size_t eocd = archive.size() - END_OF_CENTRAL_DIR_SIZE;
+		const std::size_t lowest_eocd = eocd > MAX_COMMENT_SIZE ? eocd - MAX_COMMENT_SIZE : 0;
+		while(read_little<std::uint32_t>(archive, eocd) != END_OF_CENTRAL_DIR_SIG)
 		{
-			rom.push_back(c);
-			if(rom.size() > rom::MAX_SIZE)
-				throw std::runtime_error("ROM is too big");
+			if(eocd == lowest_eocd)
+				throw std::runtime_error("ROM archive is corrupted: not a zip file");
+			--eocd;
 		}
 
-		const std::size_t MIN_ROM_SIZE = 0x200 + 1; // there should be at least 1 byte for body
-		if(rom.size() < MIN_ROM_SIZE)
-			throw std::runtime_error("ROM is too small");
+		const std::size_t num_entries = read_little<std::uint16_t>(archive, eocd + 10);
+		std::size_t offset = read_little<std::uint32_t>(archive, eocd + 16);
+
+		for(std::size_t i = 0; i < num_entries; ++i)
+		{
+			if(read_little<std::uint32_t>(archive, offset) != CENTRAL_DIR_SIG)
+				throw std::runtime_error("ROM archive is corrupted");
 
-		// TODO: do we need to pad ROM here?
-		// pad rom
-		// for(std::size_t i = rom.size(); i < rom::MAX_SIZE; ++i)
-		// 	rom.push_back(0);
+			const std::uint16_t flags = read_little<std::uint16_t>(archive, offset + 8);
+			const std::uint16_t compression = read_little<std::uint16_t>(archive, offset + 10);
+			const std::uint32_t crc = read_little<std::uint32_t>(archive, offset + 16);
+			const std::size_t compressed_size = read_little<std::uint32_t>(archive, offset + 20);
+			const std::size_t size = read_little<std::uint32_t>(archive, offset + 24);
+			const std::size_t name_size = read_little<std::uint16_t>(archive, offset + 28);
+			const std::size_t extra_size = read_little<std::uint16_t>(archive, offset + 30);
+			const std::size_t comment_size = read_little<std::uint16_t>(archive, offset + 32);
+			const std::size_t local_header = read_little<std::uint32_t>(archive, offset + 42);
 
-		rom.shrink_to_fit();
-		return rom;
+			if(offset + 46 + name_size > archive.size())
+				throw std::runtime_error("ROM archive is corrupted");
+			std::string_view name{reinterpret_cast<const char*>(archive.data() + offset + 46), name_size};
+
+			offset += 46 + name_size + extra_size + comment_size;
+
+			if(!is_rom_name(name))
+				continue;
+
+			if(flags & 1)
+				throw std::runtime_error("ROM archive: encrypted zip files are not supported");
+
+			if(compression != 0 && compression != 8)
+				throw std::runtime_error("ROM archive: unsupported zip compression method");
+
+			if(read_little<std::uint32_t>(archive, local_header) != LOCAL_HEADER_SIG)
+				throw std::runtime_error("ROM archive is corrupted");
+
+			std::size_t data_offset = local_header + 30 + read_little<std::uint16_t>(archive, local_header + 26) +
+									  read_little<std::uint16_t>(archive, local_header + 28);
+			if(data_offset + compressed_size > archive.size())
+				throw std::runtime_error("ROM archive is corrupted");
+
+			return {archive.subspan(data_offset, compressed_size), compression == 0 ? method::stored : method::deflate,
+					size, crc};
+		}
+
+		throw std::runtime_error("ROM archive doesn't contain any ROM file");
 	}
+
+private:
+	bool is_rom_name(std::string_view name) const
+	{
+		auto pos = name.find_last_of('.');
+		if(pos == std::string_view::npos || name.ends_with('/'))
+			return false;
+
+		std::string ext{name.substr(pos)};
+		std::ranges::transform(ext, ext.begin(), [](unsigned char c) { return std::tolower(c); });
+		return std::ranges::contains(m_rom_extentions, std::string_view{ext});
+	}
+
+private:
+	std::vector<std::string_view> m_rom_extentions;
 };
 
 const rom_parser* find_parser(std::string_view extention)
 {
-	static std::array<std::unique_ptr<rom_parser>, 1> registered_parsers{std::make_unique<bin_rom_parser>()};
+	static std::array<std::unique_ptr<rom_parser>, 3> registered_parsers{
+		std::make_unique<bin_rom_parser>(), std::make_unique<gzip_rom_parser>(),
+		std::make_unique<zip_rom_parser>(bin_rom_parser().supported_extentions())};
 
 	auto is_support_ext = [&](const auto& p) {
 		auto exts = p->supported_extentions();
@@ -85,13 +430,14 @@ rom::rom(std::string_view path_to_rom)
 		throw std::runtime_error("faild to parse ROM: extention '" + extention + "' is not supported");
 	}
 
-	std::ifstream fs(rom_path, std::ios_base::binary);
-	if(!fs.is_open())
+	if(!std::filesystem::is_regular_file(rom_path))
 	{
 		throw std::runtime_error("failed to open ROM file '" + rom_path.string() + "'");
 	}
 
-	m_rom_data = parser->read_raw_rom(fs);
+	auto raw = parser->read_raw_rom(rom_path);
+	m_rom_data = std::move(raw.data);
+	m_rom_size = raw.size;
 
 	setup_header();
 	setup_vectors();
@@ -99,7 +445,7 @@ rom::rom(std::string_view path_to_rom)
 
 std::uint16_t rom::checksum() const
 {
-	static auto calc_chksum = [this]() {
+	auto calc_chksum = [this]() {
 		auto _body = body();
 		std::size_t num_to_check = _body.size();
 		if(num_to_check > 0 && num_to_check % 2 != 0)
@@ -145,17 +491,17 @@ std::string_view read_string_view(std::span<const std::uint8_t> buffer, std::siz
 
 void rom::setup_header()
 {
-	m_header.system_type = read_string_view(m_rom_data, 0x100, 16);
-	m_header.copyright = read_string_view(m_rom_data, 0x110, 16);
-	m_header.game_name_domestic = read_string_view(m_rom_data, 0x120, 48);
-	m_header.game_name_overseas = read_string_view(m_rom_data, 0x150, 48);
-	m_header.region_support = read_string_view(m_rom_data, 0x1F0, 3);
-
-	m_header.rom_checksum = read_builtin_type<std::uint16_t>(m_rom_data, 0x18E);
-	m_header.rom_start_addr = read_builtin_type<std::uint32_t>(m_rom_data, 0x1A0);
-	m_header.rom_end_addr = read_builtin_type<std::uint32_t>(m_rom_data, 0x1A4);
-	m_header.ram_start_addr = read_builtin_type<std::uint32_t>(m_rom_data, 0x1A8);
-	m_header.ram_end_addr = read_builtin_type<std::uint32_t>(m_rom_data, 0x1AC);
+	m_header.system_type = read_string_view(data(), 0x100, 16);
+	m_header.copyright = read_string_view(data(), 0x110, 16);
+	m_header.game_name_domestic = read_string_view(data(), 0x120, 48);
+	m_header.game_name_overseas = read_string_view(data(), 0x150, 48);
+	m_header.region_support = read_string_view(data(), 0x1F0, 3);
+
+	m_header.rom_checksum = read_builtin_type<std::uint16_t>(data(), 0x18E);
+	m_header.rom_start_addr = read_builtin_type<std::uint32_t>(data(), 0x1A0);
+	m_header.rom_end_addr = read_builtin_type<std::uint32_t>(data(), 0x1A4);
+	m_header.ram_start_addr = read_builtin_type<std::uint32_t>(data(), 0x1A8);
+	m_header.ram_end_addr = read_builtin_type<std::uint32_t>(data(), 0x1AC);
 }
 
 void rom::setup_vectors()
@@ -163,7 +509,7 @@ void rom::setup_vectors()
 	int vec_num = 0;
 	std::generate(m_vectors.begin(), m_vectors.end(), [&]() {
 		int offset = vec_num++ * sizeof(std::uint32_t);
-		return read_builtin_type<std::uint32_t>(m_rom_data, offset);
+		return read_builtin_type<std::uint32_t>(data(), offset);
 	});
 }
 
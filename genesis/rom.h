@@ -3,10 +3,10 @@
 
 #include <array>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <span>
 #include <string_view>
-#include <vector>
 
 
 namespace genesis
@@ -44,13 +44,14 @@ public:
 
 	std::span<const std::uint8_t> data() const
 	{
-		return {m_rom_data.begin(), m_rom_data.size()};
+		return {m_rom_data.get(), m_rom_size};
 	}
 
-	// NOTE: rom class is supposed to be immutable, but keep this method for now
-	std::span<std::uint8_t> data()
+	// Keeps ROM storage alive, so it could be used without copying (i.e. by memory units).
+	// Storage is zero-padded up to the even size, so the last word could always be read.
+	std::shared_ptr<const std::uint8_t> shared_data() const
 	{
-		return {m_rom_data.begin(), m_rom_data.size()};
+		return m_rom_data;
 	}
 
 	const header_data& header() const
@@ -67,10 +68,10 @@ public:
 	{
 		const std::size_t BODY_OFFSET = MIN_SIZE - 1;
 
-		if(m_rom_data.size() <= BODY_OFFSET)
+		if(m_rom_size <= BODY_OFFSET)
 			return {}; // no body
 
-		return {m_rom_data.begin() + BODY_OFFSET, m_rom_data.size() - BODY_OFFSET};
+		return data().subspan(BODY_OFFSET);
 	}
 
 	std::uint16_t checksum() const;
@@ -80,7 +81,8 @@ private:
 	void setup_vectors();
 
 private:
-	std::vector<std::uint8_t> m_rom_data;
+	std::shared_ptr<const std::uint8_t> m_rom_data;
+	std::size_t m_rom_size = 0;
 	mutable std::optional<std::uint16_t> m_checksum;
 
 	header_data m_header;
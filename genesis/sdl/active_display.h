@@ -0,0 +1,91 @@
+#ifndef __GENESIS_SDL_ACTIVE_DISPLAY_H__
+#define __GENESIS_SDL_ACTIVE_DISPLAY_H__
+
+#include "base_display.h"
+#include "vdp/framebuffer.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+
+namespace genesis::sdl
+{
+
+// Displays the last completed VDP frame, the framebuffer is uploaded to the texture as is.
+// The display is the framebuffer consumer, so it must be updated by a single thread
+class active_display : public base_display
+{
+public:
+	active_display(std::string_view title, vdp::framebuffer& framebuffer)
+		: base_display(title, vdp::framebuffer::max_width, vdp::framebuffer::max_height), framebuffer(framebuffer)
+	{
+		m_renderer = SDL_CreateRenderer(m_window, -1, 0);
+		if(m_renderer == nullptr)
+			throw std::runtime_error("Cannot create renderer: " + std::string(SDL_GetError()));
+	}
+
+	~active_display()
+	{
+		if(m_texture != nullptr)
+			SDL_DestroyTexture(m_texture);
+		SDL_DestroyRenderer(m_renderer);
+	}
+
+	void update() override
+	{
+		if(m_window == nullptr)
+		{
+			// window was destroyed, nothing to do
+			return;
+		}
+
+		auto frame = framebuffer.front();
+		if(frame.width == 0 || frame.height == 0)
+			return;
+
+		if(frame.width != m_width || frame.height != m_height || frame.format != m_format || m_texture == nullptr)
+		{
+			m_width = frame.width;
+			m_height = frame.height;
+			m_format = frame.format;
+
+			if(m_texture != nullptr)
+				SDL_DestroyTexture(m_texture);
+			const int width = static_cast<int>(m_width);
+			const int height = static_cast<int>(m_height);
+			m_texture =
+				SDL_CreateTexture(m_renderer, sdl_format(m_format), SDL_TEXTUREACCESS_STREAMING, width, height);
+
+			SDL_SetWindowSize(m_window, width, height);
+		}
+
+		SDL_UpdateTexture(m_texture, nullptr, frame.pixels, static_cast<int>(frame.pitch));
+		SDL_RenderClear(m_renderer);
+		SDL_RenderCopy(m_renderer, m_texture, nullptr, nullptr);
+		SDL_RenderPresent(m_renderer);
+	}
+
+private:
+	static std::uint32_t sdl_format(vdp::pixel_format format)
+	{
+		if(format == vdp::pixel_format::rgb565)
+			return SDL_PIXELFORMAT_RGB565;
+		return SDL_PIXELFORMAT_ARGB8888;
+	}
+
+private:
+	vdp::framebuffer& framebuffer;
+
+	SDL_Renderer* m_renderer = nullptr;
+	SDL_Texture* m_texture = nullptr;
+
+	unsigned m_width = 0;
+	unsigned m_height = 0;
+	vdp::pixel_format m_format = vdp::pixel_format::argb8888;
+};
+
+} // namespace genesis::sdl
+
+#endif // __GENESIS_SDL_ACTIVE_DISPLAY_H__
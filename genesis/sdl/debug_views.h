@@ -0,0 +1,231 @@
+#ifndef __GENESIS_SDL_DEBUG_VIEWS_H__
+#define __GENESIS_SDL_DEBUG_VIEWS_H__
+
+#include "displayable.h"
+#include "palette_display.h"
+#include "plane_display.h"
+#include "vdp/vdp.h"
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+
+
+namespace genesis::sdl
+{
+
+/* Debug windows showing VDP internals (planes, sprites, palette).
+ * Views are created only when they are opened (by a hot key or at startup) and destroyed once closed,
+ * open views are redrawn not more often than the configured refresh rate.
+ * Views read VDP state directly, so update() must not race with emulation. */
+class debug_views
+{
+public:
+	enum class view
+	{
+		plane_a,
+		plane_b,
+		sprites,
+		palette,
+	};
+
+	static constexpr std::array all_views = {view::plane_a, view::plane_b, view::sprites, view::palette};
+
+	using clock = std::chrono::steady_clock;
+
+public:
+	// refresh_rate - how many times per second open views are redrawn
+	debug_views(vdp::vdp& vdp, unsigned refresh_rate = 10) : m_vdp(vdp)
+	{
+		if(refresh_rate == 0)
+			throw std::invalid_argument("refresh_rate");
+
+		m_refresh_period = std::chrono::duration_cast<clock::duration>(std::chrono::seconds(1)) / refresh_rate;
+	}
+
+	static SDL_Keycode hot_key(view v)
+	{
+		switch(v)
+		{
+		case view::plane_a:
+			return SDLK_F1;
+		case view::plane_b:
+			return SDLK_F2;
+		case view::sprites:
+			return SDLK_F3;
+		case view::palette:
+			return SDLK_F4;
+		default:
+			throw internal_error();
+		}
+	}
+
+	static std::string_view name(view v)
+	{
+		switch(v)
+		{
+		case view::plane_a:
+			return "plane a";
+		case view::plane_b:
+			return "plane b";
+		case view::sprites:
+			return "sprites";
+		case view::palette:
+			return "palette";
+		default:
+			throw internal_error();
+		}
+	}
+
+	// as the view reads VDP state to find out its dimension, it must not race with emulation
+	void open(view v)
+	{
+		auto& disp = m_views[index(v)];
+		if(disp == nullptr)
+		{
+			disp = create(v);
+			m_next_refresh = clock::now();
+		}
+	}
+
+	void close(view v)
+	{
+		m_views[index(v)].reset();
+	}
+
+	bool is_open(view v) const
+	{
+		return m_views[index(v)] != nullptr;
+	}
+
+	bool any_open() const
+	{
+		for(const auto& disp : m_views)
+		{
+			if(disp != nullptr)
+				return true;
+		}
+		return false;
+	}
+
+	// hot keys request to toggle views, the request is applied by the next update()
+	void handle_event(const SDL_Event& event)
+	{
+		if(event.type == SDL_KEYDOWN && event.key.repeat == 0)
+		{
+			for(auto v : all_views)
+			{
+				if(event.key.keysym.sym == hot_key(v))
+					m_toggle_requested[index(v)] = !m_toggle_requested[index(v)];
+			}
+		}
+
+		for(auto& disp : m_views)
+		{
+			if(disp == nullptr)
+				continue;
+
+			disp->handle_event(event);
+			if(disp->is_closed())
+				disp.reset();
+		}
+	}
+
+	// true if there are pending toggles or open views have to be redrawn
+	bool update_required(clock::time_point now) const
+	{
+		for(bool toggle : m_toggle_requested)
+		{
+			if(toggle)
+				return true;
+		}
+
+		return any_open() && now >= m_next_refresh;
+	}
+
+	// apply pending toggles and redraw open views, must not race with emulation
+	void update(clock::time_point now)
+	{
+		for(auto v : all_views)
+		{
+			if(!m_toggle_requested[index(v)])
+				continue;
+
+			m_toggle_requested[index(v)] = false;
+			if(is_open(v))
+				close(v);
+			else
+				open(v);
+		}
+
+		if(!any_open() || now < m_next_refresh)
+			return;
+
+		for(auto& disp : m_views)
+		{
+			if(disp != nullptr)
+				disp->update();
+		}
+
+		m_next_refresh = now + m_refresh_period;
+	}
+
+private:
+	static std::size_t index(view v)
+	{
+		return static_cast<std::size_t>(v);
+	}
+
+	std::unique_ptr<displayable> create(view v)
+	{
+		using vdp::impl::plane_type;
+
+		auto& render = m_vdp.render();
+		auto plane = [&render](std::string_view title, plane_type type) {
+			return std::make_unique<plane_display>(
+				title, [&render, type]() { return render.plane_width_in_pixels(type); },
+				[&render, type]() { return render.plane_height_in_pixels(type); },
+				[&render, type](unsigned row_number, plane_display::row_buffer buffer) {
+					return render.get_plane_row(type, row_number, buffer);
+				});
+		};
+
+		switch(v)
+		{
+		case view::plane_a:
+			return plane(name(v), plane_type::a);
+
+		case view::plane_b:
+			return plane(name(v), plane_type::b);
+
+		case view::sprites:
+			return std::make_unique<plane_display>(
+				name(v), [&render]() { return render.sprite_width_in_pixels(); },
+				[&render]() { return render.sprite_height_in_pixels(); },
+				[&render](unsigned row_number, plane_display::row_buffer buffer) {
+					return render.get_sprite_row(row_number, buffer);
+				});
+
+		case view::palette:
+			return std::make_unique<palette_display>(m_vdp.cram());
+
+		default:
+			throw internal_error();
+		}
+	}
+
+private:
+	vdp::vdp& m_vdp;
+
+	std::array<std::unique_ptr<displayable>, all_views.size()> m_views;
+	std::array<bool, all_views.size()> m_toggle_requested{};
+
+	clock::duration m_refresh_period;
+	clock::time_point m_next_refresh;
+};
+
+} // namespace genesis::sdl
+
+#endif // __GENESIS_SDL_DEBUG_VIEWS_H__
@@ -2,6 +2,7 @@
 #define __SDL_INPUT_DEVICE_H__
 
 #include <array>
+#include <atomic>
 #include <map>
 #include <type_traits>
 
@@ -22,18 +23,20 @@ static const std::map<int /* SDLK */, io_ports::key_type> default_key_layout = {
 	{SDLK_k, io_ports::key_type::A},	   {SDLK_l, io_ports::key_type::B},	   {SDLK_SPACE, io_ports::key_type::C},
 };
 
+// Keys are updated by the front-end thread and read by the emulation thread
 class input_device : public io_ports::input_device
 {
 public:
 	input_device(std::map<int /* SDLK */, io_ports::key_type> key_layout = default_key_layout) : key_layout(key_layout)
 	{
-		key_pressed.fill(false);
+		for(auto& pressed : key_pressed)
+			pressed.store(false, std::memory_order_relaxed);
 	}
 
 	bool is_key_pressed(io_ports::key_type key) override
 	{
 		auto key_number = io_ports::key_type_index(key);
-		return key_pressed.at(key_number);
+		return key_pressed.at(key_number).load(std::memory_order_relaxed);
 	};
 
 	void handle_event(const SDL_Event& event)
@@ -48,7 +51,7 @@ public:
 			if(key_layout.contains(key))
 			{
 				auto key_idx = io_ports::key_type_index(key_layout[key]);
-				key_pressed.at(key_idx) = pressed;
+				key_pressed.at(key_idx).store(pressed, std::memory_order_relaxed);
 			}
 		}
 		}
@@ -56,7 +59,7 @@ public:
 
 private:
 	std::map<int /* SDLK */, io_ports::key_type> key_layout;
-	std::array<bool, io_ports::key_type_count> key_pressed;
+	std::array<std::atomic<bool>, io_ports::key_type_count> key_pressed;
 };
 
 } // namespace genesis::sdl
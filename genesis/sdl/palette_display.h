@@ -16,6 +16,18 @@ public:
 	{
 	}
 
+	void handle_event(const SDL_Event& event) override
+	{
+		// window content may be lost, so it has to be redrawn even if colors are the same
+		if(event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_EXPOSED &&
+		   event.window.windowID == SDL_GetWindowID(m_window))
+		{
+			m_generation = 0;
+		}
+
+		base_display::handle_event(event);
+	}
+
 	void update() override
 	{
 		if(m_window == nullptr)
@@ -24,6 +36,11 @@ public:
 			return;
 		}
 
+		// redraw only if any color was written since the last update
+		if(cram.generation() == m_generation)
+			return;
+		m_generation = cram.generation();
+
 		auto* screenSurface = SDL_GetWindowSurface(m_window);
 		SDL_FillRect(screenSurface, NULL, SDL_MapRGB(screenSurface->format, 0xFF, 0xFF, 0xFF));
 
@@ -48,6 +65,7 @@ public:
 
 private:
 	vdp::cram_t& cram;
+	std::uint64_t m_generation = 0;
 };
 
 } // namespace genesis::sdl
@@ -4,6 +4,7 @@
 #include "base_display.h"
 #include "time_utils.h"
 #include "vdp/output_color.h"
+#include "vdp/pixel_format.h"
 
 #include <array>
 #include <cstdint>
@@ -101,15 +102,9 @@ public:
 			for(int row_number = 0; row_number < m_height; ++row_number)
 			{
 				auto row = m_get_row(row_number, buffer);
+				// rows are never wider than the buffer, so all rows fit the pixels
 				for(auto color : row)
-				{
-					// TODO: use alpha
-					std::uint32_t pix = 0x0;
-					pix |= color.red << 21;
-					pix |= color.green << 13;
-					pix |= color.blue << 5;
-					pixels.at(pixel_pos++) = pix;
-				}
+					pixels[pixel_pos++] = vdp::to_argb8888(color);
 			}
 		});
 
@@ -2,6 +2,7 @@
 #define __SMD_IMPL_M68K_BUS_ACCESS__
 
 #include "m68k/bus_access.h"
+#include "memory/addressable.h"
 #include "vdp/m68k_bus_access.h"
 
 namespace genesis::impl
@@ -14,6 +15,13 @@ public:
 	{
 	}
 
+	// m68k_memory is the M68K memory map, clock_divider is the number of VDP cycles per M68K cycle
+	m68k_bus_access_impl(genesis::m68k::bus_access& bus_access, genesis::memory::addressable& m68k_memory,
+						 std::uint32_t clock_divider)
+		: bus_access(bus_access), m68k_memory(&m68k_memory), clock_divider(clock_divider)
+	{
+	}
+
 	void request_bus() override
 	{
 		bus_access.request_bus();
@@ -43,8 +51,37 @@ public:
 		return bus_access.is_idle();
 	}
 
+	std::uint32_t word_read_cycles() const override
+	{
+		if(m68k_memory == nullptr)
+			return 0;
+
+		// the read is initiated right after M68K cycle, so it takes the whole bus cycle
+		return read_bus_cycle_clocks * clock_divider;
+	}
+
+	std::optional<std::uint16_t> read_word_direct(std::uint32_t address) override
+	{
+		if(m68k_memory == nullptr)
+			return std::nullopt;
+
+		// address bus is 24 bits only
+		address &= 0xFFFFFF;
+
+		auto region = m68k_memory->direct_access(address);
+		if(!region.has_value() || !region->contains(address, address + 1))
+			return std::nullopt;
+
+		return region->read<std::uint16_t>(address);
+	}
+
 private:
+	// read bus cycle without wait states
+	static constexpr std::uint32_t read_bus_cycle_clocks = 4;
+
 	genesis::m68k::bus_access& bus_access;
+	genesis::memory::addressable* m68k_memory = nullptr;
+	std::uint32_t clock_divider = 0;
 };
 
 } // namespace genesis::impl
@@ -6,6 +6,7 @@
 #include "memory/memory_unit.h"
 #include "string_utils.hpp"
 
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
@@ -61,6 +62,9 @@ public:
 		m_bank_register = (m_bank_register >> 1) | (data << 8);
 
 		// std::cout << "Updating bank register: " << su::bin_str(m_bank_register) << ", data: " << (int)data << '\n';
+
+		if(on_bank_change_callback)
+			on_bank_change_callback();
 	}
 
 	std::uint32_t bank_value() const
@@ -68,8 +72,14 @@ public:
 		return m_bank_register;
 	}
 
+	void on_bank_change(std::function<void()> callback)
+	{
+		on_bank_change_callback = callback;
+	}
+
 private:
 	std::uint32_t m_bank_register = 0;
+	std::function<void()> on_bank_change_callback;
 };
 
 class bank_area : public memory::addressable
@@ -78,6 +88,13 @@ public:
 	bank_area(std::shared_ptr<bank_register> bank_register, std::shared_ptr<memory::addressable> m68k_area)
 		: m_bank_register(bank_register), m_memory(m68k_area)
 	{
+		update_bank();
+		m_bank_register->on_bank_change([this]() { update_bank(); });
+	}
+
+	~bank_area()
+	{
+		m_bank_register->on_bank_change(nullptr);
 	}
 
 	std::uint32_t max_address() const override
@@ -103,16 +120,28 @@ public:
 
 	void init_read_byte(std::uint32_t address) override
 	{
+		// fast path: the selected bank is plain memory (ROM)
+		m_latched_directly = m_bank_data != nullptr;
+		if(m_latched_directly)
+		{
+			m_latched_byte = m_bank_data[address & bank_mask];
+			return;
+		}
+
 		m_memory->init_read_byte(fix_address(address));
 	}
 
 	void init_read_word(std::uint32_t address) override
 	{
+		m_latched_directly = false;
 		m_memory->init_read_word(fix_address(address));
 	}
 
 	std::uint8_t latched_byte() const override
 	{
+		if(m_latched_directly)
+			return m_latched_byte;
+
 		try
 		{
 			return m_memory->latched_byte();
@@ -135,12 +164,27 @@ public:
 		}
 	}
 
+	// NOTE: direct_access is not exposed on purpose, the selected bank changes at runtime
+
 private:
+	// cache host memory of the selected bank, so reads don't go through the 68k memory map
+	void update_bank()
+	{
+		m_bank_data = nullptr;
+
+		const std::uint32_t first = m_bank_register->bank_value() << 15;
+		const std::uint32_t last = first + bank_mask;
+
+		auto region = m_memory->direct_access(first);
+		if(region.has_value() && region->contains(first, last))
+			m_bank_data = region->data + (first - region->first_address);
+	}
+
 	std::uint32_t fix_address(std::uint32_t address)
 	{
 		std::uint32_t bank_reg = m_bank_register->bank_value();
 
-		address = (bank_reg << 15) | (address & 0x7fff);
+		address = (bank_reg << 15) | (address & bank_mask);
 
 		if(address > 0x3FFFFF)
 			throw not_implemented("z80 bank area: only ROM is supported for now (address: " + su::hex_str(address) +
@@ -150,8 +194,16 @@ private:
 	}
 
 private:
+	static constexpr std::uint32_t bank_mask = 0x7FFF;
+
 	std::shared_ptr<bank_register> m_bank_register;
 	std::shared_ptr<memory::addressable> m_memory;
+
+	// host memory of the whole selected bank, nullptr if it has to be accessed via m_memory
+	const std::uint8_t* m_bank_data = nullptr;
+
+	bool m_latched_directly = false;
+	std::uint8_t m_latched_byte = 0;
 };
 
 class z80_68bank
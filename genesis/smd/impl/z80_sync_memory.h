@@ -0,0 +1,76 @@
+#ifndef __SMD_IMPL_Z80_SYNC_MEMORY_H__
+#define __SMD_IMPL_Z80_SYNC_MEMORY_H__
+
+#include "memory/addressable.h"
+
+#include <functional>
+#include <memory>
+
+namespace genesis::impl
+{
+
+/* M68K view of the state shared with Z80 (Z80 memory and control registers).
+ * Z80 runs behind M68K, so every access first lets it catch up to the access time.
+ * Direct access is not provided on purpose, otherwise the access would skip the sync. */
+class z80_sync_memory : public memory::addressable
+{
+public:
+	using sync_callback = std::function<void()>;
+
+	z80_sync_memory(std::shared_ptr<memory::addressable> unit, sync_callback sync)
+		: m_unit(std::move(unit)), m_sync(std::move(sync))
+	{
+	}
+
+	std::uint32_t max_address() const override
+	{
+		return m_unit->max_address();
+	}
+
+	bool is_idle() const override
+	{
+		return m_unit->is_idle();
+	}
+
+	void init_write(std::uint32_t address, std::uint8_t data) override
+	{
+		m_sync();
+		m_unit->init_write(address, data);
+	}
+
+	void init_write(std::uint32_t address, std::uint16_t data) override
+	{
+		m_sync();
+		m_unit->init_write(address, data);
+	}
+
+	void init_read_byte(std::uint32_t address) override
+	{
+		m_sync();
+		m_unit->init_read_byte(address);
+	}
+
+	void init_read_word(std::uint32_t address) override
+	{
+		m_sync();
+		m_unit->init_read_word(address);
+	}
+
+	std::uint8_t latched_byte() const override
+	{
+		return m_unit->latched_byte();
+	}
+
+	std::uint16_t latched_word() const override
+	{
+		return m_unit->latched_word();
+	}
+
+private:
+	std::shared_ptr<memory::addressable> m_unit;
+	sync_callback m_sync;
+};
+
+} // namespace genesis::impl
+
+#endif // __SMD_IMPL_Z80_SYNC_MEMORY_H__
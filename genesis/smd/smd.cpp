@@ -4,6 +4,7 @@
 #include "impl/m68k_interrupt_access.h"
 #include "impl/z80_68bank.h"
 #include "impl/z80_io_ports.h"
+#include "impl/z80_sync_memory.h"
 #include "io_ports/controller.h"
 #include "io_ports/disabled_port.h"
 #include "memory/dummy_memory.h"
@@ -11,12 +12,28 @@
 #include "memory/memory_builder.h"
 #include "memory/memory_unit.h"
 #include "memory/read_only_memory_unit.h"
+#include "memory/rom_memory_unit.h"
+
+#include <algorithm>
 
 
 namespace genesis
 {
 
-smd::smd(const genesis::rom& rom, std::shared_ptr<io_ports::input_device> input_dev1) : m_input_dev1(input_dev1)
+// M68K is clocked at MCLK / 7
+static const std::uint64_t m68k_clock_divider = 7;
+
+// Z80 is clocked at MCLK / 15
+static const std::uint64_t z80_clock_divider = 15;
+
+// split only every N-th run_until call between devices while profiling
+static const std::uint64_t profile_sample_rate = 16;
+
+// run_frame advances the timeline by at most 1 scanline at a time
+static const std::uint64_t mclk_per_scanline = 3420;
+
+smd::smd(const genesis::rom& rom, std::shared_ptr<io_ports::input_device> input_dev1, m68k_mode mode)
+	: m_m68k_mode(mode), m_input_dev1(input_dev1)
 {
 	m_vdp = std::make_unique<vdp::vdp>();
 
@@ -33,46 +50,217 @@ smd::smd(const genesis::rom& rom, std::shared_ptr<io_ports::input_device> input_
 	m_vdp->set_m68k_interrupt_access(m68k_int_access);
 
 	// TODO: it does not make much sense to have a shared_pointer to an object containing a reference
-	auto m68k_bus_access = std::make_shared<impl::m68k_bus_access_impl>(m_m68k_cpu->bus_access());
+	auto m68k_bus_access = std::make_shared<impl::m68k_bus_access_impl>(
+		m_m68k_cpu->bus_access(), *m_m68k_mem_map, static_cast<std::uint32_t>(m68k_clock_divider));
 	m_vdp->set_m68k_bus_access(m68k_bus_access);
+
+	m_m68k_next_due = m68k_clock_divider;
+	m_z80_next_due = z80_clock_divider;
 }
 
-void smd::cycle()
+void smd::run_until(std::uint64_t mclk)
 {
-	// NOTE: preliminary implementation
-	++cycles;
+	if(!m_profiling)
+	{
+		m_profile_mode = profile_mode::none;
+		run_until_impl<profile_mode::none>(mclk);
+		return;
+	}
 
-	// TODO: temporary use random numbers
-	if(cycles % 8 == 0)
-		m_m68k_cpu->cycle();
+	// A time stamp costs about as much as a single device call, so timing every call would distort the profile.
+	// Instead the slice is timed as a whole and only every N-th slice is split between devices.
+	auto start = std::chrono::steady_clock::now();
+	if(m_profile.slices++ % profile_sample_rate == 0)
+	{
+		m_last_stamp = start;
+		m_profile_mode = profile_mode::time_calls;
+		run_until_impl<profile_mode::time_calls>(mclk);
+
+		// the last device call took the last time stamp, so device times add up to the slice time
+		m_profile.sampled_time += m_last_stamp - start;
+		m_profile.total_time += m_last_stamp - start;
+	}
+	else
+	{
+		m_profile_mode = profile_mode::count_calls;
+		run_until_impl<profile_mode::count_calls>(mclk);
+		m_profile.total_time += std::chrono::steady_clock::now() - start;
+	}
+}
 
-	if(cycles % 64 == 0)
-		z80_cycle();
+void smd::enable_profiling(bool enable)
+{
+	m_profiling = enable;
+	if(!m_profiling)
+		return;
 
-	m_vdp->cycle();
+	// measure the cost of taking time stamps the same way as device calls take them
+	const int samples = 1000;
+	auto start = std::chrono::steady_clock::now();
+	auto last = start;
+	std::chrono::nanoseconds total{0};
+	for(int i = 0; i < samples; ++i)
+	{
+		auto now = std::chrono::steady_clock::now();
+		total += now - last;
+		last = now;
+	}
+
+	m_profile.timer_overhead = total / samples;
+}
+
+std::chrono::nanoseconds smd::profile::time(const device_profile& dev) const
+{
+	auto own_time = [this](const device_profile& prof) {
+		auto overhead = timer_overhead * static_cast<std::int64_t>(prof.sampled_calls);
+		return std::max(std::chrono::nanoseconds{0}, prof.sampled_time - overhead);
+	};
+
+	// sampled slices without time stamps
+	const auto num_stamps = static_cast<std::int64_t>(m68k.sampled_calls + z80.sampled_calls + vdp.sampled_calls);
+	const auto sampled = std::max(sampled_time - timer_overhead * num_stamps, own_time(m68k) + own_time(z80) + own_time(vdp));
+	if(sampled.count() <= 0)
+		return std::chrono::nanoseconds{0};
+
+	// device share in sampled slices applies to all slices
+	const auto total = total_time - sampled_time + sampled;
+	return std::chrono::nanoseconds(
+		static_cast<std::int64_t>(double(own_time(dev).count()) * double(total.count()) / double(sampled.count())));
+}
+
+template <smd::profile_mode Mode, class Callable>
+void smd::run_device(device_profile& prof, Callable&& func)
+{
+	if constexpr(Mode != profile_mode::none)
+		++prof.calls;
+
+	func();
+
+	if constexpr(Mode == profile_mode::time_calls)
+	{
+		// everything since the previous time stamp is charged to the device
+		auto now = std::chrono::steady_clock::now();
+		prof.sampled_time += now - m_last_stamp;
+		++prof.sampled_calls;
+		m_last_stamp = now;
+	}
 }
 
-void smd::z80_cycle()
+template <smd::profile_mode Mode>
+void smd::run_until_impl(std::uint64_t mclk)
+{
+	while(m_mclk < mclk)
+	{
+		// Z80 is not scheduled here, it runs behind M68K and catches up on demand (see z80_sync)
+		std::uint64_t next_event = std::min(m_m68k_next_due, mclk);
+
+		// The VDP interacts with the CPUs only on CPU cycles (ports access, DMA, interrupts),
+		// so run it in a single batch up to the cycle right before the next CPU event.
+		// Within one master cycle devices are executed in the following order: m68k -> z80 -> vdp.
+		if(next_event > m_vdp_mclk + 1)
+		{
+			auto cycles = static_cast<std::uint32_t>(next_event - m_vdp_mclk - 1);
+			run_device<Mode>(m_profile.vdp, [this, cycles]() { m_vdp->run(cycles); });
+			m_vdp_mclk = next_event - 1;
+		}
+
+		m_mclk = next_event;
+
+		if(m_mclk == m_m68k_next_due)
+		{
+			if(m_m68k_mode == m68k_mode::instruction_level)
+			{
+				std::uint32_t cycles = 0;
+				run_device<Mode>(m_profile.m68k, [this, &cycles]() { cycles = m_m68k_cpu->execute_one(); });
+				m_m68k_next_due += cycles * m68k_clock_divider;
+			}
+			else
+			{
+				run_device<Mode>(m_profile.m68k, [this]() { m_m68k_cpu->cycle(); });
+				m_m68k_next_due += m68k_clock_divider;
+			}
+		}
+	}
+
+	// catch up the VDP and Z80, so all devices are at the same point of the timeline
+	if(m_vdp_mclk < m_mclk)
+	{
+		auto cycles = static_cast<std::uint32_t>(m_mclk - m_vdp_mclk);
+		run_device<Mode>(m_profile.vdp, [this, cycles]() { m_vdp->run(cycles); });
+		m_vdp_mclk = m_mclk;
+	}
+
+	z80_catch_up<Mode>(m_mclk);
+}
+
+template <smd::profile_mode Mode>
+void smd::z80_catch_up(std::uint64_t mclk)
+{
+	// limit a single batch only to keep the budget in range
+	const std::uint64_t max_batch = 0x10000;
+
+	while(m_z80_next_due <= mclk)
+	{
+		// Z80 cycles due up to the specified master cycle (inclusive)
+		const auto budget =
+			static_cast<std::uint32_t>(std::min((mclk - m_z80_next_due) / z80_clock_divider + 1, max_batch));
+
+		std::uint32_t cycles = 0;
+		run_device<Mode>(m_profile.z80, [this, budget, &cycles]() { cycles = z80_run(budget); });
+		m_z80_next_due += cycles * z80_clock_divider;
+	}
+}
+
+void smd::z80_sync()
+{
+	// Within one master cycle M68K is executed first, so its access sees only the Z80 cycles before it
+	const std::uint64_t mclk = m_mclk - 1;
+
+	switch(m_profile_mode)
+	{
+	case profile_mode::none:
+		z80_catch_up<profile_mode::none>(mclk);
+		break;
+
+	case profile_mode::count_calls:
+		z80_catch_up<profile_mode::count_calls>(mclk);
+		break;
+
+	case profile_mode::time_calls:
+		z80_catch_up<profile_mode::time_calls>(mclk);
+		break;
+	}
+}
+
+void smd::run_frame()
+{
+	const auto frame = m_vdp->frame_count();
+	while(frame == m_vdp->frame_count())
+		run_until(m_mclk + mclk_per_scanline);
+}
+
+std::uint32_t smd::z80_run(std::uint32_t cycle_budget)
 {
 	m_z80_ctrl_registers.cycle();
 
+	// Z80 stays in reset or stopped for the whole budget (registers can be changed only by M68K)
 	if(m_z80_ctrl_registers.z80_reset_requested())
 	{
 		m_z80_cpu->reset();
-		return;
+		return cycle_budget;
 	}
 
 	if(m_z80_ctrl_registers.z80_bus_granted())
 	{
-		return;
+		return cycle_budget;
 	}
 
-	m_z80_cpu->execute_one();
+	return cycle_budget + m_z80_cpu->execute(cycle_budget);
 }
 
 void smd::build_cpu_memory_map(const genesis::rom& rom)
 {
-	auto rom_data = load_rom(rom);
+	auto rom_area = build_rom_area(rom);
 
 	/* Build z80 memory map */
 	memory::memory_builder z80_builder;
@@ -95,7 +283,7 @@ void smd::build_cpu_memory_map(const genesis::rom& rom)
 
 
 	// TODO: only rom is accessible for now
-	impl::z80_68bank z80_bank(std::make_shared<memory::memory_unit>(rom_data, std::endian::big));
+	impl::z80_68bank z80_bank(rom_area);
 	z80_builder.add(z80_bank.bank_register(), 0x6000, 0x6000);
 	z80_builder.add(z80_bank.bank_area(), 0x8000, 0xFFFF);
 
@@ -110,8 +298,9 @@ void smd::build_cpu_memory_map(const genesis::rom& rom)
 	// Setup version register based on the loaded rom
 	m68k_builder.add_unique(build_version_register(rom), 0xA10000, 0xA10001);
 
-	m68k_builder.add_unique(std::make_unique<memory::memory_unit>(rom_data, std::endian::big), 0x0, 0x3FFFFF);
-	m68k_builder.add(m_z80_mem_map, 0xA00000, 0xA0FFFF);
+	// map ROM and padding as separate devices, so ROM keeps direct access
+	add_rom(m68k_builder, rom);
+	m68k_builder.add(z80_synced(m_z80_mem_map), 0xA00000, 0xA0FFFF);
 
 	// M68K RAM, mirrored every $FFFF
 	const std::uint32_t M68K_RAM_START = 0xE00000;
@@ -162,12 +351,17 @@ void smd::build_cpu_memory_map(const genesis::rom& rom)
 	m68k_builder.add_unique(std::make_unique<memory::zero_memory_unit>(0x11, std::endian::big), 0xA1000E, 0xA1001F);
 
 	/* Z80 control registers */
-	m68k_builder.add(m_z80_ctrl_registers.z80_bus_request_register(), 0xA11100, 0xA11101);
-	m68k_builder.add(m_z80_ctrl_registers.z80_reset_register(), 0xA11200, 0xA11201);
+	m68k_builder.add(z80_synced(m_z80_ctrl_registers.z80_bus_request_register()), 0xA11100, 0xA11101);
+	m68k_builder.add(z80_synced(m_z80_ctrl_registers.z80_reset_register()), 0xA11200, 0xA11201);
 
 	m_m68k_mem_map = m68k_builder.build();
 }
 
+std::shared_ptr<memory::addressable> smd::z80_synced(std::shared_ptr<memory::addressable> unit)
+{
+	return std::make_shared<impl::z80_sync_memory>(std::move(unit), [this]() { z80_sync(); });
+}
+
 std::unique_ptr<memory::addressable> smd::build_version_register(const genesis::rom& rom)
 {
 	auto supports = [&rom](char region_type) { return rom.header().region_support.contains(region_type); };
@@ -194,24 +388,29 @@ std::unique_ptr<memory::addressable> smd::build_version_register(const genesis::
 	return version_register;
 }
 
-std::shared_ptr<std::vector<std::uint8_t>> smd::load_rom(const genesis::rom& rom)
+void smd::add_rom(memory::memory_builder& builder, const genesis::rom& rom)
 {
-	const std::uint32_t ROM_SIZE = 0x400000;
+	const std::uint32_t ROM_END = 0x3FFFFF;
 
-	if(rom.data().size() > ROM_SIZE)
+	if(rom.data().size() > ROM_END + 1)
 		throw std::runtime_error("The ROM cannot be loaded due to its size being too large");
 
-	auto rom_data = std::make_shared<std::vector<std::uint8_t>>();
-	rom_data->reserve(ROM_SIZE);
-
-	for(auto val : rom.data())
-		rom_data->push_back(val);
+	// ROM data is shared as is, the storage is readable up to the even size
+	std::uint32_t rom_size = (rom.data().size() + 1) & ~1u;
+	builder.add(std::make_shared<memory::rom_memory_unit>(rom.shared_data(), rom_size, std::endian::big), 0x0,
+				rom_size - 1);
 
-	// pad ROM
-	for(std::size_t i = rom_data->size(); i < ROM_SIZE; ++i)
-		rom_data->push_back(0);
+	// the rest of ROM area is padded virtually
+	if(rom_size <= ROM_END)
+		builder.add_unique(std::make_unique<memory::zero_memory_unit>(ROM_END - rom_size, std::endian::big), rom_size,
+						   ROM_END);
+}
 
-	return rom_data;
+std::shared_ptr<memory::addressable> smd::build_rom_area(const genesis::rom& rom)
+{
+	memory::memory_builder builder;
+	add_rom(builder, rom);
+	return builder.build();
 }
 
 } // namespace genesis
@@ -5,10 +5,12 @@
 #include "io_ports/input_device.h"
 #include "m68k/cpu.h"
 #include "memory/addressable.h"
+#include "memory/memory_builder.h"
 #include "rom.h"
 #include "vdp/vdp.h"
 #include "z80/cpu.h"
 
+#include <chrono>
 #include <memory>
 #include <string_view>
 
@@ -19,9 +21,66 @@ namespace genesis
 class smd
 {
 public:
-	smd(const genesis::rom& rom, std::shared_ptr<io_ports::input_device> input_dev1);
+	// execution time of a single device, only collected while profiling is enabled
+	struct device_profile
+	{
+		std::uint64_t calls = 0;
+
+		// time is collected only in sampled slices, every call is charged with the time since the previous call
+		std::uint64_t sampled_calls = 0;
+		std::chrono::nanoseconds sampled_time{0};
+	};
+
+	struct profile
+	{
+		device_profile m68k;
+		device_profile z80;
+		device_profile vdp;
 
-	void cycle();
+		// every run_until call (slice) is timed as a whole, only every N-th one is split between devices
+		std::uint64_t slices = 0;
+		std::chrono::nanoseconds total_time{0};
+		std::chrono::nanoseconds sampled_time{0};
+
+		// cost of a single time stamp, it's excluded from the device time
+		std::chrono::nanoseconds timer_overhead{0};
+
+		// estimated total time spent in the device, device times never add up to more than total_time
+		std::chrono::nanoseconds time(const device_profile& dev) const;
+	};
+
+	enum class m68k_mode
+	{
+		// m68k is executed cycle by cycle, all bus accesses happen exactly in time
+		cycle_accurate,
+
+		// m68k executes the whole instruction at once (unless it has to wait for an external device),
+		// the rest of the system sees its bus accesses at the beginning of the instruction
+		instruction_level,
+	};
+
+public:
+	smd(const genesis::rom& rom, std::shared_ptr<io_ports::input_device> input_dev1,
+		m68k_mode mode = m68k_mode::cycle_accurate);
+
+	// run all devices until the master clock reaches the specified value
+	void run_until(std::uint64_t mclk);
+
+	// run until VDP completes the current frame
+	void run_frame();
+
+	// number of master clock cycles elapsed since power on
+	std::uint64_t mclk() const
+	{
+		return m_mclk;
+	}
+
+	void enable_profiling(bool enable);
+
+	const profile& profiling_data() const
+	{
+		return m_profile;
+	}
 
 	vdp::vdp& vdp()
 	{
@@ -29,17 +88,40 @@ public:
 	}
 
 private:
+	enum class profile_mode
+	{
+		none,
+		count_calls,
+		time_calls,
+	};
+
+	template <profile_mode Mode>
+	void run_until_impl(std::uint64_t mclk);
+
+	template <profile_mode Mode, class Callable>
+	void run_device(device_profile& prof, Callable&& func);
+
+	// run Z80 for all its cycles due up to the master cycle (inclusive)
+	template <profile_mode Mode>
+	void z80_catch_up(std::uint64_t mclk);
+
+	// called before any M68K access to Z80 memory or control registers
+	void z80_sync();
+
 	void build_cpu_memory_map(const genesis::rom& rom);
+	std::shared_ptr<memory::addressable> z80_synced(std::shared_ptr<memory::addressable> unit);
 
 	static std::unique_ptr<memory::addressable> build_version_register(const genesis::rom& rom);
-	static std::shared_ptr<std::vector<std::uint8_t>> load_rom(const genesis::rom& rom);
+	static void add_rom(memory::memory_builder& builder, const genesis::rom& rom);
+	static std::shared_ptr<memory::addressable> build_rom_area(const genesis::rom& rom);
 
 private:
 	std::shared_ptr<memory::addressable> m_m68k_mem_map;
 	std::shared_ptr<memory::addressable> m_z80_mem_map;
 
-	// tmp
-	void z80_cycle();
+	// run Z80 for the specified number of T-states, returns the number of elapsed T-states
+	std::uint32_t z80_run(std::uint32_t cycle_budget);
+
 	impl::z80_control_registers m_z80_ctrl_registers;
 
 protected:
@@ -47,7 +129,18 @@ protected:
 	std::unique_ptr<z80::cpu> m_z80_cpu;
 	std::unique_ptr<vdp::vdp> m_vdp;
 
-	unsigned cycles = 0;
+	// master clock timeline
+	std::uint64_t m_mclk = 0;
+	std::uint64_t m_vdp_mclk = 0;
+	std::uint64_t m_m68k_next_due;
+	std::uint64_t m_z80_next_due;
+
+	m68k_mode m_m68k_mode;
+
+	bool m_profiling = false;
+	profile m_profile;
+	profile_mode m_profile_mode = profile_mode::none;
+	std::chrono::steady_clock::time_point m_last_stamp;
 
 private:
 	std::shared_ptr<io_ports::input_device> m_input_dev1;
@@ -1,30 +1,33 @@
 #ifndef __M68K_STATIC_QUEUE_HPP__
 #define __M68K_STATIC_QUEUE_HPP__
 
+#include "exception.hpp"
+
+#include <array>
 #include <cstddef>
-#include <vector>
-#include <iostream>
+#include <utility>
 
 namespace genesis
 {
 
-template<class T>
+// Fixed-capacity FIFO ring buffer, never allocates
+template <class T, std::size_t Capacity = 128>
 class static_queue
 {
+	static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of 2");
+
 public:
 	using value_type = T;
+
 public:
-	static_queue(std::size_t size = 100)
+	constexpr std::size_t capacity() const
 	{
-		// std::cout << "Allocating about " << sizeof(value_type) * size << " bytes for buffer" << std::endl;
-		// buffer.reserve(size);
-		// buffer.resize(size);
+		return Capacity;
 	}
 
-	std::size_t capacity() const
+	std::size_t size() const
 	{
-		// return buffer.capacity();
-		return 100;
+		return free_slot - first_slot;
 	}
 
 	bool empty() const
@@ -39,34 +42,49 @@ public:
 
 	void push(const T& val)
 	{
-		buffer[free_slot] = val;
-		free_slot = (free_slot + 1) % capacity();
+		check_overflow();
+		buffer[free_slot++ & mask] = val;
 	}
 
 	void push(T&& val)
 	{
-		buffer[free_slot] = std::move(val);
-		free_slot = (free_slot + 1) % capacity();
+		check_overflow();
+		buffer[free_slot++ & mask] = std::move(val);
+	}
+
+	template <class... Args>
+	void emplace(Args&&... args)
+	{
+		check_overflow();
+		buffer[free_slot++ & mask] = T{std::forward<Args>(args)...};
 	}
 
 	value_type& front()
 	{
-		return buffer[first_slot];
+		return buffer[first_slot & mask];
 	}
 
-	value_type& front() const
+	const value_type& front() const
 	{
-		return buffer[first_slot];
+		return buffer[first_slot & mask];
 	}
 
 	void pop()
 	{
-		first_slot = (first_slot + 1) % capacity();
+		++first_slot;
 	}
 
 private:
-	// std::vector<value_type> buffer;
-	value_type buffer[100];
+	void check_overflow() const
+	{
+		if(size() == Capacity)
+			throw internal_error("static_queue overflow");
+	}
+
+private:
+	constexpr const static std::size_t mask = Capacity - 1;
+
+	std::array<value_type, Capacity> buffer;
 	std::size_t free_slot = 0;
 	std::size_t first_slot = 0;
 };
@@ -0,0 +1,143 @@
+#ifndef __VDP_FRAMEBUFFER_H__
+#define __VDP_FRAMEBUFFER_H__
+
+#include "pixel_format.h"
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+
+namespace genesis::vdp
+{
+
+// completed frame in the host pixel format, can be uploaded to a texture as is
+struct frame_view
+{
+	const void* pixels;
+	unsigned width;
+	unsigned height;
+	std::size_t pitch; // in bytes
+	pixel_format format;
+};
+
+/* Triple-buffered active display in the host pixel format.
+ * Lines are rendered into the back buffer. Once the frame is completed, the back buffer is published
+ * by atomically exchanging it with the ready one, so the producer (emulation) never waits for the consumer.
+ * The consumer picks up the most recently published frame by exchanging its front buffer with the ready one,
+ * the front buffer is stable till the consumer calls front() again.
+ *
+ * The producer (back_row/swap) and the consumer (front) may run on different threads,
+ * but there must be at most one thread on each side. set_format must not race with either of them. */
+class framebuffer
+{
+public:
+	static const unsigned max_width = 320;
+	static const unsigned max_height = 240;
+
+public:
+	framebuffer(pixel_format format = pixel_format::argb8888)
+	{
+		set_format(format);
+	}
+
+	pixel_format format() const
+	{
+		return m_format;
+	}
+
+	// all buffers are cleared
+	void set_format(pixel_format format)
+	{
+		m_format = format;
+		m_pitch = max_width * bytes_per_pixel(format);
+
+		for(auto& buf : m_buffers)
+		{
+			buf.pixels.assign(m_pitch * max_height, 0);
+			buf.width = buf.height = 0;
+		}
+
+		m_back = 0;
+		m_ready.store(1, std::memory_order_relaxed);
+		m_front = 2;
+	}
+
+	// row of the back buffer to render the line to
+	template <class Pixel>
+	std::span<Pixel> back_row(unsigned row_number)
+	{
+		check_row<Pixel>(row_number);
+		auto* row = reinterpret_cast<Pixel*>(m_buffers[m_back].pixels.data() + row_number * m_pitch);
+		return std::span<Pixel>(row, max_width);
+	}
+
+	template <class Pixel>
+	std::span<const Pixel> back_row(unsigned row_number) const
+	{
+		check_row<Pixel>(row_number);
+		auto* row = reinterpret_cast<const Pixel*>(m_buffers[m_back].pixels.data() + row_number * m_pitch);
+		return std::span<const Pixel>(row, max_width);
+	}
+
+	// publish the back buffer, width/height - dimension of the completed frame
+	void swap(unsigned width, unsigned height)
+	{
+		m_buffers[m_back].width = width;
+		m_buffers[m_back].height = height;
+
+		// the previous ready buffer is either not picked up by the consumer or already released by it
+		unsigned prev = m_ready.exchange(m_back | fresh_flag, std::memory_order_acq_rel);
+		m_back = prev & index_mask;
+	}
+
+	// returns the most recently completed frame (empty if there were no completed frames yet)
+	frame_view front()
+	{
+		if((m_ready.load(std::memory_order_relaxed) & fresh_flag) != 0)
+		{
+			unsigned ready = m_ready.exchange(m_front, std::memory_order_acq_rel);
+			m_front = ready & index_mask;
+		}
+
+		const auto& buf = m_buffers[m_front];
+		return {buf.pixels.data(), buf.width, buf.height, m_pitch, m_format};
+	}
+
+private:
+	template <class Pixel>
+	void check_row(unsigned row_number) const
+	{
+		if(sizeof(Pixel) != bytes_per_pixel(m_format))
+			throw std::invalid_argument("pixel type does not match the framebuffer format");
+		if(row_number >= max_height)
+			throw std::invalid_argument("row_number exceeds max display height");
+	}
+
+private:
+	struct buffer
+	{
+		std::vector<std::uint8_t> pixels;
+		unsigned width = 0;
+		unsigned height = 0;
+	};
+
+	// m_ready keeps the index of the ready buffer and whether it was published after the last pick up
+	static const unsigned index_mask = 0b011;
+	static const unsigned fresh_flag = 0b100;
+
+	pixel_format m_format;
+	std::size_t m_pitch;
+
+	buffer m_buffers[3];
+
+	unsigned m_back; // owned by the producer
+	std::atomic<unsigned> m_ready;
+	unsigned m_front; // owned by the consumer
+};
+
+} // namespace genesis::vdp
+
+#endif // __VDP_FRAMEBUFFER_H__
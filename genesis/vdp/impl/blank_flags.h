@@ -87,20 +87,21 @@ public:
 
 	void update(int hcounter_raw, display_width width)
 	{
-		if(width == display_width::c32)
-		{
-			if(hcounter_raw == 0x93)
-				m_flag = true;
-			else if(hcounter_raw == 0x05)
-				m_flag = false;
-		}
-		else
-		{
-			if(hcounter_raw == 0xB3)
-				m_flag = true;
-			else if(hcounter_raw == 0x06)
-				m_flag = false;
-		}
+		if(hcounter_raw == set_position(width))
+			m_flag = true;
+		else if(hcounter_raw == clear_position(width))
+			m_flag = false;
+	}
+
+	// raw H counter values at which the flag changes
+	static int set_position(display_width width)
+	{
+		return width == display_width::c32 ? 0x93 : 0xB3;
+	}
+
+	static int clear_position(display_width width)
+	{
+		return width == display_width::c32 ? 0x05 : 0x06;
 	}
 
 private:
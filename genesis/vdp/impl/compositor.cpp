@@ -0,0 +1,236 @@
+#include "compositor.h"
+
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GENESIS_COMPOSITOR_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(GENESIS_COMPOSITOR_X86) && !defined(_MSC_VER)
+#define GENESIS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define GENESIS_TARGET(isa)
+#endif
+
+
+namespace genesis::vdp::impl
+{
+
+namespace
+{
+
+/* Priority order (from the highest to the lowest):
+ * high priority sprite, high priority A, high priority B,
+ * low priority sprite, low priority A, low priority B, background.
+ * Transparent pixels never win, so go from the lowest layer to the highest one
+ * and let each opaque pixel of the current layer overwrite the result. */
+
+std::uint8_t resolve_priority(std::uint8_t a, std::uint8_t b, std::uint8_t s, std::uint8_t background_index)
+{
+	const std::uint8_t layers[] = {b, a, s};
+
+	std::uint8_t res = background_index;
+	for(bool high : {false, true})
+	{
+		for(std::uint8_t px : layers)
+		{
+			const bool opaque = (px & internal_pixel::color_mask) != 0;
+			const bool high_px = (px & internal_pixel::priority_mask) != 0;
+			if(opaque && high_px == high)
+				res = px & internal_pixel::color_index_mask;
+		}
+	}
+
+	return res;
+}
+
+void resolve_scalar(const std::uint8_t* a, const std::uint8_t* b, const std::uint8_t* s, std::uint8_t background_index,
+					std::uint8_t* dest, std::size_t count)
+{
+	for(std::size_t i = 0; i < count; ++i)
+		dest[i] = resolve_priority(a[i], b[i], s[i], background_index);
+}
+
+#if defined(GENESIS_COMPOSITOR_X86)
+
+GENESIS_TARGET("sse2")
+void resolve_sse2(const std::uint8_t* a, const std::uint8_t* b, const std::uint8_t* s, std::uint8_t background_index,
+				  std::uint8_t* dest, std::size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i color_mask = _mm_set1_epi8(internal_pixel::color_mask);
+	const __m128i index_mask = _mm_set1_epi8(internal_pixel::color_index_mask);
+	const __m128i prio_mask = _mm_set1_epi8(internal_pixel::priority_mask);
+	const __m128i bg = _mm_set1_epi8((char)background_index);
+
+	std::size_t i = 0;
+	for(; i + 16 <= count; i += 16)
+	{
+		const __m128i layers[] = {_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)),
+								  _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+								  _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i))};
+
+		__m128i low = bg;
+		__m128i high = bg;
+		__m128i high_set = zero;
+		for(const __m128i px : layers)
+		{
+			__m128i opaque = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_and_si128(px, color_mask), zero), _mm_set1_epi8(-1));
+			__m128i is_high = _mm_cmpeq_epi8(_mm_and_si128(px, prio_mask), prio_mask);
+			__m128i index = _mm_and_si128(px, index_mask);
+
+			__m128i low_sel = _mm_andnot_si128(is_high, opaque);
+			__m128i high_sel = _mm_and_si128(is_high, opaque);
+
+			low = _mm_or_si128(_mm_and_si128(low_sel, index), _mm_andnot_si128(low_sel, low));
+			high = _mm_or_si128(_mm_and_si128(high_sel, index), _mm_andnot_si128(high_sel, high));
+			high_set = _mm_or_si128(high_set, high_sel);
+		}
+
+		__m128i res = _mm_or_si128(_mm_and_si128(high_set, high), _mm_andnot_si128(high_set, low));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), res);
+	}
+
+	resolve_scalar(a + i, b + i, s + i, background_index, dest + i, count - i);
+}
+
+GENESIS_TARGET("avx2")
+void resolve_avx2(const std::uint8_t* a, const std::uint8_t* b, const std::uint8_t* s, std::uint8_t background_index,
+				  std::uint8_t* dest, std::size_t count)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i color_mask = _mm256_set1_epi8(internal_pixel::color_mask);
+	const __m256i index_mask = _mm256_set1_epi8(internal_pixel::color_index_mask);
+	const __m256i prio_mask = _mm256_set1_epi8(internal_pixel::priority_mask);
+	const __m256i bg = _mm256_set1_epi8((char)background_index);
+
+	std::size_t i = 0;
+	for(; i + 32 <= count; i += 32)
+	{
+		const __m256i layers[] = {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)),
+								  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+								  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i))};
+
+		__m256i low = bg;
+		__m256i high = bg;
+		__m256i high_set = zero;
+		for(const __m256i px : layers)
+		{
+			__m256i transparent = _mm256_cmpeq_epi8(_mm256_and_si256(px, color_mask), zero);
+			__m256i is_high = _mm256_cmpeq_epi8(_mm256_and_si256(px, prio_mask), prio_mask);
+			__m256i index = _mm256_and_si256(px, index_mask);
+
+			__m256i low_sel = _mm256_andnot_si256(_mm256_or_si256(is_high, transparent), _mm256_set1_epi8(-1));
+			__m256i high_sel = _mm256_andnot_si256(transparent, is_high);
+
+			low = _mm256_blendv_epi8(low, index, low_sel);
+			high = _mm256_blendv_epi8(high, index, high_sel);
+			high_set = _mm256_or_si256(high_set, high_sel);
+		}
+
+		__m256i res = _mm256_blendv_epi8(low, high, high_set);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), res);
+	}
+
+	resolve_sse2(a + i, b + i, s + i, background_index, dest + i, count - i);
+}
+
+#if defined(_MSC_VER)
+
+bool cpu_supports(compositor::instruction_set isa)
+{
+	int info[4];
+	__cpuid(info, 0);
+	const int max_leaf = info[0];
+
+	__cpuid(info, 1);
+	if(isa == compositor::instruction_set::sse2)
+		return (info[3] & (1 << 26)) != 0;
+
+	// AVX2 also requires OS support for saving YMM registers
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	if(!osxsave || max_leaf < 7 || (_xgetbv(0) & 0b110) != 0b110)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+}
+
+#else
+
+bool cpu_supports(compositor::instruction_set isa)
+{
+	if(isa == compositor::instruction_set::sse2)
+		return __builtin_cpu_supports("sse2");
+	return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+#endif // GENESIS_COMPOSITOR_X86
+
+compositor::resolve_func get_resolve_func(compositor::instruction_set isa)
+{
+	switch(isa)
+	{
+	case compositor::instruction_set::scalar:
+		return resolve_scalar;
+
+#if defined(GENESIS_COMPOSITOR_X86)
+	case compositor::instruction_set::sse2:
+		return resolve_sse2;
+
+	case compositor::instruction_set::avx2:
+		return resolve_avx2;
+#endif
+
+	default:
+		return nullptr;
+	}
+}
+
+} // namespace
+
+compositor::compositor() : compositor(best_supported())
+{
+}
+
+compositor::compositor(instruction_set isa) : m_isa(isa)
+{
+	if(!is_supported(isa))
+		throw std::invalid_argument("instruction set is not supported by the host CPU");
+
+	m_resolve = get_resolve_func(isa);
+}
+
+bool compositor::is_supported(instruction_set isa)
+{
+	if(isa == instruction_set::scalar)
+		return true;
+
+#if defined(GENESIS_COMPOSITOR_X86)
+	return cpu_supports(isa);
+#else
+	return false;
+#endif
+}
+
+compositor::instruction_set compositor::best_supported()
+{
+	static const instruction_set best = []() {
+		for(auto isa : {instruction_set::avx2, instruction_set::sse2})
+		{
+			if(is_supported(isa))
+				return isa;
+		}
+		return instruction_set::scalar;
+	}();
+
+	return best;
+}
+
+} // namespace genesis::vdp::impl
@@ -0,0 +1,88 @@
+#ifndef __VDP_IMPL_COMPOSITOR_H__
+#define __VDP_IMPL_COMPOSITOR_H__
+
+#include "internal_pixel.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+
+
+namespace genesis::vdp::impl
+{
+
+/* Merges plane A/B and sprite layers of the active display line into final colors.
+ * Priority and transparency are resolved for a batch of pixels at once (16 with SSE2, 32 with AVX2),
+ * the best instruction set supported by the host CPU is selected at runtime. */
+class compositor
+{
+public:
+	enum class instruction_set
+	{
+		scalar,
+		sse2,
+		avx2,
+	};
+
+	// use the best supported instruction set
+	compositor();
+
+	// throws std::invalid_argument if instruction set is not supported by the host CPU
+	compositor(instruction_set isa);
+
+	static bool is_supported(instruction_set isa);
+	static instruction_set best_supported();
+
+	instruction_set isa() const
+	{
+		return m_isa;
+	}
+
+	// background_index - CRAM color index (palette * 16 + color) of the background color
+	// colors - 64 CRAM colors in the destination format
+	template <class Pixel, std::size_t N>
+	void compose(std::span<const internal_pixel> plane_a, std::span<const internal_pixel> plane_b,
+				 std::span<const internal_pixel> sprites, std::uint8_t background_index,
+				 const std::array<Pixel, N>& colors, std::span<Pixel> dest) const
+	{
+		static_assert(N == 64);
+
+		const std::size_t count = dest.size();
+		if(plane_a.size() < count || plane_b.size() < count || sprites.size() < count)
+			throw std::invalid_argument("layers do not have enough pixels");
+
+		// resolve color indexes by chunks, then look up colors
+		std::array<std::uint8_t, 64> indexes;
+		for(std::size_t pos = 0; pos < count; pos += indexes.size())
+		{
+			std::size_t chunk = std::min(indexes.size(), count - pos);
+			m_resolve(raw(plane_a, pos), raw(plane_b, pos), raw(sprites, pos), background_index, indexes.data(), chunk);
+
+			for(std::size_t i = 0; i < chunk; ++i)
+				dest[pos + i] = colors[indexes[i]];
+		}
+	}
+
+public:
+	// writes CRAM color index of the resolved pixel into the dest
+	using resolve_func = void (*)(const std::uint8_t* plane_a, const std::uint8_t* plane_b,
+								  const std::uint8_t* sprites, std::uint8_t background_index, std::uint8_t* dest,
+								  std::size_t count);
+
+private:
+	static const std::uint8_t* raw(std::span<const internal_pixel> layer, std::size_t pos)
+	{
+		return reinterpret_cast<const std::uint8_t*>(layer.data() + pos);
+	}
+
+private:
+	instruction_set m_isa;
+	resolve_func m_resolve;
+};
+
+} // namespace genesis::vdp::impl
+
+#endif // __VDP_IMPL_COMPOSITOR_H__
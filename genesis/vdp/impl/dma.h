@@ -1,11 +1,14 @@
 #ifndef __VDP_DMA_H__
 #define __VDP_DMA_H__
 
+#include "fifo_write.h"
 #include "memory_access.h"
 #include "vdp/m68k_bus_access.h"
+#include "vdp/memory.h"
 #include "vdp/register_set.h"
 #include "vdp/settings.h"
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 
@@ -87,6 +90,40 @@ public:
 		}
 	}
 
+	// true if the current operation can be done by run_block
+	// (fill, VRAM copy or M68K copy which is not waiting for FIFO, memory or M68K bus)
+	bool can_run_block() const
+	{
+		if(_state != state::fill && _state != state::vram_copy && _state != state::m68k_copy)
+			return false;
+
+		if(!regs.fifo.empty() || !memory.is_idle())
+			return false;
+
+		if(_state == state::m68k_copy)
+			return m68k_copy_can_run_block();
+
+		return true;
+	}
+
+	/* Perform up to the specified number of cycles of the current DMA operation at once.
+	 * Every unit takes the same number of cycles as it does when executed by cycle(), so the result
+	 * is the same as calling cycle() the returned number of times, provided that VDP has nothing else to do
+	 * (see can_run_block). Returns the number of performed cycles. */
+	std::uint32_t run_block(std::uint32_t cycles, vram_t& vram, cram_t& cram, vsram_t& vsram)
+	{
+		if(cycles == 0 || !can_run_block())
+			return 0;
+
+		if(_state == state::fill)
+			return fill_block(cycles, vram, cram, vsram);
+
+		if(_state == state::m68k_copy)
+			return m68k_copy_block(cycles, vram, cram, vsram);
+
+		return vram_copy_block(cycles, vram);
+	}
+
 private:
 	void check_work()
 	{
@@ -156,6 +193,40 @@ private:
 		advance();
 	}
 
+	// every unit takes 1 cycle
+	std::uint32_t fill_block(std::uint32_t cycles, vram_t& vram, cram_t& cram, vsram_t& vsram)
+	{
+		auto mem_type = regs.control.vmem_type();
+		if(mem_type == vmem_type::invalid)
+		{
+			// let do_fill report it
+			return 0;
+		}
+
+		const std::uint32_t units = std::min(cycles, units_left());
+		const std::uint8_t inc = sett.auto_increment_value();
+		std::uint16_t addr = regs.control.address();
+
+		if(mem_type == vmem_type::vram)
+		{
+			vram.fill(addr, data_to_fill_vram(), units, inc);
+		}
+		else
+		{
+			std::uint16_t fill_data = regs.fifo.next().data;
+			for(std::uint32_t i = 0; i < units; ++i, addr = static_cast<std::uint16_t>(addr + inc))
+			{
+				if(mem_type == vmem_type::cram)
+					cram.write(addr, fill_data);
+				else
+					vsram.write(addr, fill_data);
+			}
+		}
+
+		advance(units);
+		return units;
+	}
+
 	std::uint8_t data_to_fill_vram() const
 	{
 		std::uint16_t data = regs.fifo.prev().data;
@@ -197,8 +268,53 @@ private:
 		reading = true;
 	}
 
+	// every byte takes 2 cycles: read on the first one and write on the second one
+	std::uint32_t vram_copy_block(std::uint32_t cycles, vram_t& vram)
+	{
+		std::uint32_t done = 0;
+
+		if(reading)
+		{
+			// the byte was read on the previous cycle
+			reading = false;
+			vram.write<std::uint8_t>(regs.control.address(), memory.latched_byte());
+			advance();
+
+			if(++done == cycles || _state != state::vram_copy)
+				return done;
+		}
+
+		// source is not wrapped, leave reading beyond VRAM to do_vram_copy
+		const std::uint32_t source_left = dma_source() <= 0xFFFF ? 0x10000 - dma_source() : 0;
+		const std::uint32_t units = std::min({(cycles - done) / 2, units_left(), source_left});
+		if(units != 0)
+		{
+			vram.copy(regs.control.address(), dma_source(), units, sett.auto_increment_value());
+			advance_dma_source(units);
+			advance(units);
+			done += units * 2;
+		}
+
+		if(done < cycles && _state == state::vram_copy && dma_source() <= 0xFFFF)
+		{
+			// read the next byte, it's written by the next cycle
+			memory.set_read_result(vram.read<std::uint8_t>(dma_source()));
+			advance_dma_source(+1);
+			reading = true;
+			++done;
+		}
+
+		return done;
+	}
+
 	void do_m68k_copy()
 	{
+		if(m_read_cycles_left != 0 && --m_read_cycles_left != 0)
+		{
+			// the word has been read by run_block, wait till its bus cycle is over
+			return;
+		}
+
 		if(regs.fifo.full())
 		{
 			// wait till we get at least 1 slot
@@ -228,7 +344,9 @@ private:
 		{
 			reading = false;
 
-			std::uint16_t data = m68k_bus->latched_word();
+			std::uint16_t data = m_direct_read ? m_read_word : m68k_bus->latched_word();
+			m_direct_read = false;
+
 			regs.fifo.push(data, regs.control);
 			inc_control_address();
 
@@ -253,6 +371,87 @@ private:
 		reading = true;
 	}
 
+	// the bus is ours and no bus cycle is in progress (or it's only counted down by run_block)
+	bool m68k_copy_can_run_block() const
+	{
+		if(m68k_bus->word_read_cycles() == 0 || regs.control.vmem_type() == vmem_type::invalid)
+			return false;
+
+		if(!access_requested || !m68k_bus->bus_granted())
+			return false;
+
+		if(m_read_cycles_left != 0)
+			return true;
+
+		// the directly read word missed its last cycle (it happens only when FIFO is full), let cycle() handle it
+		return m68k_bus->is_idle() && !(reading && m_direct_read);
+	}
+
+	/* Every word takes the whole M68K read bus cycle (see m68k_bus_access::word_read_cycles), but the word
+	 * is read directly and the bus cycle is only counted down. The word goes through FIFO on the last cycle
+	 * of the bus cycle as it does in cycle(), so M68K is stalled exactly for the same number of cycles. */
+	std::uint32_t m68k_copy_block(std::uint32_t cycles, vram_t& vram, cram_t& cram, vsram_t& vsram)
+	{
+		std::uint32_t done = 0;
+
+		while(done < cycles)
+		{
+			if(m_read_cycles_left > 1)
+			{
+				// wait till the last cycle of the bus cycle
+				std::uint32_t wait = std::min(m_read_cycles_left - 1, cycles - done);
+				m_read_cycles_left -= wait;
+				done += wait;
+				continue;
+			}
+
+			m_read_cycles_left = 0;
+			++done;
+
+			if(reading)
+			{
+				reading = false;
+
+				std::uint16_t data = m_direct_read ? m_read_word : m68k_bus->latched_word();
+				m_direct_read = false;
+
+				// FIFO is empty, so the word is written on the same cycle
+				regs.fifo.push(data, regs.control);
+				write_fifo_entry(regs.fifo.pop(), vram, cram, vsram);
+				inc_control_address();
+
+				if(dma_length() == 0)
+				{
+					m68k_bus->release_bus();
+					access_requested = false;
+
+					_state = state::finishing;
+					return done;
+				}
+			}
+
+			std::uint32_t src_address = dma_source();
+			auto word = m68k_bus->read_word_direct(src_address);
+
+			advance_dma_source(+2);
+			dec_length();
+			reading = true;
+
+			if(!word.has_value())
+			{
+				// not a plain memory, leave the read to the bus
+				m68k_bus->init_read_word(src_address);
+				return done;
+			}
+
+			m_read_word = word.value();
+			m_direct_read = true;
+			m_read_cycles_left = m68k_bus->word_read_cycles();
+		}
+
+		return done;
+	}
+
 	void do_finishing()
 	{
 		if(memory.is_idle() && m68k_bus->is_idle())
@@ -268,11 +467,12 @@ private:
 		regs.control.address(regs.control.address() + sett.auto_increment_value());
 	}
 
-	void advance()
+	void advance(std::uint32_t units = 1)
 	{
-		inc_control_address();
+		regs.control.address(
+			static_cast<std::uint16_t>(regs.control.address() + units * sett.auto_increment_value()));
 
-		dec_length();
+		dec_length(units);
 
 		if(dma_length() == 0)
 		{
@@ -286,10 +486,16 @@ private:
 		return m_length;
 	}
 
-	void dec_length()
+	void dec_length(std::uint32_t units = 1)
 	{
-		--m_length;
-		sett.dma_length(sett.dma_length() - 1);
+		m_length = static_cast<std::uint16_t>(m_length - units);
+		sett.dma_length(static_cast<std::uint16_t>(sett.dma_length() - units));
+	}
+
+	// number of units left till the end of operation (0 length stands for 0x10000 units)
+	std::uint32_t units_left() const
+	{
+		return m_length == 0 ? 0x10000 : m_length;
 	}
 
 	std::uint32_t dma_source() const
@@ -315,6 +521,11 @@ private:
 	std::shared_ptr<vdp::m68k_bus_access> m68k_bus;
 	bool access_requested = false;
 
+	// the word read by run_block, it's latched when the bus cycle is counted down
+	std::uint16_t m_read_word = 0;
+	bool m_direct_read = false;
+	std::uint32_t m_read_cycles_left = 0;
+
 	std::uint16_t m_length = 0;
 	std::uint32_t m_source = 0;
 };
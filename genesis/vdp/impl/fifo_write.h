@@ -0,0 +1,57 @@
+#ifndef __VDP_FIFO_WRITE_H__
+#define __VDP_FIFO_WRITE_H__
+
+#include "exception.hpp"
+#include "vdp/impl/fifo.h"
+#include "vdp/memory.h"
+
+
+namespace genesis::vdp::impl
+{
+
+// write the entry popped from FIFO to the memory it's addressed to
+inline void write_fifo_entry(fifo_entry entry, vram_t& vram, cram_t& cram, vsram_t& vsram)
+{
+	switch(entry.control.vmem_type())
+	{
+	case vmem_type::vram: {
+		/* It seems that official/unofficial documentation is incorrect about write order.
+		 * The following order seems the right one:
+		 * If address is even: we first have to write MSB and then LSB.
+		 * If address is odd : we first have to write LSB and then LSB.
+		 */
+
+		if(entry.control.address() % 2 == 1)
+		{
+			// writing to odd addresses swaps bytes
+			endian::swap(entry.data);
+
+			// writing cannot cross a word boundary
+			entry.control.address(entry.control.address() & ~1);
+		}
+
+		// TODO: vram has byte-only access
+		vram.write(entry.control.address(), entry.data);
+	}
+	break;
+
+	case vmem_type::cram:
+		cram.write(entry.control.address(), entry.data);
+		break;
+
+	case vmem_type::vsram:
+		vsram.write(entry.control.address(), entry.data);
+		break;
+
+	case vmem_type::invalid:
+		// TODO: what should we do?
+		throw genesis::not_implemented();
+
+	default:
+		throw internal_error();
+	}
+}
+
+} // namespace genesis::vdp::impl
+
+#endif // __VDP_FIFO_WRITE_H__
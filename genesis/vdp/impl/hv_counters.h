@@ -32,6 +32,11 @@ public:
 		return m_value;
 	}
 
+	bool overflowed() const
+	{
+		return m_overflow;
+	}
+
 protected:
 	void inc2(int overflow_value, int fallback_value)
 	{
@@ -90,10 +95,43 @@ class h_counter : public base_counter
 public:
 	void inc(display_width width)
 	{
-		int overflow_value = (width == display_width::c32) ? 0x93 : 0xB6;
-		int fallback_value = (width == display_width::c32) ? 0xE9 : 0xE4;
+		inc2(overflow_value(width), fallback_value(width));
+	}
+
+	// Returns the number of increments required for the raw value to reach raw_target (which must be within
+	// the line). Returns 1 if the counter is in an irregular state (i.e. display width was changed mid-line),
+	// so the caller has to increment it one by one.
+	int increments_to(int raw_target, display_width width) const
+	{
+		const int ov = overflow_value(width);
+		const int fb = fallback_value(width);
+		const int period = (ov + 1) + (0xFF - fb + 1);
+
+		int to_wrap;
+		if(overflowed())
+			to_wrap = 0xFF - value() + 1;
+		else if(value() <= ov)
+			to_wrap = (ov - value() + 1) + (0xFF - fb + 1);
+		else
+			return 1;
+
+		if(raw_value() + to_wrap != period)
+			return 1;
 
-		inc2(overflow_value, fallback_value);
+		if(raw_target > raw_value())
+			return raw_target - raw_value();
+		return to_wrap + raw_target;
+	}
+
+private:
+	static int overflow_value(display_width width)
+	{
+		return (width == display_width::c32) ? 0x93 : 0xB6;
+	}
+
+	static int fallback_value(display_width width)
+	{
+		return (width == display_width::c32) ? 0xE9 : 0xE4;
 	}
 };
 
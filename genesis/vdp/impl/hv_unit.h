@@ -7,6 +7,8 @@
 #include "vdp/register_set.h"
 #include "vdp/settings.h"
 
+#include <algorithm>
+
 
 namespace genesis::vdp::impl
 {
@@ -37,7 +39,8 @@ public:
 		return m_v_counter.raw_value();
 	}
 
-	void on_pixel(display_width width, display_height height, mode mode)
+	// returns true if V counter is incremented
+	bool on_pixel(display_width width, display_height height, mode mode)
 	{
 		/* update H counter every pixel */
 		m_h_counter.inc(width);
@@ -47,15 +50,46 @@ public:
 		m_regs.SR.HB = m_hblank_flag.value() ? 1 : 0;
 
 		/* update V counter at specific H position */
-		if((width == display_width::c32 && m_h_counter.raw_value() == 0x85) ||
-		   (width == display_width::c40 && m_h_counter.raw_value() == 0xA5))
-		{
-			m_v_counter.inc(height, mode);
-			m_regs.v_counter = m_v_counter.value();
-
-			m_vblank_flag.update(m_v_counter.raw_value(), height, mode);
-			m_regs.SR.VB = m_vblank_flag.value() ? 1 : 0;
-		}
+		if(m_h_counter.raw_value() != v_counter_position(width))
+			return false;
+
+		m_v_counter.inc(height, mode);
+		m_regs.v_counter = m_v_counter.value();
+
+		m_vblank_flag.update(m_v_counter.raw_value(), height, mode);
+		m_regs.SR.VB = m_vblank_flag.value() ? 1 : 0;
+
+		return true;
+	}
+
+	// Advance H counter by the specified number of pixels.
+	// Pixels must not cross any event position (see pixels_to_next_event).
+	void skip_pixels(int pixels, display_width width)
+	{
+		for(; pixels > 0; --pixels)
+			m_h_counter.inc(width);
+		m_regs.h_counter = m_h_counter.value();
+	}
+
+	// number of pixels till H counter reaches the specified raw value
+	int pixels_to_h_counter(int raw_value, display_width width) const
+	{
+		return m_h_counter.increments_to(raw_value, width);
+	}
+
+	// number of pixels till the next pixel that changes blank flags or V counter
+	int pixels_to_next_event(display_width width) const
+	{
+		return std::min({pixels_to_h_counter(hblank_flag::set_position(width), width),
+						 pixels_to_h_counter(hblank_flag::clear_position(width), width),
+						 pixels_to_h_counter(v_counter_position(width), width)});
+	}
+
+private:
+	// raw H counter value at which V counter is incremented
+	static int v_counter_position(display_width width)
+	{
+		return width == display_width::c32 ? 0x85 : 0xA5;
 	}
 
 private:
@@ -0,0 +1,65 @@
+#ifndef __VDP_IMPL_INTERNAL_PIXEL_H__
+#define __VDP_IMPL_INTERNAL_PIXEL_H__
+
+#include <cstdint>
+
+
+namespace genesis::vdp::impl
+{
+
+// the actual pixel produced by vdp does not have priority or transparency,
+// but these properties are required to build the vdp frame,
+// so use different pixel representation for internal purposes
+//
+// Pixel is packed into a byte: -Qppcccc, where Q - priority, p - palette id, c - color id
+// so the lower 6 bits are the color index in CRAM
+struct internal_pixel
+{
+	static const std::uint8_t color_mask = 0x0F;
+	static const std::uint8_t color_index_mask = 0x3F;
+	static const std::uint8_t priority_mask = 0x40;
+
+	internal_pixel() = default;
+
+	internal_pixel(int palette_id, int color_id, bool priority)
+	{
+		value = (std::uint8_t)(((palette_id & 0b11) << 4) | (color_id & color_mask));
+		if(priority)
+			value |= priority_mask;
+	}
+
+	unsigned palette_id() const
+	{
+		return (value >> 4) & 0b11;
+	}
+
+	unsigned color_id() const
+	{
+		return value & color_mask;
+	}
+
+	unsigned color_index() const
+	{
+		return value & color_index_mask;
+	}
+
+	// only tails have priority, but it would be easier to assign each pixel a priority
+	bool priority() const
+	{
+		return (value & priority_mask) != 0;
+	}
+
+	// pixel is transparent if color_id is 0
+	bool transparent() const
+	{
+		return (value & color_mask) == 0;
+	}
+
+	std::uint8_t value = 0;
+};
+
+static_assert(sizeof(internal_pixel) == 1);
+
+} // namespace genesis::vdp::impl
+
+#endif // __VDP_IMPL_INTERNAL_PIXEL_H__
@@ -47,12 +47,19 @@ public:
 			auto height = m_sett.display_height();
 
 			check_vint_flag(raw_v_counter, raw_h_counter, height);
-			check_hint_flag(raw_v_counter, raw_v_counter, height, width);
+			check_hint_flag(raw_v_counter, raw_h_counter, height, width);
 		}
 
 		check_interrupts();
 	}
 
+	// raw H counter values at which interrupt flags are updated
+	static constexpr int vint_position = 0x02;
+	static int hint_position(display_width width)
+	{
+		return width == display_width::c40 ? 0xA6 : 0x86;
+	}
+
 	void on_interrupt(std::uint8_t ipl)
 	{
 		if(ipl == 6)
@@ -82,7 +89,7 @@ private:
 			return;
 
 		// vint flag is set exactly at H counter 0x02
-		if(h_counter != 0x02)
+		if(h_counter != vint_position)
 			return;
 
 		if(height == display_height::c28)
@@ -108,9 +115,7 @@ private:
 		if(m_hint_counter > 0)
 		{
 			int max_line = height == display_height::c28 ? 0xE0 : 0xF0;
-			int required_h = width == display_width::c40 ? 0xA6 : 0x86;
-
-			if(v_counter <= max_line && h_counter == required_h)
+			if(v_counter <= max_line && h_counter == hint_position(width))
 			{
 				--m_hint_counter;
 				if(m_hint_counter == 0)
@@ -0,0 +1,191 @@
+#ifndef __VDP_IMPL_LINE_STATE_LOG_H__
+#define __VDP_IMPL_LINE_STATE_LOG_H__
+
+#include "vdp/memory.h"
+#include "vdp/register_set.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+
+namespace genesis::vdp::impl
+{
+
+// VDP state the active display line was rendered from
+struct line_state
+{
+	unsigned line;
+
+	// R0-R23
+	std::array<std::uint8_t, 24> registers;
+
+	// status register before the line is rendered (sprites overflow on the previous line affects sprites masking)
+	std::uint16_t status;
+
+	// indexes of the memory snapshots in the log
+	std::uint32_t vram_version;
+	std::uint32_t cram_version;
+	std::uint32_t vsram_version;
+};
+
+/* Per-line VDP state log of the active display, so the frame can be rendered later (e.g. in parallel)
+ * exactly as if every line was rendered right when the V counter left it.
+ * Memories are captured only if they were modified since the previous recorded line,
+ * so a typical frame keeps a single snapshot of each memory.
+ * VRAM is copied as a whole only once per frame (version 0), every next version keeps only the patterns
+ * modified since the previous version, so VRAM of any version is the base with all deltas up to it applied. */
+class line_state_log
+{
+public:
+	using cram_snapshot = std::array<std::uint16_t, 64>;
+	using vsram_snapshot = std::array<std::uint16_t, 40>;
+
+public:
+	// recording a line 0 clears the log, so lines of the incomplete frame are dropped
+	void record(unsigned line, register_set& regs, vram_t& vram, cram_t& cram, vsram_t& vsram)
+	{
+		if(line == 0)
+			clear();
+
+		line_state state;
+		state.line = line;
+		for(std::uint8_t reg = 0; reg < state.registers.size(); ++reg)
+			state.registers[reg] = regs.get_register(reg);
+		state.status = regs.sr_raw;
+
+		if(m_vram_versions.empty() || vram.generation() != m_vram_generation)
+		{
+			auto& version = m_vram_versions.emplace_back();
+			version.first_pattern = m_vram_patterns.size();
+
+			// the first version of the frame has nothing to refer to
+			if(m_vram_versions.size() == 1)
+			{
+				if(m_vram_base == nullptr)
+					m_vram_base = std::make_unique<vram_t::content>();
+				vram.snapshot(*m_vram_base);
+				version.patterns.set();
+			}
+			else
+			{
+				version.patterns = vram.modified_patterns(m_vram_generation);
+				vram.snapshot(version.patterns, m_vram_patterns);
+			}
+
+			m_vram_generation = vram.generation();
+		}
+
+		if(m_cram.empty() || cram.generation() != m_cram_generation)
+		{
+			auto& snapshot = m_cram.emplace_back();
+			for(std::uint16_t i = 0; i < snapshot.size(); ++i)
+				snapshot[i] = cram.read(i * 2);
+			m_cram_generation = cram.generation();
+		}
+
+		if(m_vsram.empty() || vsram.generation() != m_vsram_generation)
+		{
+			auto& snapshot = m_vsram.emplace_back();
+			for(std::uint16_t i = 0; i < snapshot.size(); ++i)
+				snapshot[i] = vsram.read(i * 2);
+			m_vsram_generation = vsram.generation();
+		}
+
+		state.vram_version = static_cast<std::uint32_t>(m_vram_versions.size() - 1);
+		state.cram_version = static_cast<std::uint32_t>(m_cram.size() - 1);
+		state.vsram_version = static_cast<std::uint32_t>(m_vsram.size() - 1);
+
+		m_lines.push_back(state);
+	}
+
+	// buffers are kept for reuse
+	void clear()
+	{
+		m_lines.clear();
+		m_vram_versions.clear();
+		m_vram_patterns.clear();
+		m_cram.clear();
+		m_vsram.clear();
+		++m_id;
+	}
+
+	std::span<const line_state> lines() const
+	{
+		return m_lines;
+	}
+
+	// VRAM of the version 0
+	const vram_t::content& vram_base() const
+	{
+		if(m_vram_versions.empty())
+			throw std::out_of_range("vram_base");
+		return *m_vram_base;
+	}
+
+	// patterns that differ between the version and the previous one (all patterns for the version 0)
+	const vram_t::pattern_set& vram_delta(std::uint32_t version) const
+	{
+		return m_vram_versions.at(version).patterns;
+	}
+
+	// content of the vram_delta(version) patterns in ascending order (empty for the version 0, see vram_base)
+	std::span<const vram_t::pattern_data> vram_patterns(std::uint32_t version) const
+	{
+		const auto& ver = m_vram_versions.at(version);
+		if(version == 0)
+			return {};
+
+		const std::size_t end = version + 1 < m_vram_versions.size() ? m_vram_versions[version + 1].first_pattern
+																	 : m_vram_patterns.size();
+		return std::span<const vram_t::pattern_data>(m_vram_patterns).subspan(ver.first_pattern,
+																			   end - ver.first_pattern);
+	}
+
+	const cram_snapshot& cram(std::uint32_t version) const
+	{
+		return m_cram.at(version);
+	}
+
+	const vsram_snapshot& vsram(std::uint32_t version) const
+	{
+		return m_vsram.at(version);
+	}
+
+	// changes every time the log is cleared, so versions of different frames can be told apart
+	std::uint64_t id() const
+	{
+		return m_id;
+	}
+
+private:
+	struct vram_version
+	{
+		vram_t::pattern_set patterns;
+
+		// index of the first pattern of the version in m_vram_patterns
+		std::size_t first_pattern;
+	};
+
+private:
+	std::vector<line_state> m_lines;
+
+	std::unique_ptr<vram_t::content> m_vram_base;
+	std::vector<vram_version> m_vram_versions;
+	std::vector<vram_t::pattern_data> m_vram_patterns;
+	std::vector<cram_snapshot> m_cram;
+	std::vector<vsram_snapshot> m_vsram;
+
+	std::uint64_t m_vram_generation = 0;
+	std::uint64_t m_cram_generation = 0;
+	std::uint64_t m_vsram_generation = 0;
+
+	std::uint64_t m_id = 0;
+};
+
+} // namespace genesis::vdp::impl
+
+#endif // __VDP_IMPL_LINE_STATE_LOG_H__
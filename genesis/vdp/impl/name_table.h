@@ -51,6 +51,11 @@ public:
 		m_row_size_in_bytes = m_entries_per_row * sizeof(name_table_entry);
 	}
 
+	std::uint32_t plane_address() const
+	{
+		return m_plane_address;
+	}
+
 	int entries_per_row() const
 	{
 		return m_entries_per_row;
@@ -0,0 +1,132 @@
+#ifndef __VDP_IMPL_PLANE_CACHE_H__
+#define __VDP_IMPL_PLANE_CACHE_H__
+
+#include "name_table.h"
+#include "plane_type.h"
+#include "vdp/memory.h"
+#include "vdp/register_set.h"
+#include "vdp/settings.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+
+namespace genesis::vdp::impl
+{
+
+/* Keeps plane name table decoded between rows/frames.
+ * Plane geometry is re-read only when one of the registers defining it is changed,
+ * entries are re-decoded only when VRAM they were read from is modified. */
+class plane_cache
+{
+public:
+	plane_cache(plane_type plane, genesis::vdp::register_set& regs, genesis::vdp::settings& sett,
+				genesis::vdp::vram_t& vram)
+		: plane(plane), regs(regs), sett(sett), vram(vram)
+	{
+	}
+
+	// must be called before reading the entries
+	void update()
+	{
+		auto key = registers_key();
+		if(key == m_key && !m_entries.empty())
+			return;
+
+		m_key = key;
+
+		name_table table(plane, sett, vram);
+		m_plane_pattern = table.plane_address() / vram_t::pattern_size;
+		m_entries_per_row = table.entries_per_row();
+		m_row_count = table.row_count();
+
+		std::size_t num_entries = std::size_t(m_entries_per_row) * m_row_count;
+		m_entries.resize(num_entries);
+
+		// force all entries to be decoded again
+		m_block_generations.assign(num_entries / entries_per_block, 0);
+	}
+
+	int entries_per_row() const
+	{
+		return m_entries_per_row;
+	}
+
+	int row_count() const
+	{
+		return m_row_count;
+	}
+
+	unsigned width_in_pixels() const
+	{
+		return m_entries_per_row * 8;
+	}
+
+	unsigned height_in_pixels() const
+	{
+		return m_row_count * 8;
+	}
+
+	// row_number & entry_number are zero-based, both are wrapped around plane dimensions
+	name_table_entry get(int row_number, int entry_number)
+	{
+		std::size_t index = std::size_t(row_number & (m_row_count - 1)) * m_entries_per_row;
+		index += entry_number & (m_entries_per_row - 1);
+
+		std::size_t block = index / entries_per_block;
+		if(m_block_generations[block] != vram.pattern_generation(vram_pattern(block)))
+			decode_block(block);
+
+		return m_entries[index];
+	}
+
+private:
+	// every 32-bytes VRAM block holds 16 entries
+	static const std::size_t entries_per_block = vram_t::pattern_size / sizeof(std::uint16_t);
+
+	std::uint32_t vram_pattern(std::size_t block) const
+	{
+		// table wraps around VRAM
+		return (m_plane_pattern + std::uint32_t(block)) % vram_t::num_patterns;
+	}
+
+	void decode_block(std::size_t block)
+	{
+		std::uint32_t pattern = vram_pattern(block);
+		std::uint32_t address = pattern * vram_t::pattern_size;
+
+		auto it = m_entries.begin() + block * entries_per_block;
+		for(std::size_t i = 0; i < entries_per_block; ++i, address += sizeof(std::uint16_t))
+			*it++ = vram.read<std::uint16_t>(address);
+
+		m_block_generations[block] = vram.pattern_generation(pattern);
+	}
+
+	// all registers the plane geometry depends on
+	std::array<std::uint8_t, 5> registers_key() const
+	{
+		return {regs.get_register(2), regs.get_register(3), regs.get_register(4), regs.get_register(12),
+				regs.get_register(16)};
+	}
+
+private:
+	plane_type plane;
+	genesis::vdp::register_set& regs;
+	genesis::vdp::settings& sett;
+	genesis::vdp::vram_t& vram;
+
+	std::array<std::uint8_t, 5> m_key{};
+	std::uint32_t m_plane_pattern = 0;
+	int m_entries_per_row = 0;
+	int m_row_count = 0;
+
+	std::vector<name_table_entry> m_entries;
+
+	// VRAM pattern generation each block of entries was decoded from
+	std::vector<std::uint64_t> m_block_generations;
+};
+
+} // namespace genesis::vdp::impl
+
+#endif // __VDP_IMPL_PLANE_CACHE_H__
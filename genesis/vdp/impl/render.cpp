@@ -15,7 +15,9 @@ const auto PIXELS_IN_TAILE_COL = 8;
 
 render::render(genesis::vdp::register_set& regs, genesis::vdp::settings& sett, genesis::vdp::vram_t& vram,
 			   genesis::vdp::vsram_t& vsram, genesis::vdp::cram_t& cram)
-	: regs(regs), sett(sett), vram(vram), vsram(vsram), cram(cram)
+	: regs(regs), sett(sett), vram(vram), vsram(vsram), cram(cram), tiles(vram),
+	  plane_a_cache(plane_type::a, regs, sett, vram), plane_b_cache(plane_type::b, regs, sett, vram),
+	  window_cache(plane_type::w, regs, sett, vram), sat_cache(regs, sett, vram)
 {
 }
 
@@ -26,16 +28,16 @@ output_color render::background_color() const
 
 unsigned render::plane_width_in_pixels(plane_type plane_type) const
 {
-	name_table table(plane_type, sett, vram);
-	// as each entry represent 1 tail which is 8 pixeles width
-	return table.entries_per_row() * 8;
+	plane_cache& table = cached_plane(plane_type);
+	table.update();
+	return table.width_in_pixels();
 }
 
 unsigned render::plane_height_in_pixels(plane_type plane_type) const
 {
-	name_table table(plane_type, sett, vram);
-	// as each row is 1 tail height
-	return table.row_count() * 8;
+	plane_cache& table = cached_plane(plane_type);
+	table.update();
+	return table.height_in_pixels();
 }
 
 unsigned render::active_display_width() const
@@ -51,27 +53,30 @@ unsigned render::active_display_height() const
 std::span<genesis::vdp::output_color> render::get_plane_row(impl::plane_type plane_type, unsigned row_number,
 															std::span<genesis::vdp::output_color> buffer) const
 {
-	std::size_t buffer_size = plane_width_in_pixels(plane_type);
+	plane_cache& table = cached_plane(plane_type);
+	table.update();
+
+	std::size_t buffer_size = table.width_in_pixels();
 	check_buffer_size(buffer, buffer_size);
 
-	if(row_number >= plane_height_in_pixels(plane_type))
+	if(row_number >= table.height_in_pixels())
 		throw std::invalid_argument("provided invalid row_number");
 
-	name_table table(plane_type, sett, vram);
 	const auto tail_row_number = row_number / PIXELS_IN_TAILE_COL;
 	const auto pattern_row = row_number % PIXELS_IN_TAILE_COL;
+	const auto& colors = cram.colors_table();
 
 	buffer = std::span<genesis::vdp::output_color>(buffer.begin(), buffer_size);
 	auto buffer_it = buffer.begin();
 
 	for(int i = 0; i < table.entries_per_row(); ++i)
 	{
-		auto entry = table.get(tail_row_number, i);
-
-		auto on_pixel_read = [&](int color_id) { *(buffer_it++) = read_color(entry.palette, color_id); };
+		name_table_entry entry = table.get(tail_row_number, i);
 
-		read_pattern_line(pattern_row, entry.effective_pattern_address(), entry.horizontal_flip, entry.vertical_flip,
-						  on_pixel_read);
+		const std::uint8_t* pixels =
+			tiles.line(entry.effective_pattern_address(), pattern_row, entry.horizontal_flip, entry.vertical_flip);
+		for(int px = 0; px < 8; ++px)
+			*(buffer_it++) = pixels[px] == 0 ? vdp::TRANSPARENT_COLOR : colors[entry.palette * 16 + pixels[px]];
 	}
 
 	assert(buffer_it == buffer.end());
@@ -87,28 +92,16 @@ std::span<genesis::vdp::output_color> render::get_sprite_row(unsigned row_number
 	buffer = std::span<vdp::output_color>(buffer.begin(), buffer_size);
 	std::fill(buffer.begin(), buffer.end(), TRANSPARENT_COLOR);
 
-	sprite_table stable(sett, vram);
-
-	int sprite_number = 0;
-	for(int i = 0; i < stable.num_entries(); ++i)
-	{
-		auto entry = stable.get(sprite_number);
-
-		if(should_render_sprite(row_number, entry.vertical_position, entry.vertical_size))
-		{
-			read_sprite(row_number, entry, buffer);
-		}
-
-		sprite_number = entry.link;
-		if(sprite_number == 0 || sprite_number >= stable.num_entries())
-			break;
-	}
+	sat_cache.update();
+	for(auto position : sat_cache.line_sprites(row_number))
+		read_sprite(row_number, sat_cache.entry(position), buffer);
 
 	return buffer;
 }
 
-std::span<genesis::vdp::output_color> render::get_active_display_row(unsigned row_number,
-																	 std::span<genesis::vdp::output_color> buffer)
+template <class Pixel, std::size_t N>
+std::span<Pixel> render::compose_active_display_row(unsigned row_number, std::span<Pixel> buffer,
+													const std::array<Pixel, N>& colors)
 {
 	if(row_number >= active_display_height())
 		throw std::invalid_argument("row_number exceeds active display height");
@@ -123,34 +116,62 @@ std::span<genesis::vdp::output_color> render::get_active_display_row(unsigned ro
 
 	render_active_window_row(row_number, a_buffer);
 
-	vdp::output_color bg_color = background_color();
+	const std::uint8_t bg_index = (std::uint8_t)(regs.R7.PAL * 16 + regs.R7.COL);
 
-	buffer = std::span<genesis::vdp::output_color>(buffer.begin(), buffer_size);
-	for(std::size_t i = 0; i < buffer.size(); ++i)
-	{
-		buffer[i] = resolve_priority(bg_color, a_buffer[i], b_buffer[i], sprites[i]);
-	}
+	buffer = std::span<Pixel>(buffer.begin(), buffer_size);
+	layers_compositor.compose(a_buffer, b_buffer, sprites, bg_index, colors, buffer);
 
 	return buffer;
 }
 
+std::span<genesis::vdp::output_color> render::get_active_display_row(unsigned row_number,
+																	 std::span<genesis::vdp::output_color> buffer)
+{
+	return compose_active_display_row(row_number, buffer, cram.colors_table());
+}
+
+std::span<std::uint32_t> render::get_active_display_row_argb8888(unsigned row_number, std::span<std::uint32_t> buffer)
+{
+	return compose_active_display_row(row_number, buffer, cram.host_colors_argb8888());
+}
+
+std::span<std::uint16_t> render::get_active_display_row_rgb565(unsigned row_number, std::span<std::uint16_t> buffer)
+{
+	return compose_active_display_row(row_number, buffer, cram.host_colors_rgb565());
+}
+
+void render::update_sprite_status(unsigned row_number)
+{
+	if(row_number >= active_display_height())
+		throw std::invalid_argument("row_number exceeds active display height");
+
+	get_active_sprites_row(row_number, sprite_buffer);
+}
+
 void render::reset_limits()
 {
 }
 
-std::span<render::internal_pixel> render::get_active_plane_row(plane_type plane_type, unsigned row_number,
-															   std::span<render::internal_pixel> buffer) const
+std::span<internal_pixel> render::get_active_plane_row(plane_type plane_type, unsigned row_number,
+													   std::span<internal_pixel> buffer) const
 {
 	const std::size_t buffer_size = active_display_width() + 8 /* room for one more tail */;
 	assert(buffer_size <= buffer.size());
 
-	unsigned max_height = plane_height_in_pixels(plane_type);
+	plane_cache& table = cached_plane(plane_type);
+	table.update();
 
-	name_table table(plane_type, sett, vram);
+	unsigned max_height = table.height_in_pixels();
 
 	hscroll_table hscroll(plane_type, sett, vram);
 	int hoffset = hscroll.get_offset(row_number);
 
+	// vertical scrolling offsets of 2-cell strips (there is a single strip in full screen mode)
+	std::array<int, vscroll_table::max_strips> strip_voffsets;
+	int num_strips = vscroll_table::num_strips(sett);
+	for(int strip = 0; strip < num_strips; ++strip)
+		strip_voffsets[strip] = vscroll_table::get_offset(plane_type, strip * 2, sett, vsram);
+
 	// ceiling division by 8
 	int tail_hoffset = (hoffset + 7) / 8;
 
@@ -165,7 +186,7 @@ std::span<render::internal_pixel> render::get_active_plane_row(plane_type plane_
 		int tail_column_number = (tail + tail_hoffset) & (table.entries_per_row() - 1);
 
 		// apply vertical scrolling just by changing row_number
-		int voffset = vscroll_table::get_offset(plane_type, tail_column_number, sett, vsram);
+		int voffset = strip_voffsets[(tail_column_number >> 1) % num_strips];
 		int shifted_row_number = (row_number + voffset) & (max_height - 1);
 
 		int tail_row_number = shifted_row_number / PIXELS_IN_TAILE_COL;
@@ -173,10 +194,11 @@ std::span<render::internal_pixel> render::get_active_plane_row(plane_type plane_
 
 		name_table_entry entry = table.get(tail_row_number, tail_column_number);
 
-		auto on_pixel_read = [&](int color_id) { *(buffer_it++) = {entry.palette, color_id, entry.priority == 1}; };
-
-		read_pattern_line(tail_row, entry.effective_pattern_address(), entry.horizontal_flip, entry.vertical_flip,
-						  on_pixel_read);
+		const std::uint8_t* pixels =
+			tiles.line(entry.effective_pattern_address(), tail_row, entry.horizontal_flip, entry.vertical_flip);
+		const bool priority = entry.priority == 1;
+		for(int i = 0; i < 8; ++i)
+			*(buffer_it++) = {entry.palette, pixels[i], priority};
 	}
 
 	// apply horizontal-pixel scrolling
@@ -185,7 +207,7 @@ std::span<render::internal_pixel> render::get_active_plane_row(plane_type plane_
 		hpixel_offset = 8 - (hoffset % 8);
 
 	// sometimes plane width can be less then active display width, do the tail-based padding in this case
-	if(plane_width_in_pixels(plane_type) < active_display_width())
+	if(table.width_in_pixels() < active_display_width())
 	{
 		auto begin = buffer.begin() + (hpixel_offset == 0 ? 0 : 8); // skip the first tail if needed
 		auto end = buffer.begin() + hpixel_offset + active_display_width();
@@ -200,7 +222,7 @@ std::span<render::internal_pixel> render::get_active_plane_row(plane_type plane_
 }
 
 // render active window in plane a buffer (effectively overwriting plane a)
-void render::render_active_window_row(unsigned line_number, std::span<render::internal_pixel> plane_a_buffer) const
+void render::render_active_window_row(unsigned line_number, std::span<internal_pixel> plane_a_buffer) const
 {
 	const std::size_t buffer_size = active_display_width();
 	assert(plane_a_buffer.size() == buffer_size);
@@ -237,25 +259,39 @@ void render::render_active_window_row(unsigned line_number, std::span<render::in
 	if(start_position >= buffer_size)
 		return;
 
-	name_table table(plane_type::w, sett, vram);
+	window_cache.update();
 
 	auto buffer_it = std::next(plane_a_buffer.begin(), start_position);
 	for(int col = start_col; col < end_col; ++col)
 	{
-		name_table_entry entry = table.get(tail_row, col);
-
-		auto on_pixel_read = [&](int color_id) { *(buffer_it++) = {entry.palette, color_id, true}; };
+		name_table_entry entry = window_cache.get(tail_row, col);
 
-		read_pattern_line(line_number % 8, entry.effective_pattern_address(), entry.horizontal_flip,
-						  entry.vertical_flip, on_pixel_read);
+		const std::uint8_t* pixels =
+			tiles.line(entry.effective_pattern_address(), line_number % 8, entry.horizontal_flip, entry.vertical_flip);
+		for(int i = 0; i < 8; ++i)
+			*(buffer_it++) = {entry.palette, pixels[i], true};
 	}
 
 	assert(buffer_it == plane_a_buffer.end());
 }
 
+plane_cache& render::cached_plane(plane_type plane_type) const
+{
+	switch(plane_type)
+	{
+	case plane_type::a:
+		return plane_a_cache;
+	case plane_type::b:
+		return plane_b_cache;
+	case plane_type::w:
+		return window_cache;
+	default:
+		throw internal_error();
+	}
+}
+
 // Rename to render_active_sprite_line
-std::span<render::internal_pixel> render::get_active_sprites_row(unsigned line_number,
-																 std::span<render::internal_pixel> buffer)
+std::span<internal_pixel> render::get_active_sprites_row(unsigned line_number, std::span<internal_pixel> buffer)
 {
 	const std::size_t buffer_size = sprite_width_in_pixels();
 	assert(buffer_size <= buffer.size());
@@ -272,48 +308,41 @@ std::span<render::internal_pixel> render::get_active_sprites_row(unsigned line_n
 	std::fill(buffer.begin(), buffer.end(), transparent);
 
 	sprites_limits_tracker sprites_limits(sett);
-	sprite_table stable(sett, vram);
+	sat_cache.update();
 
-	int sprite_number = 0;
 	unsigned rendered_sprites = 0;
 	bool masked = false;
-	for(int i = 0; i < stable.num_entries(); ++i)
+	for(auto position : sat_cache.line_sprites(line_number))
 	{
-		// check limits
-		if(sprites_limits.line_limit_exceeded())
+		const auto& entry = sat_cache.entry(position);
+
+		// Sprite masking
+		if(entry.horizontal_position == 0 && (rendered_sprites > 0 || prev_line_overflow))
 		{
-			regs.SR.SO = 1;
-			break;
+			// All other sprites should be masked
+			masked = true;
 		}
 
-		auto entry = stable.get(sprite_number);
+		if(entry.horizontal_position != 0)
+			++rendered_sprites;
 
-		if(should_render_sprite(line_number, entry.vertical_position, entry.vertical_size))
+		if(masked == false)
 		{
-			// Sprite masking
-			if(entry.horizontal_position == 0 && (rendered_sprites > 0 || prev_line_overflow))
-			{
-				// All other sprites should be masked
-				masked = true;
-			}
-
-			if(entry.horizontal_position != 0)
-				++rendered_sprites;
-
-			if(masked == false)
-			{
-				bool collision = read_sprite(line_number, entry, buffer, sprites_limits.line_pixels_limit());
-				if(collision)
-					regs.SR.SC = 1;
-			}
-
-			// Keep tracking limits to correctly set Sprite Overflow (SO) flag
-			sprites_limits.on_sprite_draw(entry);
+			bool collision = read_sprite(line_number, entry, buffer, sprites_limits.line_pixels_limit());
+			if(collision)
+				regs.SR.SC = 1;
 		}
 
-		sprite_number = entry.link;
-		if(sprite_number == 0 || sprite_number >= stable.num_entries())
+		// Keep tracking limits to correctly set Sprite Overflow (SO) flag
+		sprites_limits.on_sprite_draw(entry);
+
+		// overflow is reported only if there are more sprites in the link chain (even not on this line)
+		if(sprites_limits.line_limit_exceeded())
+		{
+			if(position + 1u < sat_cache.chain_length())
+				regs.SR.SO = 1;
 			break;
+		}
 	}
 
 	// sprites on active display starts on 128 position
@@ -321,45 +350,6 @@ std::span<render::internal_pixel> render::get_active_sprites_row(unsigned line_n
 	return std::span<internal_pixel>(first_it, active_display_width());
 }
 
-genesis::vdp::output_color render::resolve_priority(genesis::vdp::output_color background_color, internal_pixel plane_a,
-													internal_pixel plane_b, internal_pixel sprite) const
-{
-	if(sprite.transparent())
-	{
-		// check only a/b
-		if(plane_a.transparent())
-		{
-			// check only b
-			if(plane_b.transparent())
-				return background_color;
-			return read_color(plane_b.palette_id, plane_b.color_id);
-		}
-		else if(plane_a.priority)
-		{
-			return read_color(plane_a.palette_id, plane_a.color_id);
-		}
-		else
-		{
-			if(plane_b.priority && !plane_b.transparent())
-				return read_color(plane_b.palette_id, plane_b.color_id);
-			return read_color(plane_a.palette_id, plane_a.color_id);
-		}
-	}
-	else if(sprite.priority)
-	{
-		return read_color(sprite.palette_id, sprite.color_id);
-	}
-	else
-	{
-		// check a/b
-		if(plane_a.priority && !plane_a.transparent())
-			return read_color(plane_a.palette_id, plane_a.color_id);
-		if(plane_b.priority && !plane_b.transparent())
-			return read_color(plane_b.palette_id, plane_b.color_id);
-		return read_color(sprite.palette_id, sprite.color_id);
-	}
-}
-
 // shouldn't be used for background color
 vdp::output_color render::read_color(unsigned palette_idx, unsigned color_idx) const
 {
@@ -368,12 +358,6 @@ vdp::output_color render::read_color(unsigned palette_idx, unsigned color_idx) c
 	return cram.read_color(palette_idx, color_idx);
 }
 
-bool render::should_render_sprite(unsigned row_number, unsigned vertical_position, unsigned vertical_size) const
-{
-	unsigned last_vert_pos = vertical_position + ((vertical_size + 1) * 8);
-	return vertical_position <= row_number && row_number < last_vert_pos;
-}
-
 void render::read_sprite(unsigned row_number, const sprite_table_entry& entry, std::span<vdp::output_color> dest) const
 {
 	check_buffer_size(dest, entry.horizontal_position);
@@ -406,7 +390,7 @@ void render::read_sprite(unsigned row_number, const sprite_table_entry& entry, s
 	assert((std::size_t)std::distance(dest.begin(), dest_it) <= dest.size());
 }
 
-bool render::read_sprite(unsigned row_number, const sprite_table_entry& entry, std::span<render::internal_pixel> dest,
+bool render::read_sprite(unsigned row_number, const sprite_table_entry& entry, std::span<internal_pixel> dest,
 						 unsigned pixels_limit) const
 {
 	check_buffer_size(dest, entry.horizontal_position);
@@ -417,18 +401,22 @@ bool render::read_sprite(unsigned row_number, const sprite_table_entry& entry, s
 
 	bool collision = false;
 
-	if(pixels_limit == 0)
+	if(pixels_limit == 0 || dest_it == dest.end())
 		return collision;
 
-	bool read_more = true;
-	auto on_pixel_read = [&](int color_id) {
-		if(read_more)
+	for(int i = 0; i <= entry.horizontal_size; ++i)
+	{
+		std::uint32_t pattern_addr = sprite_pattern_address(row_number, i, entry);
+		const std::uint8_t* pixels =
+			tiles.line(pattern_addr, pattern_row_number, entry.horizontal_flip, entry.vertical_flip);
+
+		for(int pixel = 0; pixel < 8; ++pixel)
 		{
 			if(dest_it->transparent())
 			{
-				*dest_it = {entry.palette, color_id, entry.priority_flag};
+				*dest_it = {entry.palette, pixels[pixel], entry.priority_flag};
 			}
-			else if(color_id != 0)
+			else if(pixels[pixel] != 0)
 			{
 				collision = true;
 			}
@@ -438,18 +426,10 @@ bool render::read_sprite(unsigned row_number, const sprite_table_entry& entry, s
 			++dest_it;
 
 			if(dest_it == dest.end() || pixels_limit == 0)
-				read_more = false;
+				return collision;
 		}
-	};
-
-	for(int i = 0; read_more && i <= entry.horizontal_size; ++i)
-	{
-		std::uint32_t pattern_addr = sprite_pattern_address(row_number, i, entry);
-
-		read_pattern_line(pattern_row_number, pattern_addr, entry.horizontal_flip, entry.vertical_flip, on_pixel_read);
 	}
 
-	assert((std::size_t)std::distance(dest.begin(), dest_it) <= dest.size());
 	return collision;
 }
 
@@ -1,8 +1,13 @@
 #ifndef __VDP_IMPL_RENDER_H__
 #define __VDP_IMPL_RENDER_H__
 
+#include "compositor.h"
+#include "internal_pixel.h"
 #include "name_table.h"
+#include "plane_cache.h"
+#include "sprite_cache.h"
 #include "sprite_table.h"
+#include "tile_cache.h"
 #include "vdp/memory.h"
 #include "vdp/output_color.h"
 #include "vdp/register_set.h"
@@ -56,74 +61,35 @@ public:
 	std::span<genesis::vdp::output_color> get_active_display_row(unsigned row_number,
 																 std::span<genesis::vdp::output_color> buffer);
 
+	// render active display row in the host pixel format
+	std::span<std::uint32_t> get_active_display_row_argb8888(unsigned row_number, std::span<std::uint32_t> buffer);
+	std::span<std::uint16_t> get_active_display_row_rgb565(unsigned row_number, std::span<std::uint16_t> buffer);
+
+	// update sprites overflow/collision flags as if the active display row was rendered
+	void update_sprite_status(unsigned row_number);
+
 	// should be called when VDP starts rendering new frame
 	void reset_limits();
 
 private:
-	// the actual pixel produced by vdp does not have priority or transparency,
-	// but these properties are required to build the vdp frame,
-	// so use different pixel representation for internal purposes
-	struct internal_pixel
-	{
-		internal_pixel()
-		{
-			palette_id = color_id = priority = 0;
-		}
-
-		internal_pixel(int p, int c, bool pr)
-		{
-			palette_id = (std::uint8_t)p;
-			color_id = (std::uint8_t)c;
-			priority = pr;
-		}
-
-		std::uint8_t palette_id : 2;
-		std::uint8_t color_id : 4;
-
-		// only tails have priority, but it would be easier to assign each pixel a priority
-		bool priority : 1;
-
-		// pixel is transparent if color_id is 0
-		bool transparent() const
-		{
-			return color_id == 0;
-		}
-	};
-
-	static_assert(sizeof(internal_pixel) == 1);
-
 	// line_number - zero based
 	template <class Callable>
 	void read_pattern_line(unsigned line_number, std::uint32_t pattern_addres, bool hflip, bool vflip,
 						   Callable on_pixel_read) const
 	{
-		assert(line_number < 8);
-
-		if(vflip)
-			line_number = 7 - line_number;
-
-		pattern_addres += line_number * 0x4 /* single line occupies 4 bytes */;
-		std::uint32_t raw_line = vram.read_raw<std::uint32_t>(pattern_addres);
-
-		if(hflip)
-		{
-			constexpr std::array<int, 8> offsets = {24, 28, 16, 20, 8, 12, 0, 4};
-			for(int offset : offsets)
-				on_pixel_read((raw_line >> offset) & 0xF);
-		}
-		else
-		{
-			constexpr std::array<int, 8> offsets = {4, 0, 12, 8, 20, 16, 28, 24};
-			for(int offset : offsets)
-				on_pixel_read((raw_line >> offset) & 0xF);
-		}
+		const std::uint8_t* pixels = tiles.line(pattern_addres, line_number, hflip, vflip);
+		for(int i = 0; i < 8; ++i)
+			on_pixel_read(pixels[i]);
 	}
 
 	vdp::output_color read_color(unsigned palette_idx, unsigned color_idx) const;
 
+	template <class Pixel, std::size_t N>
+	std::span<Pixel> compose_active_display_row(unsigned row_number, std::span<Pixel> buffer,
+												const std::array<Pixel, N>& colors);
+
 	/* Sprites helpers */
 	std::span<internal_pixel> get_active_sprites_row(unsigned row_number, std::span<internal_pixel> buffer);
-	bool should_render_sprite(unsigned row_number, unsigned vertical_position, unsigned vertical_size) const;
 
 	// For performance reason it better to duplicate these functions
 	void read_sprite(unsigned row_number, const sprite_table_entry& entry, std::span<vdp::output_color> buffer) const;
@@ -142,8 +108,7 @@ private:
 
 	void render_active_window_row(unsigned line_number, std::span<internal_pixel> plane_a_buffer) const;
 
-	genesis::vdp::output_color resolve_priority(genesis::vdp::output_color background_color, internal_pixel plane_a,
-												internal_pixel plane_b, internal_pixel sprite) const;
+	plane_cache& cached_plane(plane_type plane_type) const;
 
 	/* internal buffers used during rendering */
 
@@ -169,6 +134,13 @@ private:
 	genesis::vdp::vram_t& vram;
 	genesis::vdp::vsram_t& vsram;
 	genesis::vdp::cram_t& cram;
+
+	mutable tile_cache tiles;
+	mutable plane_cache plane_a_cache;
+	mutable plane_cache plane_b_cache;
+	mutable plane_cache window_cache;
+	mutable sprite_cache sat_cache;
+	compositor layers_compositor;
 };
 
 } // namespace genesis::vdp::impl
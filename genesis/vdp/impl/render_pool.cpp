@@ -0,0 +1,275 @@
+#include "render_pool.h"
+
+#include "exception.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+
+namespace genesis::vdp::impl
+{
+
+void render_pool::line_context::restore(const line_state_log& log, const line_state& state)
+{
+	for(std::size_t reg = 0; reg < state.registers.size(); ++reg)
+		regs.set_register(static_cast<int>(reg), state.registers[reg]);
+	regs.sr_raw = state.status;
+
+	// memories are restored only if the line refers to another snapshot
+	const bool same_log = this->log == &log && log_id == log.id();
+
+	// VRAM is rebuilt from the base and deltas, so it can only move forward from the restored version
+	std::uint32_t restored_vram = vram_version;
+	if(!same_log)
+	{
+		vram.restore(log.vram_base());
+		restored_vram = 0;
+	}
+	else if(state.vram_version < vram_version)
+	{
+		// only patterns modified by the applied deltas may differ from the base
+		vram_t::pattern_set patterns;
+		for(std::uint32_t version = 1; version <= vram_version; ++version)
+			patterns |= log.vram_delta(version);
+		vram.restore(log.vram_base(), patterns);
+		restored_vram = 0;
+	}
+
+	for(std::uint32_t version = restored_vram + 1; version <= state.vram_version; ++version)
+		vram.restore(log.vram_delta(version), log.vram_patterns(version));
+
+	if(!same_log || cram_version != state.cram_version)
+	{
+		const auto& snapshot = log.cram(state.cram_version);
+		for(std::uint16_t i = 0; i < snapshot.size(); ++i)
+			cram.write(i * 2, snapshot[i]);
+	}
+
+	if(!same_log || vsram_version != state.vsram_version)
+	{
+		const auto& snapshot = log.vsram(state.vsram_version);
+		for(std::uint16_t i = 0; i < snapshot.size(); ++i)
+			vsram.write(i * 2, snapshot[i]);
+	}
+
+	this->log = &log;
+	log_id = log.id();
+	vram_version = state.vram_version;
+	cram_version = state.cram_version;
+	vsram_version = state.vsram_version;
+}
+
+render_pool::render_pool(unsigned threads)
+{
+	if(threads == 0)
+		throw std::invalid_argument("threads");
+
+	for(unsigned i = 0; i < threads; ++i)
+	{
+		m_workers.push_back(std::make_unique<worker>());
+		m_workers.back()->lines = line_range{0, 0, 0}.pack();
+	}
+
+	// start threads once all workers exist, as they look into each other for lines to steal
+	for(auto& w : m_workers)
+		w->thread = std::thread([this, &self = *w]() { run(self); });
+}
+
+render_pool::~render_pool()
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+
+	for(auto& w : m_workers)
+		w->thread.join();
+}
+
+void render_pool::render(const line_state_log& log, genesis::vdp::framebuffer& fb, std::function<void()> on_complete)
+{
+	wait();
+
+	const auto lines = static_cast<std::uint32_t>(log.lines().size());
+	if(lines == 0)
+	{
+		if(on_complete)
+			on_complete();
+		return;
+	}
+
+	m_log = &log;
+	m_framebuffer = &fb;
+	m_on_complete = std::move(on_complete);
+	m_remaining.store(lines, std::memory_order_relaxed);
+
+	// equal shares, the first workers get one more line if lines cannot be divided evenly
+	++m_epoch;
+	const auto threads = static_cast<std::uint32_t>(m_workers.size());
+	std::uint32_t first = 0;
+	for(std::uint32_t i = 0; i < threads; ++i)
+	{
+		std::uint32_t share = lines / threads + (i < lines % threads ? 1 : 0);
+		m_workers[i]->lines.store(line_range{m_epoch, first, first + share}.pack(), std::memory_order_release);
+		first += share;
+	}
+
+	{
+		std::lock_guard lock(m_mutex);
+		m_busy = true;
+		++m_frame;
+	}
+	m_cv.notify_all();
+}
+
+void render_pool::wait()
+{
+	std::unique_lock lock(m_mutex);
+	m_cv.wait(lock, [this]() { return !m_busy; });
+
+	if(m_exception != nullptr)
+		std::rethrow_exception(std::exchange(m_exception, nullptr));
+}
+
+void render_pool::run(worker& self)
+{
+	std::uint64_t seen_frame = 0;
+	while(true)
+	{
+		{
+			std::unique_lock lock(m_mutex);
+			m_cv.wait(lock, [&]() { return m_stop || m_frame != seen_frame; });
+			if(m_stop)
+				return;
+			seen_frame = m_frame;
+		}
+
+		do
+		{
+			std::uint32_t line;
+			while(pop(self, line))
+			{
+				render_line(self.context, line);
+				on_line_rendered();
+			}
+		} while(steal(self));
+	}
+}
+
+bool render_pool::pop(worker& self, std::uint32_t& line)
+{
+	std::uint64_t packed = self.lines.load(std::memory_order_acquire);
+	while(true)
+	{
+		const auto range = line_range::unpack(packed);
+		if(range.first >= range.last)
+			return false;
+
+		if(self.lines.compare_exchange_weak(packed, line_range{range.epoch, range.first + 1, range.last}.pack(),
+											std::memory_order_acq_rel))
+		{
+			line = range.first;
+			return true;
+		}
+	}
+}
+
+// returns false if there is nothing to steal
+bool render_pool::steal(worker& self)
+{
+	// Only the frame of the own (empty) range may be stolen from. Nobody but render() changes an empty range,
+	// and render() cannot start the next frame while the stolen lines are not rendered yet.
+	const auto own = line_range::unpack(self.lines.load(std::memory_order_acquire));
+	if(own.first < own.last)
+		return true;
+
+	// the busiest worker is the victim
+	worker* victim = nullptr;
+	std::uint64_t packed = 0;
+	std::uint32_t max_remaining = 0;
+	for(auto& w : m_workers)
+	{
+		if(w.get() == &self)
+			continue;
+
+		std::uint64_t p = w->lines.load(std::memory_order_acquire);
+		const auto r = line_range::unpack(p);
+		if(r.epoch == own.epoch && r.first < r.last && r.last - r.first > max_remaining)
+		{
+			victim = w.get();
+			packed = p;
+			max_remaining = r.last - r.first;
+		}
+	}
+
+	if(victim == nullptr)
+		return false;
+
+	while(true)
+	{
+		const auto range = line_range::unpack(packed);
+		if(range.epoch != own.epoch || range.first >= range.last)
+		{
+			// the victim is done meanwhile or the next frame has started, look again
+			return true;
+		}
+
+		// take the second half (the owner pops from the front)
+		const std::uint32_t take = (range.last - range.first + 1) / 2;
+		const line_range left{range.epoch, range.first, range.last - take};
+		if(victim->lines.compare_exchange_weak(packed, left.pack(), std::memory_order_acq_rel))
+		{
+			self.lines.store(line_range{range.epoch, range.last - take, range.last}.pack(), std::memory_order_release);
+			return true;
+		}
+	}
+}
+
+void render_pool::render_line(line_context& context, std::uint32_t line)
+{
+	try
+	{
+		const auto& state = m_log->lines()[line];
+		context.restore(*m_log, state);
+
+		switch(m_framebuffer->format())
+		{
+		case pixel_format::argb8888:
+			context.rend.get_active_display_row_argb8888(state.line,
+														 m_framebuffer->back_row<std::uint32_t>(state.line));
+			break;
+
+		case pixel_format::rgb565:
+			context.rend.get_active_display_row_rgb565(state.line, m_framebuffer->back_row<std::uint16_t>(state.line));
+			break;
+
+		default:
+			throw internal_error();
+		}
+	}
+	catch(...)
+	{
+		std::lock_guard lock(m_mutex);
+		if(m_exception == nullptr)
+			m_exception = std::current_exception();
+	}
+}
+
+void render_pool::on_line_rendered()
+{
+	if(m_remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	// the last line of the frame
+	if(m_on_complete)
+		m_on_complete();
+
+	{
+		std::lock_guard lock(m_mutex);
+		m_busy = false;
+	}
+	m_cv.notify_all();
+}
+
+} // namespace genesis::vdp::impl
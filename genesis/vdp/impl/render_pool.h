@@ -0,0 +1,138 @@
+#ifndef __VDP_IMPL_RENDER_POOL_H__
+#define __VDP_IMPL_RENDER_POOL_H__
+
+#include "line_state_log.h"
+#include "render.h"
+#include "vdp/framebuffer.h"
+#include "vdp/memory.h"
+#include "vdp/register_set.h"
+#include "vdp/settings.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace genesis::vdp::impl
+{
+
+/* Renders lines of the completed frame from the line state log across worker threads.
+ * Each worker starts with an equal share of lines and steals half of the remaining lines
+ * of the busiest worker once its own share is done.
+ *
+ * Only one frame is rendered at a time, render() and wait() must be called by the same (producer) thread. */
+class render_pool
+{
+public:
+	// throws std::invalid_argument if threads is 0
+	render_pool(unsigned threads);
+	~render_pool();
+
+	render_pool(const render_pool&) = delete;
+	render_pool& operator=(const render_pool&) = delete;
+
+	unsigned threads() const
+	{
+		return static_cast<unsigned>(m_workers.size());
+	}
+
+	/* Start rendering logged lines into the back buffer of the framebuffer and return immediately.
+	 * on_complete is called by the last worker once all lines are rendered.
+	 * Waits for the previous frame first, log and framebuffer must not be modified till the frame is rendered. */
+	void render(const line_state_log& log, genesis::vdp::framebuffer& fb, std::function<void()> on_complete);
+
+	// wait till the current frame is rendered, rethrows an exception if any worker failed
+	void wait();
+
+private:
+	// private copy of VDP state to render lines from
+	struct line_context
+	{
+		line_context() : sett(regs), rend(regs, sett, vram, vsram, cram)
+		{
+		}
+
+		void restore(const line_state_log& log, const line_state& state);
+
+		genesis::vdp::register_set regs;
+		genesis::vdp::settings sett;
+		genesis::vdp::vram_t vram;
+		genesis::vdp::vsram_t vsram;
+		genesis::vdp::cram_t cram;
+		impl::render rend;
+
+		// versions restored last time
+		const line_state_log* log = nullptr;
+		std::uint64_t log_id = 0;
+		std::uint32_t vram_version = 0;
+		std::uint32_t cram_version = 0;
+		std::uint32_t vsram_version = 0;
+	};
+
+	struct worker
+	{
+		line_context context;
+
+		// [first; last) range of lines of the frame, packed into a single word, so it can be updated atomically
+		std::atomic<std::uint64_t> lines;
+
+		std::thread thread;
+	};
+
+	/* Every frame gives workers the same shares, so the range is tagged with the frame epoch.
+	 * Otherwise a stealer preempted in one frame could take over a range of the next one. */
+	struct line_range
+	{
+		std::uint16_t epoch;
+		std::uint32_t first;
+		std::uint32_t last;
+
+		std::uint64_t pack() const
+		{
+			return (std::uint64_t(epoch) << 48) | (std::uint64_t(first & 0xFFFFFF) << 24) | (last & 0xFFFFFF);
+		}
+
+		static line_range unpack(std::uint64_t packed)
+		{
+			return {static_cast<std::uint16_t>(packed >> 48), static_cast<std::uint32_t>((packed >> 24) & 0xFFFFFF),
+					static_cast<std::uint32_t>(packed & 0xFFFFFF)};
+		}
+	};
+
+	void run(worker& self);
+
+	bool pop(worker& self, std::uint32_t& line);
+	bool steal(worker& self);
+
+	void render_line(line_context& context, std::uint32_t line);
+	void on_line_rendered();
+
+private:
+	std::vector<std::unique_ptr<worker>> m_workers;
+
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::uint64_t m_frame = 0;
+	std::uint16_t m_epoch = 0;
+	bool m_busy = false;
+	bool m_stop = false;
+
+	// the first exception thrown by workers, rethrown by wait()
+	std::exception_ptr m_exception;
+
+	// current frame
+	const line_state_log* m_log = nullptr;
+	genesis::vdp::framebuffer* m_framebuffer = nullptr;
+	std::function<void()> m_on_complete;
+	std::atomic<std::uint32_t> m_remaining = 0;
+};
+
+} // namespace genesis::vdp::impl
+
+#endif // __VDP_IMPL_RENDER_POOL_H__
@@ -0,0 +1,126 @@
+#ifndef __VDP_IMPL_SPRITE_CACHE_H__
+#define __VDP_IMPL_SPRITE_CACHE_H__
+
+#include "sprite_table.h"
+#include "vdp/memory.h"
+#include "vdp/register_set.h"
+#include "vdp/settings.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+
+namespace genesis::vdp::impl
+{
+
+/* Keeps sprite attribute table (SAT) decoded in the link order
+ * together with the lists of sprites intersecting each sprite plane line.
+ * Everything is rebuilt only when SAT content in VRAM or its location is changed. */
+class sprite_cache
+{
+public:
+	// sprite plane is 512 lines height
+	static const unsigned num_lines = 512;
+	static const unsigned max_sprites = 80;
+
+public:
+	sprite_cache(genesis::vdp::register_set& regs, genesis::vdp::settings& sett, genesis::vdp::vram_t& vram)
+		: regs(regs), sett(sett), vram(vram), m_line_sprites(num_lines * max_sprites)
+	{
+	}
+
+	// must be called before reading the sprites
+	void update()
+	{
+		auto key = registers_key();
+		bool changed = key != m_key;
+
+		sprite_table stable(sett, vram);
+		if(vram.modified_since(m_generation, sett.sprite_address(), stable.num_entries() * 8))
+			changed = true;
+
+		if(changed)
+		{
+			m_key = key;
+			rebuild();
+		}
+
+		m_generation = vram.generation();
+	}
+
+	// number of sprites in the link chain
+	std::size_t chain_length() const
+	{
+		return m_chain.size();
+	}
+
+	// position - zero-based position in the link chain
+	const sprite_table_entry& entry(std::size_t position) const
+	{
+		return m_chain[position];
+	}
+
+	// returns link chain positions of sprites intersecting the sprite plane line, in the link order
+	std::span<const std::uint8_t> line_sprites(unsigned line_number) const
+	{
+		if(line_number >= num_lines)
+			return {};
+
+		return std::span<const std::uint8_t>(m_line_sprites).subspan(line_number * max_sprites,
+																	 m_line_counts[line_number]);
+	}
+
+private:
+	void rebuild()
+	{
+		m_chain.clear();
+		m_line_counts.fill(0);
+
+		sprite_table stable(sett, vram);
+
+		int sprite_number = 0;
+		for(int i = 0; i < stable.num_entries(); ++i)
+		{
+			auto entry = stable.get(sprite_number);
+
+			const std::uint8_t position = (std::uint8_t)m_chain.size();
+			m_chain.push_back(entry);
+
+			unsigned first_line = entry.vertical_position;
+			unsigned last_line = std::min(first_line + (entry.vertical_size + 1) * 8, num_lines);
+			for(unsigned line = first_line; line < last_line; ++line)
+				m_line_sprites[line * max_sprites + m_line_counts[line]++] = position;
+
+			sprite_number = entry.link;
+			if(sprite_number == 0 || sprite_number >= stable.num_entries())
+				break;
+		}
+	}
+
+	// all registers SAT location and size depend on
+	std::array<std::uint8_t, 2> registers_key() const
+	{
+		return {regs.get_register(5), regs.get_register(12)};
+	}
+
+private:
+	genesis::vdp::register_set& regs;
+	genesis::vdp::settings& sett;
+	genesis::vdp::vram_t& vram;
+
+	std::array<std::uint8_t, 2> m_key{};
+
+	// VRAM generation the cache was checked against last time (0 - never built)
+	std::uint64_t m_generation = 0;
+
+	std::vector<sprite_table_entry> m_chain;
+	std::vector<std::uint8_t> m_line_sprites;
+	std::array<std::uint8_t, num_lines> m_line_counts{};
+};
+
+} // namespace genesis::vdp::impl
+
+#endif // __VDP_IMPL_SPRITE_CACHE_H__
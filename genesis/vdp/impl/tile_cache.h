@@ -0,0 +1,100 @@
+#ifndef __VDP_IMPL_TILE_CACHE_H__
+#define __VDP_IMPL_TILE_CACHE_H__
+
+#include "vdp/memory.h"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+
+namespace genesis::vdp::impl
+{
+
+/* Keeps VRAM patterns decoded to 8x8 color ids (one byte per pixel).
+ * Patterns are decoded on the first access after they were modified in VRAM,
+ * horizontally flipped variant is built only if it's requested. */
+class tile_cache
+{
+public:
+	tile_cache(genesis::vdp::vram_t& vram)
+		: vram(vram), normal(vram_t::num_patterns), hflipped(vram_t::num_patterns), valid(vram_t::num_patterns, 0),
+		  generations(vram_t::num_patterns, 0)
+	{
+	}
+
+	// returns 8 color ids of the pattern line (line_number - zero based)
+	const std::uint8_t* line(std::uint32_t pattern_address, unsigned line_number, bool hflip, bool vflip)
+	{
+		assert(line_number < 8);
+
+		if(vflip)
+			line_number = 7 - line_number;
+
+		// pattern address wraps around VRAM
+		std::uint32_t pattern = (pattern_address / vram_t::pattern_size) % vram_t::num_patterns;
+
+		const auto generation = vram.pattern_generation(pattern);
+		if(generations[pattern] != generation)
+		{
+			generations[pattern] = generation;
+			valid[pattern] = 0;
+		}
+
+		const std::uint8_t variant = hflip ? hflipped_valid : normal_valid;
+		if((valid[pattern] & variant) == 0)
+			decode(pattern, hflip);
+
+		const auto& pixels = hflip ? hflipped[pattern] : normal[pattern];
+		return pixels.data() + line_number * 8;
+	}
+
+private:
+	void decode(std::uint32_t pattern, bool hflip)
+	{
+		if((valid[pattern] & normal_valid) == 0)
+		{
+			// each byte holds 2 pixels, the left one is in the high nibble
+			std::uint32_t address = pattern * vram_t::pattern_size;
+			auto& pixels = normal[pattern];
+			for(std::uint32_t i = 0; i < vram_t::pattern_size; ++i)
+			{
+				std::uint8_t data = vram.read_raw<std::uint8_t>(address + i);
+				pixels[i * 2] = data >> 4;
+				pixels[i * 2 + 1] = data & 0xF;
+			}
+
+			valid[pattern] |= normal_valid;
+		}
+
+		if(hflip)
+		{
+			const auto& src = normal[pattern];
+			auto& dest = hflipped[pattern];
+			for(int row = 0; row < 8; ++row)
+				for(int col = 0; col < 8; ++col)
+					dest[row * 8 + col] = src[row * 8 + (7 - col)];
+
+			valid[pattern] |= hflipped_valid;
+		}
+	}
+
+private:
+	static const std::uint8_t normal_valid = 1 << 0;
+	static const std::uint8_t hflipped_valid = 1 << 1;
+
+	using decoded_pattern = std::array<std::uint8_t, 64>;
+
+	genesis::vdp::vram_t& vram;
+	std::vector<decoded_pattern> normal;
+	std::vector<decoded_pattern> hflipped;
+	std::vector<std::uint8_t> valid;
+
+	// VRAM pattern generation the decoded pattern was built from
+	std::vector<std::uint64_t> generations;
+};
+
+} // namespace genesis::vdp::impl
+
+#endif // __VDP_IMPL_TILE_CACHE_H__
@@ -14,6 +14,21 @@ namespace genesis::vdp::impl
 class vscroll_table
 {
 public:
+	static const int max_strips = 20;
+
+	// returns number of strips with individual scrolling (1 in full screen mode)
+	static int num_strips(vdp::settings& sett)
+	{
+		if(sett.vertical_scrolling() == vertical_scrolling::full_screen)
+			return 1;
+
+		// 20 strips in 320 pixels mode
+		// 16 strips in 256 pixels mode
+		if(sett.display_width() == display_width::c40)
+			return 20;
+		return 16;
+	}
+
 	static int get_offset(plane_type plane_type, unsigned tail_column_number, vdp::settings& sett, vdp::vsram_t& vsram)
 	{
 		if(plane_type != plane_type::a && plane_type != plane_type::b)
@@ -49,15 +64,6 @@ private:
 
 		return address;
 	}
-
-	static int num_strips(vdp::settings& sett)
-	{
-		// 20 strips in 320 pixels mode
-		// 16 strips in 256 pixels mode
-		if(sett.display_width() == display_width::c40)
-			return 20;
-		return 16;
-	}
 };
 
 } // namespace genesis::vdp::impl
@@ -2,6 +2,7 @@
 #define __VDP_M68K_BUS_ACCESS_H__
 
 #include <cstdint>
+#include <optional>
 
 namespace genesis::vdp
 {
@@ -21,6 +22,20 @@ public:
 	virtual std::uint16_t latched_word() const = 0;
 
 	virtual bool is_idle() const = 0;
+
+	/* Optional support of M68K -> VDP DMA performed in blocks.
+	 * Returns the number of VDP cycles a word read takes, from the cycle it's initiated on
+	 * till the cycle the bus becomes idle, or 0 if the bus cannot be accessed directly. */
+	virtual std::uint32_t word_read_cycles() const
+	{
+		return 0;
+	}
+
+	// read the word without a bus cycle, nullopt if the address is not plain memory
+	virtual std::optional<std::uint16_t> read_word_direct(std::uint32_t /* address */)
+	{
+		return std::nullopt;
+	}
 };
 
 }; // namespace genesis::vdp
@@ -3,9 +3,14 @@
 
 #include "memory/memory_unit.h"
 #include "output_color.h"
+#include "pixel_format.h"
+#include "write_tracker.h"
 
 #include <array>
 #include <cassert>
+#include <cstring>
+#include <span>
+#include <vector>
 
 
 namespace genesis::vdp
@@ -13,17 +18,223 @@ namespace genesis::vdp
 
 class vram_t : public memory::memory_unit
 {
+public:
+	// VRAM holds up to 2048 patterns, each is 32 bytes
+	static const std::uint32_t pattern_size = 32;
+	static const std::uint32_t num_patterns = 0x10000 / pattern_size;
+
+	using content = std::array<std::uint8_t, 0x10000>;
+	using pattern_data = std::array<std::uint8_t, pattern_size>;
+
+	// writes are tracked per pattern, patterns are grouped into 1 KiB regions to find modified ones quickly
+	using tracker = write_tracker<num_patterns, 32>;
+	using pattern_set = tracker::block_set;
+
 public:
 	vram_t() : memory::memory_unit(0xffff, std::endian::big) // [0; 0xFFFF]
 	{
 	}
+
+	template <class T>
+	void write(std::uint32_t address, T data)
+	{
+		memory::memory_unit::write(address, data);
+		mark_dirty(address, sizeof(T));
+	}
+
+	void init_write(std::uint32_t address, std::uint8_t data) override
+	{
+		memory::memory_unit::init_write(address, data);
+		mark_dirty(address, sizeof(data));
+	}
+
+	void init_write(std::uint32_t address, std::uint16_t data) override
+	{
+		memory::memory_unit::init_write(address, data);
+		mark_dirty(address, sizeof(data));
+	}
+
+	// writes must go through vram_t to keep track of modified patterns
+	std::optional<memory::direct_region> direct_access(std::uint32_t address) override
+	{
+		auto region = memory::memory_unit::direct_access(address);
+		if(region.has_value())
+			region->writable = false;
+		return region;
+	}
+
+	// Every write increments the generation and stamps the modified pattern(s) with it,
+	// so caches built from VRAM content can tell whether their source was modified since they were built.
+	// Generation is never 0, so 0 can be used as "never built" (the initial content is treated as written).
+	std::uint64_t generation() const
+	{
+		return m_tracker.generation();
+	}
+
+	// returns the generation of the last write to the pattern
+	std::uint64_t pattern_generation(std::uint32_t pattern) const
+	{
+		return m_tracker.block_generation(pattern);
+	}
+
+	// true if any byte of [address; address + size) was written after the generation,
+	// the range wraps around the end of VRAM (as VDP tables do)
+	bool modified_since(std::uint64_t generation, std::uint32_t address, std::uint32_t size) const
+	{
+		if(size == 0 || !m_tracker.modified_since(generation))
+			return false;
+
+		if(size >= 0x10000)
+			return true;
+
+		std::uint32_t first = (address & 0xFFFF) / pattern_size;
+		std::uint32_t last = ((address + size - 1) & 0xFFFF) / pattern_size;
+		if(first <= last)
+			return m_tracker.modified_since(generation, first, last);
+
+		return m_tracker.modified_since(generation, first, num_patterns - 1) ||
+			   m_tracker.modified_since(generation, 0, last);
+	}
+
+	// dirty bitmap of patterns written after the generation
+	pattern_set modified_patterns(std::uint64_t generation) const
+	{
+		return m_tracker.modified_blocks(generation);
+	}
+
+	// copy the whole VRAM
+	void snapshot(content& dest)
+	{
+		std::memcpy(dest.data(), raw(), dest.size());
+	}
+
+	// append only the specified patterns to dest (in ascending order)
+	void snapshot(const pattern_set& patterns, std::vector<pattern_data>& dest)
+	{
+		const std::uint8_t* mem = raw();
+		for(std::uint32_t pattern = 0; pattern < num_patterns; ++pattern)
+		{
+			if(patterns.test(pattern))
+				std::memcpy(dest.emplace_back().data(), mem + pattern * pattern_size, pattern_size);
+		}
+	}
+
+	// replace the whole VRAM, only patterns that differ are treated as written
+	void restore(const content& src)
+	{
+		for(std::uint32_t pattern = 0; pattern < num_patterns; ++pattern)
+			restore_pattern(src.data() + pattern * pattern_size, pattern);
+	}
+
+	// replace only the specified patterns (e.g. the ones known to differ between snapshots)
+	void restore(const content& src, const pattern_set& patterns)
+	{
+		for(std::uint32_t pattern = 0; pattern < num_patterns; ++pattern)
+		{
+			if(patterns.test(pattern))
+				restore_pattern(src.data() + pattern * pattern_size, pattern);
+		}
+	}
+
+	// replace the specified patterns with the ones captured by snapshot(patterns, dest)
+	void restore(const pattern_set& patterns, std::span<const pattern_data> src)
+	{
+		assert(patterns.count() == src.size());
+
+		auto it = src.begin();
+		for(std::uint32_t pattern = 0; pattern < num_patterns; ++pattern)
+		{
+			if(patterns.test(pattern))
+				restore_pattern((it++)->data(), pattern);
+		}
+	}
+
+	// Write the byte count times starting from the address, the address is advanced by increment after
+	// every write and wraps around the end of VRAM (the same as the sequence of single byte writes does)
+	void fill(std::uint16_t address, std::uint8_t data, std::uint32_t count, std::uint8_t increment)
+	{
+		if(count == 0)
+			return;
+
+		std::uint8_t* mem = raw();
+		const std::uint16_t first = address;
+		for(std::uint32_t i = 0; i < count; ++i, address = static_cast<std::uint16_t>(address + increment))
+			mem[address] = data;
+
+		mark_dirty_sequence(first, count, increment);
+	}
+
+	// Copy count bytes starting from the source address to the destination address one by one
+	// (so overlapping ranges behave as byte by byte copy), the destination address is advanced by increment
+	// and wraps around the end of VRAM, the source range must not cross the end of VRAM
+	void copy(std::uint16_t dest, std::uint32_t source, std::uint32_t count, std::uint8_t increment)
+	{
+		if(count == 0)
+			return;
+
+		assert(source + count <= 0x10000);
+
+		std::uint8_t* mem = raw();
+		const std::uint16_t first = dest;
+		for(std::uint32_t i = 0; i < count; ++i, dest = static_cast<std::uint16_t>(dest + increment))
+			mem[dest] = mem[source + i];
+
+		mark_dirty_sequence(first, count, increment);
+	}
+
+private:
+	std::uint8_t* raw()
+	{
+		return memory::memory_unit::direct_access(0)->data;
+	}
+
+	void restore_pattern(const std::uint8_t* src, std::uint32_t pattern)
+	{
+		const std::uint32_t address = pattern * pattern_size;
+		std::uint8_t* data = raw() + address;
+		if(std::memcmp(data, src, pattern_size) == 0)
+			return;
+
+		std::memcpy(data, src, pattern_size);
+		mark_dirty(address, pattern_size);
+	}
+
+	void mark_dirty(std::uint32_t address, std::uint32_t size)
+	{
+		m_tracker.mark(address / pattern_size, (address + size - 1) / pattern_size);
+	}
+
+	// mark all patterns between the first and the last written byte (or the whole VRAM if addresses wrap)
+	void mark_dirty_sequence(std::uint16_t address, std::uint32_t count, std::uint8_t increment)
+	{
+		const std::uint32_t size = (count - 1) * increment + 1;
+		if(address + size > 0x10000)
+			mark_dirty(0, 0x10000);
+		else
+			mark_dirty(address, size);
+	}
+
+private:
+	tracker m_tracker;
 };
 
 class cram_t
 {
+public:
+	// colors of all 4 palettes already converted to the output format, index: palette * 16 + color
+	using color_table = std::array<output_color, 64>;
+
+	// the same colors converted to host pixel formats
+	using argb8888_table = std::array<std::uint32_t, 64>;
+	using rgb565_table = std::array<std::uint16_t, 64>;
+
+	using color_set = write_tracker<64>::block_set;
+
 public:
 	cram_t() : mem(127) // 128 bytes [0 ; 127]
 	{
+		argb8888_colors.fill(to_argb8888(output_color(0)));
+		rgb565_colors.fill(to_rgb565(output_color(0)));
 	}
 
 	std::uint16_t read(std::uint16_t addr)
@@ -36,21 +247,48 @@ public:
 		addr = format_addr(addr);
 		mem.write(addr, data);
 
-		unsigned palette = addr / 32;
-		unsigned color_idx = (addr % 32) / 2;
+		unsigned index = addr / 2;
+		assert(index < colors.size());
+
+		colors[index] = data;
+		argb8888_colors[index] = to_argb8888(colors[index]);
+		rgb565_colors[index] = to_rgb565(colors[index]);
+		m_tracker.mark(index, index);
+	}
 
-		assert(palette < colors.size());
-		assert(color_idx < colors[palette].size());
+	// incremented on every write
+	std::uint64_t generation() const
+	{
+		return m_tracker.generation();
+	}
 
-		colors[palette][color_idx] = data;
+	// dirty bitmap of colors written after the generation
+	color_set modified_colors(std::uint64_t generation) const
+	{
+		return m_tracker.modified_blocks(generation);
 	}
 
 	output_color read_color(unsigned palette, unsigned color_idx)
 	{
-		assert(palette < colors.size());
-		assert(color_idx < colors[palette].size());
+		assert(palette < 4);
+		assert(color_idx < 16);
 
-		return colors[palette][color_idx];
+		return colors[palette * 16 + color_idx];
+	}
+
+	const color_table& colors_table() const
+	{
+		return colors;
+	}
+
+	const argb8888_table& host_colors_argb8888() const
+	{
+		return argb8888_colors;
+	}
+
+	const rgb565_table& host_colors_rgb565() const
+	{
+		return rgb565_colors;
 	}
 
 private:
@@ -61,12 +299,18 @@ private:
 
 private:
 	memory::memory_unit mem;
-	std::array<std::array<output_color, 16>, 4> colors;
+	color_table colors;
+	argb8888_table argb8888_colors;
+	rgb565_table rgb565_colors;
+	write_tracker<64> m_tracker;
 };
 
 
 class vsram_t
 {
+public:
+	using entry_set = write_tracker<40>::block_set;
+
 public:
 	vsram_t() : mem(79) // 80 bytes [0 ; 79]
 	{
@@ -94,6 +338,19 @@ public:
 			return;
 
 		mem.write(addr, data);
+		m_tracker.mark(addr / 2, addr / 2);
+	}
+
+	// incremented on every write
+	std::uint64_t generation() const
+	{
+		return m_tracker.generation();
+	}
+
+	// dirty bitmap of entries written after the generation
+	entry_set modified_entries(std::uint64_t generation) const
+	{
+		return m_tracker.modified_blocks(generation);
 	}
 
 private:
@@ -104,6 +361,7 @@ private:
 
 private:
 	memory::memory_unit mem;
+	write_tracker<40> m_tracker;
 };
 
 }; // namespace genesis::vdp
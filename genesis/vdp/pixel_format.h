@@ -0,0 +1,53 @@
+#ifndef __VDP_PIXEL_FORMAT_H__
+#define __VDP_PIXEL_FORMAT_H__
+
+#include "output_color.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace genesis::vdp
+{
+
+// host pixel formats the active display can be rendered in
+enum class pixel_format
+{
+	argb8888,
+	rgb565,
+};
+
+constexpr std::size_t bytes_per_pixel(pixel_format format)
+{
+	return format == pixel_format::argb8888 ? 4 : 2;
+}
+
+namespace impl
+{
+
+// expand 3-bit channel to the full range of N bits (0b111 -> all ones)
+constexpr std::uint32_t expand_channel(std::uint32_t value, unsigned bits)
+{
+	std::uint32_t res = 0;
+	for(int shift = int(bits) - 3; shift > -3; shift -= 3)
+		res |= shift >= 0 ? value << shift : value >> -shift;
+	return res;
+}
+
+} // namespace impl
+
+inline std::uint32_t to_argb8888(output_color color)
+{
+	return 0xFF000000 | (impl::expand_channel(color.red, 8) << 16) | (impl::expand_channel(color.green, 8) << 8) |
+		   impl::expand_channel(color.blue, 8);
+}
+
+inline std::uint16_t to_rgb565(output_color color)
+{
+	return static_cast<std::uint16_t>((impl::expand_channel(color.red, 5) << 11) |
+									  (impl::expand_channel(color.green, 6) << 5) | impl::expand_channel(color.blue, 5));
+}
+
+} // namespace genesis::vdp
+
+#endif // __VDP_PIXEL_FORMAT_H__
@@ -1,5 +1,8 @@
 #include "vdp.h"
 
+#include "impl/fifo_write.h"
+
+#include <algorithm>
 #include <iostream>
 
 namespace genesis::vdp
@@ -56,10 +59,18 @@ vdp::vdp(std::shared_ptr<m68k_bus_access> m68k_bus)
 
 void vdp::cycle()
 {
+	m_last_cycle_idle = !has_pending_work();
+	m_next_event_mclk = 0;
+
 	mclk++;
 
 	if(mclk % (cycles_per_pixel(_sett) * 2) == 0)
-		m_hv_unit.on_pixel(_sett.display_width(), _sett.display_height(), MODE);
+	{
+		int line = m_hv_unit.v_counter_raw();
+		if(m_hv_unit.on_pixel(_sett.display_width(), _sett.display_height(), MODE))
+			render_line(line);
+	}
+
 	m_int_unit.cycle(m_hv_unit.v_counter_raw(), m_hv_unit.h_counter_raw());
 
 	if(mclk == 1)
@@ -77,6 +88,105 @@ void vdp::cycle()
 	}
 }
 
+void vdp::run(std::uint32_t cycles)
+{
+	while(cycles > 0)
+	{
+		if(m_last_cycle_idle && !has_pending_work())
+		{
+			// nothing can change till the next event, so skip all cycles before it
+			if(m_next_event_mclk == 0)
+				m_next_event_mclk = mclk + cycles_to_next_event();
+
+			std::uint32_t to_skip = std::min(m_next_event_mclk - mclk - 1, cycles);
+			skip_cycles(to_skip);
+
+			cycles -= to_skip;
+			if(cycles == 0)
+				return;
+		}
+
+		if(std::uint32_t done = run_dma_block(cycles); done != 0)
+		{
+			cycles -= done;
+			continue;
+		}
+
+		cycle();
+		--cycles;
+	}
+}
+
+bool vdp::has_pending_work()
+{
+	if(!ports.is_idle() || ports.pending_control_write_requet().has_value())
+		return true;
+
+	if(!regs.fifo.empty() || pre_cache_read_is_required())
+		return true;
+
+	if(_sett.dma_enabled() && (!dma.is_idle() || regs.control.dma_start() || !dma_memory.is_idle()))
+		return true;
+
+	return false;
+}
+
+std::uint32_t vdp::run_dma_block(std::uint32_t cycles)
+{
+	// ports requests are handled on every cycle, so leave them to cycle()
+	if(!_sett.dma_enabled() || !dma.can_run_block() || !ports.is_idle() ||
+	   ports.pending_control_write_requet().has_value())
+		return 0;
+
+	// memory content may be observed by the next event (e.g. line rendering), so don't cross it
+	std::uint32_t limit = std::min(cycles_to_next_event() - 1, cycles);
+	std::uint32_t done = dma.run_block(limit, _vram, _cram, _vsram);
+	if(done == 0)
+		return 0;
+
+	// the transfer doesn't cross any event, so only H counter has to be updated
+	skip_cycles(done);
+	m_last_cycle_idle = false;
+	m_next_event_mclk = 0;
+
+	return done;
+}
+
+std::uint32_t vdp::cycles_to_next_event()
+{
+	// the line starts at mclk == 1
+	if(mclk == 0)
+		return 1;
+
+	const auto width = _sett.display_width();
+
+	int pixels = std::min({m_hv_unit.pixels_to_next_event(width),
+						   m_hv_unit.pixels_to_h_counter(impl::interrupt_unit::vint_position, width),
+						   m_hv_unit.pixels_to_h_counter(impl::interrupt_unit::hint_position(width), width)});
+
+	std::uint32_t pixel_cycles = cycles_per_pixel(_sett) * 2;
+	std::uint32_t to_pixel = pixel_cycles - (mclk % pixel_cycles) + (pixels - 1) * pixel_cycles;
+	std::uint32_t to_line_end = cycles_per_line(_sett) - mclk;
+
+	return std::min(to_pixel, to_line_end);
+}
+
+void vdp::skip_cycles(std::uint32_t cycles)
+{
+	// skipped cycles don't reach any event, so only H counter has to be updated
+	std::uint32_t pixel_cycles = cycles_per_pixel(_sett) * 2;
+	int pixels = static_cast<int>((mclk + cycles) / pixel_cycles - mclk / pixel_cycles);
+	mclk += cycles;
+
+	if(pixels == 0)
+		return;
+
+	m_hv_unit.skip_pixels(pixels, _sett.display_width());
+
+	// let interrupt unit see the new H counter (it resets HINT counter during vblank)
+	m_int_unit.cycle(m_hv_unit.v_counter_raw(), m_hv_unit.h_counter_raw());
+}
+
 void vdp::handle_ports_requests()
 {
 	auto& write_req = ports.pending_control_write_requet();
@@ -125,47 +235,7 @@ void vdp::handle_ports_requests()
 
 	if(!regs.fifo.empty())
 	{
-		auto entry = regs.fifo.pop();
-
-		switch(entry.control.vmem_type())
-		{
-		case vmem_type::vram: {
-			/* It seems that official/unofficial documentation is incorrect about write order.
-			 * The following order seems the right one:
-			 * If address is even: we first have to write MSB and then LSB.
-			 * If address is odd : we first have to write LSB and then LSB.
-			 */
-
-			if(entry.control.address() % 2 == 1)
-			{
-				// writing to odd addresses swaps bytes
-				endian::swap(entry.data);
-
-				// writing cannot cross a word boundary
-				entry.control.address(entry.control.address() & ~1);
-			}
-
-			// TODO: vram has byte-only access
-			_vram.write(entry.control.address(), entry.data);
-		}
-		break;
-
-		case vmem_type::cram:
-			_cram.write(entry.control.address(), entry.data);
-			break;
-
-		case vmem_type::vsram:
-			_vsram.write(entry.control.address(), entry.data);
-			break;
-
-		case vmem_type::invalid:
-			// TODO: what should we do?
-			throw genesis::not_implemented();
-
-		default:
-			throw internal_error();
-		}
-
+		impl::write_fifo_entry(regs.fifo.pop(), _vram, _cram, _vsram);
 		return;
 	}
 
@@ -273,6 +343,7 @@ void vdp::on_end_scanline()
 	int vint_threshold = _sett.display_height() == display_height::c28 ? 0xE0 : 0xF0;
 	if(regs.v_counter == vint_threshold)
 	{
+		++m_frame_count;
 		if(on_frame_end_callback != nullptr)
 			on_frame_end_callback();
 	}
@@ -294,6 +365,68 @@ void vdp::on_scanline()
 	update_status_register();
 }
 
+void vdp::set_render_threads(unsigned threads)
+{
+	wait_render();
+	m_render_pool.reset();
+
+	for(auto& log : m_line_logs)
+		log.clear();
+
+	if(threads != 0)
+		m_render_pool = std::make_unique<impl::render_pool>(threads);
+}
+
+void vdp::render_line(int line)
+{
+	if(line < 0 || static_cast<unsigned>(line) >= m_render.active_display_height())
+		return;
+
+	if(m_render_pool != nullptr)
+	{
+		log_line(line);
+		return;
+	}
+
+	switch(m_framebuffer.format())
+	{
+	case pixel_format::argb8888:
+		m_render.get_active_display_row_argb8888(line, m_framebuffer.back_row<std::uint32_t>(line));
+		break;
+
+	case pixel_format::rgb565:
+		m_render.get_active_display_row_rgb565(line, m_framebuffer.back_row<std::uint16_t>(line));
+		break;
+
+	default:
+		throw internal_error();
+	}
+
+	// the last line of the active display completes the frame
+	if(static_cast<unsigned>(line) + 1 == m_render.active_display_height())
+		m_framebuffer.swap(m_render.active_display_width(), m_render.active_display_height());
+}
+
+void vdp::log_line(unsigned line)
+{
+	auto& log = m_line_logs[m_current_log];
+	log.record(line, regs, _vram, _cram, _vsram);
+
+	// sprite flags can be read by CPU right away, so they cannot wait for the frame to be rendered
+	m_render.update_sprite_status(line);
+
+	if(line + 1 == m_render.active_display_height())
+	{
+		const unsigned width = m_render.active_display_width();
+		const unsigned height = m_render.active_display_height();
+		m_render_pool->render(log, m_framebuffer, [this, width, height]() { m_framebuffer.swap(width, height); });
+
+		// the other log is free as the previous frame is already rendered
+		m_current_log ^= 1;
+		m_line_logs[m_current_log].clear();
+	}
+}
+
 bool vdp::pre_cache_read_is_required() const
 {
 	if(!regs.fifo.empty())
@@ -1,12 +1,15 @@
 #ifndef __VDP_H__
 #define __VDP_H__
 
+#include "framebuffer.h"
 #include "impl/blank_flags.h"
 #include "impl/dma.h"
 #include "impl/hv_counters.h"
 #include "impl/hv_unit.h"
 #include "impl/interrupt_unit.h"
+#include "impl/line_state_log.h"
 #include "impl/render.h"
+#include "impl/render_pool.h"
 #include "m68k_bus_access.h"
 #include "m68k_interrupt_access.h"
 #include "memory.h"
@@ -16,6 +19,8 @@
 
 #include <functional>
 #include <memory>
+#include <span>
+#include <vector>
 
 
 namespace genesis::vdp
@@ -43,6 +48,18 @@ public:
 	// TODO: it should have multiple cycle methods with different clock rate
 	void cycle();
 
+	// advance VDP by the specified number of master clock cycles
+	// idle cycles (no pending port/FIFO/DMA work) are skipped up to the next event
+	// (blank flags/V counter/interrupts update or the end of the scanline),
+	// DMA fill/VRAM copy is performed in blocks up to the next event as well
+	void run(std::uint32_t cycles);
+
+	// number of frames completed so far (incremented right before the frame end callback)
+	std::uint64_t frame_count() const
+	{
+		return m_frame_count;
+	}
+
 	register_set& registers()
 	{
 		return regs;
@@ -78,6 +95,44 @@ public:
 		return m_render;
 	}
 
+	// Active display produced during emulation in the host pixel format. Every row is rendered at once
+	// when V counter leaves the corresponding line, completed frame is available via framebuffer().front().
+	// The frame can be picked up from another thread, see framebuffer for details
+	genesis::vdp::framebuffer& framebuffer()
+	{
+		return m_framebuffer;
+	}
+
+	const genesis::vdp::framebuffer& framebuffer() const
+	{
+		return m_framebuffer;
+	}
+
+	// ARGB8888 by default, all framebuffer buffers are cleared
+	void set_pixel_format(pixel_format format)
+	{
+		wait_render();
+		m_framebuffer.set_format(format);
+	}
+
+	/* 0 (default) - every active display row is rendered by the emulating thread when V counter leaves the line.
+	 * N - only the line state is logged during emulation, the completed frame is rendered by N worker threads
+	 * while emulation continues with the next frame (the frame is published to the framebuffer once rendered).
+	 * Sprite flags in the status register are updated during emulation in both modes. */
+	void set_render_threads(unsigned threads);
+
+	unsigned render_threads() const
+	{
+		return m_render_pool != nullptr ? m_render_pool->threads() : 0;
+	}
+
+	// wait till the frame being rendered by worker threads (if any) is published to the framebuffer
+	void wait_render()
+	{
+		if(m_render_pool != nullptr)
+			m_render_pool->wait();
+	}
+
 	// must be called before VINT/HINT
 	void on_frame_end(std::function<void()> callback)
 	{
@@ -93,8 +148,14 @@ private:
 	void on_start_scanline();
 	void on_end_scanline();
 	void on_scanline();
+	void render_line(int line);
+	void log_line(unsigned line);
 
 	bool pre_cache_read_is_required() const;
+	bool has_pending_work();
+	std::uint32_t run_dma_block(std::uint32_t cycles);
+	std::uint32_t cycles_to_next_event();
+	void skip_cycles(std::uint32_t cycles);
 
 	// TODO: refactor this interface
 	void vram_write(std::uint32_t address, std::uint8_t data);
@@ -114,6 +175,13 @@ private:
 	impl::interrupt_unit m_int_unit;
 
 	unsigned mclk = 0;
+	std::uint64_t m_frame_count = 0;
+
+	// true if the last executed cycle had nothing to do, so the following idle cycles cannot change any state
+	bool m_last_cycle_idle = false;
+
+	// position of the next event within the line (see cycles_to_next_event), 0 if it has to be recalculated
+	std::uint32_t m_next_event_mclk = 0;
 
 protected:
 	impl::memory_access dma_memory;
@@ -123,6 +191,15 @@ protected:
 	int m_scanline = 0;
 
 private:
+	genesis::vdp::framebuffer m_framebuffer;
+
+	// the log of the current frame and the log of the frame being rendered by the pool
+	impl::line_state_log m_line_logs[2];
+	unsigned m_current_log = 0;
+
+	// must be destroyed before logs and framebuffer
+	std::unique_ptr<impl::render_pool> m_render_pool;
+
 	std::function<void()> on_frame_end_callback;
 };
 
@@ -0,0 +1,123 @@
+#ifndef __VDP_WRITE_TRACKER_H__
+#define __VDP_WRITE_TRACKER_H__
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace genesis::vdp
+{
+
+/* Tracks writes to a memory split into equal blocks.
+ * Every write increments the generation and stamps the written blocks (and the regions of
+ * BlocksPerRegion blocks they belong to) with it, so users can ask what was modified since
+ * the generation they saw last time without scanning the whole memory.
+ * Generation is never 0, so 0 can be used as "never seen" (everything is treated as modified since 0). */
+template <std::size_t NumBlocks, std::size_t BlocksPerRegion = 1>
+class write_tracker
+{
+	static_assert(NumBlocks % BlocksPerRegion == 0);
+
+public:
+	static const std::size_t num_blocks = NumBlocks;
+	static const std::size_t num_regions = NumBlocks / BlocksPerRegion;
+
+	using block_set = std::bitset<NumBlocks>;
+
+public:
+	write_tracker()
+	{
+		m_blocks.fill(m_generation);
+		m_regions.fill(m_generation);
+	}
+
+	std::uint64_t generation() const
+	{
+		return m_generation;
+	}
+
+	// returns the generation of the last write to the block
+	std::uint64_t block_generation(std::size_t block) const
+	{
+		assert(block < NumBlocks);
+		return m_blocks[block];
+	}
+
+	// record a write to [first_block; last_block]
+	void mark(std::size_t first_block, std::size_t last_block)
+	{
+		assert(first_block <= last_block && last_block < NumBlocks);
+
+		++m_generation;
+		for(std::size_t block = first_block; block <= last_block; ++block)
+		{
+			m_blocks[block] = m_generation;
+			m_regions[block / BlocksPerRegion] = m_generation;
+		}
+	}
+
+	// true if any of [first_block; last_block] was written after the generation
+	bool modified_since(std::uint64_t generation, std::size_t first_block, std::size_t last_block) const
+	{
+		assert(first_block <= last_block && last_block < NumBlocks);
+
+		if(m_generation <= generation)
+			return false;
+
+		for(std::size_t region = first_block / BlocksPerRegion; region <= last_block / BlocksPerRegion; ++region)
+		{
+			if(m_regions[region] <= generation)
+				continue;
+
+			const std::size_t first = std::max(first_block, region * BlocksPerRegion);
+			const std::size_t last = std::min(last_block, region * BlocksPerRegion + BlocksPerRegion - 1);
+			for(std::size_t block = first; block <= last; ++block)
+			{
+				if(m_blocks[block] > generation)
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool modified_since(std::uint64_t generation) const
+	{
+		return m_generation > generation;
+	}
+
+	// dirty bitmap of blocks written after the generation
+	block_set modified_blocks(std::uint64_t generation) const
+	{
+		block_set res;
+		if(m_generation <= generation)
+			return res;
+
+		for(std::size_t region = 0; region < num_regions; ++region)
+		{
+			if(m_regions[region] <= generation)
+				continue;
+
+			for(std::size_t block = region * BlocksPerRegion; block < (region + 1) * BlocksPerRegion; ++block)
+			{
+				if(m_blocks[block] > generation)
+					res.set(block);
+			}
+		}
+
+		return res;
+	}
+
+private:
+	std::uint64_t m_generation = 1;
+	std::array<std::uint64_t, NumBlocks> m_blocks;
+	std::array<std::uint64_t, num_regions> m_regions;
+};
+
+} // namespace genesis::vdp
+
+#endif // __VDP_WRITE_TRACKER_H__
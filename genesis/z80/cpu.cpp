@@ -25,9 +25,14 @@ void cpu::reset()
 	int_mode = cpu_interrupt_mode::im0;
 }
 
-void cpu::execute_one()
+std::uint32_t cpu::execute_one()
 {
-	exec->execute_one();
+	return exec->execute_one();
+}
+
+std::uint32_t cpu::execute(std::uint32_t cycle_budget)
+{
+	return exec->execute(cycle_budget);
 }
 
 } // namespace genesis::z80
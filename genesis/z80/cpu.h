@@ -32,7 +32,14 @@ public:
 	cpu(std::shared_ptr<z80::memory> memory, std::shared_ptr<z80::io_ports> io_ports = nullptr);
 	~cpu();
 
-	void execute_one();
+	// execute a single instruction (or accept an interrupt), returns the number of elapsed T-states
+	// repeated block instructions (LDIR, CPIR, OTIR, etc.) execute a single iteration
+	std::uint32_t execute_one();
+
+	// execute instructions till the specified number of T-states elapses,
+	// returns the number of T-states the last instruction took beyond the budget
+	// repeated block instructions execute as many iterations at once as the budget allows
+	std::uint32_t execute(std::uint32_t cycle_budget);
 
 	// TODO: do we need to make all these methods public?
 
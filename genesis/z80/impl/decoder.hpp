@@ -1,9 +1,7 @@
 #ifndef __DECODER_HPP__
 #define __DECODER_HPP__
 
-#include "exception.hpp"
 #include "instructions.hpp"
-#include "string_utils.hpp"
 #include "z80/cpu.h"
 #include "z80/cpu_registers.hpp"
 
@@ -13,9 +11,12 @@
 namespace genesis::z80
 {
 
-#define unsupported_addresing_mode(addr_mode)                                                                          \
-	throw internal_error("unsupported addressing mode " + std::to_string(addr_mode))
+// makes static_assert in the last if constexpr branch depend on the template parameter
+template <addressing_mode>
+constexpr bool unsupported_addressing_mode = false;
 
+/* Operands are resolved at compile time: every method is instantiated for the particular
+ * addressing mode (and instruction if immediate operands are involved) */
 class decoder
 {
 public:
@@ -23,225 +24,157 @@ public:
 	{
 	}
 
-	std::int8_t decode_byte(addressing_mode addr_mode, instruction inst)
+	template <addressing_mode addr_mode, instruction inst>
+	std::int8_t decode_byte()
 	{
-		switch(addr_mode)
-		{
-		case addressing_mode::register_a:
-		case addressing_mode::register_b:
-		case addressing_mode::register_c:
-		case addressing_mode::register_d:
-		case addressing_mode::register_e:
-		case addressing_mode::register_h:
-		case addressing_mode::register_l:
-		case addressing_mode::register_i:
-		case addressing_mode::register_r:
-		case addressing_mode::register_ixh:
-		case addressing_mode::register_ixl:
-		case addressing_mode::register_iyh:
-		case addressing_mode::register_iyl:
-			return decode_reg_8(addr_mode);
-
-		case addressing_mode::immediate:
-			return decode_immediate(inst);
-
-		case addressing_mode::immediate_ext:
-		case addressing_mode::indirect_hl:
-		case addressing_mode::indirect_bc:
-		case addressing_mode::indirect_de:
-		case addressing_mode::indirect_sp:
-		case addressing_mode::indexed_ix:
-		case addressing_mode::indexed_iy:
-			return mem.read<std::int8_t>(decode_address(addr_mode, inst));
-
-		default:
-			unsupported_addresing_mode(addr_mode);
-		}
+		if constexpr(is_reg_8(addr_mode))
+			return decode_reg_8<addr_mode>();
+		else if constexpr(addr_mode == addressing_mode::immediate)
+			return decode_immediate<inst>();
+		else
+			return mem.read<std::int8_t>(decode_address<addr_mode, inst>());
 	}
 
-	std::int16_t decode_2_bytes(addressing_mode addr_mode, instruction inst)
+	template <addressing_mode addr_mode, instruction inst>
+	std::int16_t decode_2_bytes()
 	{
-		switch(addr_mode)
-		{
-		case addressing_mode::immediate_ext:
-			return decode_immediate_ext(inst);
-
-		case addressing_mode::register_af:
-		case addressing_mode::register_bc:
-		case addressing_mode::register_de:
-		case addressing_mode::register_hl:
-		case addressing_mode::register_sp:
-		case addressing_mode::register_ix:
-		case addressing_mode::register_iy:
-			return decode_reg_16(addr_mode);
-
-		default:
-			unsupported_addresing_mode(addr_mode);
-		}
+		if constexpr(addr_mode == addressing_mode::immediate_ext)
+			return decode_immediate_ext<inst>();
+		else
+			return decode_reg_16<addr_mode>();
 	}
 
-	z80::memory::address decode_address(addressing_mode addr_mode, instruction inst)
+	template <addressing_mode addr_mode, instruction inst>
+	z80::memory::address decode_address()
 	{
-		switch(addr_mode)
-		{
-		case addressing_mode::immediate_ext:
-			return decode_immediate_ext(inst);
-
-		case addressing_mode::indirect_hl:
-		case addressing_mode::indirect_bc:
-		case addressing_mode::indirect_de:
-		case addressing_mode::indirect_sp:
-			return decode_indirect(addr_mode);
-
-		case addressing_mode::indexed_ix:
-		case addressing_mode::indexed_iy:
-			return decode_indexed(addr_mode);
-
-		default:
-			unsupported_addresing_mode(addr_mode);
-		}
+		if constexpr(addr_mode == addressing_mode::immediate_ext)
+			return decode_immediate_ext<inst>();
+		else if constexpr(is_indexed(addr_mode))
+			return decode_indexed<addr_mode>();
+		else
+			return decode_indirect<addr_mode>();
 	}
 
 	/* required minimum */
 
-	std::int8_t& decode_reg_8(addressing_mode addr_mode)
+	template <addressing_mode addr_mode>
+	std::int8_t& decode_reg_8()
 	{
-		switch(addr_mode)
-		{
-		case addressing_mode::register_a:
+		if constexpr(addr_mode == addressing_mode::register_a)
 			return regs.main_set.A;
-		case addressing_mode::register_b:
+		else if constexpr(addr_mode == addressing_mode::register_b)
 			return regs.main_set.B;
-		case addressing_mode::register_c:
+		else if constexpr(addr_mode == addressing_mode::register_c)
 			return regs.main_set.C;
-		case addressing_mode::register_d:
+		else if constexpr(addr_mode == addressing_mode::register_d)
 			return regs.main_set.D;
-		case addressing_mode::register_e:
+		else if constexpr(addr_mode == addressing_mode::register_e)
 			return regs.main_set.E;
-		case addressing_mode::register_h:
+		else if constexpr(addr_mode == addressing_mode::register_h)
 			return regs.main_set.H;
-		case addressing_mode::register_l:
+		else if constexpr(addr_mode == addressing_mode::register_l)
 			return regs.main_set.L;
-		case addressing_mode::register_i:
+		else if constexpr(addr_mode == addressing_mode::register_i)
 			return regs.I;
-		case addressing_mode::register_r:
+		else if constexpr(addr_mode == addressing_mode::register_r)
 			return regs.R;
-		case addressing_mode::register_ixh:
+		else if constexpr(addr_mode == addressing_mode::register_ixh)
 			return regs.IXH;
-		case addressing_mode::register_ixl:
+		else if constexpr(addr_mode == addressing_mode::register_ixl)
 			return regs.IXL;
-		case addressing_mode::register_iyh:
+		else if constexpr(addr_mode == addressing_mode::register_iyh)
 			return regs.IYH;
-		case addressing_mode::register_iyl:
+		else if constexpr(addr_mode == addressing_mode::register_iyl)
 			return regs.IYL;
-		default:
-			unsupported_addresing_mode(addr_mode);
-		}
+		else
+			static_assert(unsupported_addressing_mode<addr_mode>);
 	}
 
-	std::int16_t& decode_reg_16(addressing_mode addr_mode)
+	template <addressing_mode addr_mode>
+	std::int16_t& decode_reg_16()
 	{
-		switch(addr_mode)
-		{
-		case addressing_mode::register_af:
+		if constexpr(addr_mode == addressing_mode::register_af)
 			return regs.main_set.AF;
-		case addressing_mode::register_bc:
+		else if constexpr(addr_mode == addressing_mode::register_bc)
 			return regs.main_set.BC;
-		case addressing_mode::register_de:
+		else if constexpr(addr_mode == addressing_mode::register_de)
 			return regs.main_set.DE;
-		case addressing_mode::register_hl:
+		else if constexpr(addr_mode == addressing_mode::register_hl)
 			return regs.main_set.HL;
-		case addressing_mode::register_sp:
+		else if constexpr(addr_mode == addressing_mode::register_sp)
 			return regs.SP;
-		case addressing_mode::register_ix:
+		else if constexpr(addr_mode == addressing_mode::register_ix)
 			return regs.IX;
-		case addressing_mode::register_iy:
+		else if constexpr(addr_mode == addressing_mode::register_iy)
 			return regs.IY;
-		default:
-			unsupported_addresing_mode(addr_mode);
-		}
+		else
+			static_assert(unsupported_addressing_mode<addr_mode>);
 	}
 
-	template <class T = std::int8_t>
-	T decode_immediate(instruction inst)
+	template <instruction inst, class T = std::int8_t>
+	T decode_immediate()
 	{
 		static_assert(sizeof(T) <= 2);
 
-		auto addr = regs.PC;
-		addr += inst_size(inst);
+		// in case of indexed addressing mode the displacement goes before the immediate operand
+		constexpr std::uint16_t offset =
+			inst_size(inst) + (is_indexed(inst.source) || is_indexed(inst.destination) ? 1 : 0);
 
-		// check if addressing mode indexed combined with addressing mode immediate
-		if(is_indexed(inst.source) || is_indexed(inst.destination))
-		{
-			// in this case after opcode we have displacement for indexed
-			// and only then immediate operand
-			addr += 1; // to skip displacement
-		}
-
-		return mem.read<T>(addr);
+		return mem.read<T>(regs.PC + offset);
 	}
 
-	std::int16_t decode_immediate_ext(instruction inst)
+	template <instruction inst>
+	std::int16_t decode_immediate_ext()
 	{
-		return decode_immediate<std::int16_t>(inst);
+		return decode_immediate<inst, std::int16_t>();
 	}
 
-	z80::memory::address decode_indirect(addressing_mode addr_mode)
+	template <addressing_mode addr_mode>
+	z80::memory::address decode_indirect()
 	{
-		switch(addr_mode)
-		{
-		case addressing_mode::indirect_bc:
+		if constexpr(addr_mode == addressing_mode::indirect_bc)
 			return regs.main_set.BC;
-		case addressing_mode::indirect_de:
+		else if constexpr(addr_mode == addressing_mode::indirect_de)
 			return regs.main_set.DE;
-		case addressing_mode::indirect_hl:
+		else if constexpr(addr_mode == addressing_mode::indirect_hl)
 			return regs.main_set.HL;
-		case addressing_mode::indirect_sp:
+		else if constexpr(addr_mode == addressing_mode::indirect_sp)
 			return regs.SP;
-		default:
-			unsupported_addresing_mode(addr_mode);
-		}
+		else
+			static_assert(unsupported_addressing_mode<addr_mode>);
 	}
 
-	z80::memory::address decode_indexed(addressing_mode addr_mode)
+	template <addressing_mode addr_mode>
+	z80::memory::address decode_indexed()
 	{
-		switch(addr_mode)
-		{
-		case addressing_mode::indexed_ix:
-		case addressing_mode::indexed_iy: {
-			auto d = mem.read<std::int8_t>(regs.PC + 2);
-			z80::memory::address base = addr_mode == addressing_mode::indexed_ix ? regs.IX : regs.IY;
+		static_assert(is_indexed(addr_mode));
 
-			return base + d;
-		}
-		default:
-			unsupported_addresing_mode(addr_mode);
-		}
+		auto d = mem.read<std::int8_t>(regs.PC + 2);
+		z80::memory::address base = addr_mode == addressing_mode::indexed_ix ? regs.IX : regs.IY;
+
+		return base + d;
 	}
 
-	std::uint8_t decode_cc(instruction inst)
+	static constexpr std::uint8_t decode_cc(instruction inst)
 	{
 		// NOTE: always assume constant cc offset for all instructions
 		return (inst.opcodes[0] & 0b00111000) >> 3;
 	}
 
-	std::uint8_t decode_bit(addressing_mode addr_mode, instruction inst)
+	static constexpr std::uint8_t decode_bit(instruction inst)
 	{
-		switch(addr_mode)
-		{
-		case addressing_mode::bit:
-			return (inst.opcodes[1] & 0b00111000) >> 3;
-		case addressing_mode::immediate_bit:
-			return (decode_immediate<std::uint8_t>(inst) & 0b00111000) >> 3;
-		default:
-			unsupported_addresing_mode(addr_mode);
-		}
+		return (inst.opcodes[1] & 0b00111000) >> 3;
+	}
+
+	// DDCB/FDCB instructions, op4 is the 4th byte of the instruction
+	static constexpr std::uint8_t decode_indexed_bit(z80::opcode op4)
+	{
+		return (op4 & 0b00111000) >> 3;
 	}
 
-	operation_type decode_bit_op(instruction inst)
+	static constexpr operation_type decode_bit_op(z80::opcode op4)
 	{
-		auto data = decode_immediate<std::uint8_t>(inst);
-		switch(data >> 6)
+		switch(op4 >> 6)
 		{
 		case 0b01:
 			return operation_type::tst_bit_at;
@@ -249,57 +182,45 @@ public:
 			return operation_type::set_bit_at;
 		case 0b10:
 			return operation_type::res_bit_at;
-		case 0b00: {
-			std::uint8_t op = (data & 0b00111000) >> 3;
-			switch(op)
-			{
-			case 0b000:
-				return operation_type::rlc_at;
-			case 0b001:
-				return operation_type::rrc_at;
-			case 0b010:
-				return operation_type::rl_at;
-			case 0b011:
-				return operation_type::rr_at;
-			case 0b100:
-				return operation_type::sla_at;
-			case 0b101:
-				return operation_type::sra_at;
-			case 0b110:
-				return operation_type::sll_at;
-			case 0b111:
-				return operation_type::srl_at;
-			}
-		}
+		default:
+			break;
 		}
 
-		throw std::runtime_error("decode_bit_op internal error: unreachable code");
+		constexpr operation_type shift_ops[] = {
+			operation_type::rlc_at, operation_type::rrc_at, operation_type::rl_at,	operation_type::rr_at,
+			operation_type::sla_at, operation_type::sra_at, operation_type::sll_at, operation_type::srl_at,
+		};
+		return shift_ops[decode_indexed_bit(op4)];
 	}
 
-	std::int8_t& decode_bit_reg(std::uint8_t bit_reg)
+	// bit_reg must not be 0b110 ((HL) slot)
+	template <std::uint8_t bit_reg>
+	std::int8_t& decode_bit_reg()
 	{
-		switch(bit_reg)
-		{
-		case 0b111:
+		if constexpr(bit_reg == 0b111)
 			return regs.main_set.A;
-		case 0b000:
+		else if constexpr(bit_reg == 0b000)
 			return regs.main_set.B;
-		case 0b001:
+		else if constexpr(bit_reg == 0b001)
 			return regs.main_set.C;
-		case 0b010:
+		else if constexpr(bit_reg == 0b010)
 			return regs.main_set.D;
-		case 0b011:
+		else if constexpr(bit_reg == 0b011)
 			return regs.main_set.E;
-		case 0b100:
+		else if constexpr(bit_reg == 0b100)
 			return regs.main_set.H;
-		case 0b101:
+		else
 			return regs.main_set.L;
-		default:
-			throw std::runtime_error("decode_bit_reg error, unknown register " + su::bin_str(bit_reg));
-		}
 	}
 
-	void advance_pc(instruction inst)
+	template <instruction inst>
+	void advance_pc()
+	{
+		regs.PC += size(inst);
+	}
+
+	// full size of the instruction including operands
+	static constexpr std::uint16_t size(instruction inst)
 	{
 		auto addressing_mode_size = [](addressing_mode addr_mode) -> std::uint16_t {
 			switch(addr_mode)
@@ -316,13 +237,10 @@ public:
 			}
 		};
 
-		auto src_size = addressing_mode_size(inst.source);
-		auto dest_size = addressing_mode_size(inst.destination);
-
-		regs.PC += inst_size(inst) + src_size + dest_size;
+		return inst_size(inst) + addressing_mode_size(inst.source) + addressing_mode_size(inst.destination);
 	}
 
-	static std::uint8_t inst_size(instruction inst)
+	static constexpr std::uint8_t inst_size(instruction inst)
 	{
 		switch(inst.opcodes[0])
 		{
@@ -338,11 +256,17 @@ public:
 
 private:
 	/* helper methods */
-	static bool is_indexed(addressing_mode addr_mode)
+	static constexpr bool is_indexed(addressing_mode addr_mode)
 	{
 		return addr_mode == addressing_mode::indexed_ix || addr_mode == addressing_mode::indexed_iy;
 	}
 
+	static constexpr bool is_reg_8(addressing_mode addr_mode)
+	{
+		return (addr_mode >= addressing_mode::register_a && addr_mode <= addressing_mode::register_r) ||
+			   (addr_mode >= addressing_mode::register_ixh && addr_mode <= addressing_mode::register_iyl);
+	}
+
 private:
 	z80::memory& mem;
 	z80::cpu_registers& regs;
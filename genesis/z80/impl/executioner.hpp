@@ -6,28 +6,84 @@
 #include "instructions.hpp"
 #include "operations.hpp"
 #include "string_utils.hpp"
+#include "timings.hpp"
 #include "z80/cpu.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
 
 namespace genesis::z80
 {
 
+// makes static_assert in the last if constexpr branch depend on the template parameter
+template <operation_type>
+constexpr bool unsupported_operation = false;
+
+/* Every opcode of every page is executed by its own handler, instantiated for the particular instruction,
+ * so operands are resolved at compile time and dispatching an instruction is a couple of table lookups */
 class executioner
 {
+private:
+	using handler = std::uint32_t (*)(executioner&);
+	using dispatch_page = std::array<handler, inst_finder::page_size>;
+
+	struct dispatch_table
+	{
+		std::array<dispatch_page, inst_finder::page::count> pages;
+
+		// DDCB/FDCB instructions, indexed by the 4th byte
+		dispatch_page ddcb;
+		dispatch_page fdcb;
+
+		// IM0 executes instruction from the data bus, PC is not advanced
+		dispatch_page im0;
+	};
+
 public:
-	executioner(z80::cpu& cpu) : cpu(cpu), dec(z80::decoder(cpu)), ops(z80::operations(cpu))
+	executioner(z80::cpu& cpu)
+		: cpu(cpu), dec(z80::decoder(cpu)), ops(z80::operations(cpu)), m_dispatch_table(get_dispatch_table())
 	{
 	}
 
-	void execute_one()
+	// returns the number of elapsed T-states
+	std::uint32_t execute_one()
+	{
+		// repeated block instructions run a single iteration
+		m_cycle_budget = 0;
+		return execute_next();
+	}
+
+	// returns the number of T-states the last instruction took beyond the budget
+	std::uint32_t execute(std::uint32_t cycle_budget)
+	{
+		std::uint32_t elapsed = 0;
+		while(elapsed < cycle_budget)
+		{
+			m_cycle_budget = cycle_budget - elapsed;
+			elapsed += execute_next();
+		}
+
+		return elapsed - cycle_budget;
+	}
+
+private:
+	static const std::uint32_t reset_cycles = 3;
+	static const std::uint32_t idle_cycles = 4;
+	static const std::uint32_t nmi_cycles = 11;
+
+	std::uint32_t execute_next()
 	{
-		if(check_interrupts())
-			return;
+		if(std::uint32_t cycles = check_interrupts(); cycles != 0)
+			return cycles;
 
 		if(cpu.bus().is_set(bus::RESET))
 		{
 			cpu.reset();
-			return;
+			return reset_cycles;
 		}
 
 		if(cpu.bus().is_set(bus::BUSREQ))
@@ -36,7 +92,7 @@ public:
 			cpu.bus().set(bus::BUSACK);
 
 			// asume setting BUSREQ will pause the CPU, should be good enough for our purposes
-			return;
+			return idle_cycles;
 		}
 		else
 		{
@@ -45,435 +101,501 @@ public:
 
 		if(cpu.bus().is_set(bus::HALT))
 		{
-			// nothing to do
-			return;
+			// CPU executes NOPs while halted
+			return idle_cycles;
 		}
 
-		auto& mem = cpu.memory();
-		auto& regs = cpu.registers();
+		z80::opcode opcode = cpu.memory().read<z80::opcode>(cpu.registers().PC);
+		return m_dispatch_table.pages[inst_finder::page::single][opcode](*this);
+	}
 
-		z80::opcode opcode = mem.read<z80::opcode>(regs.PC);
-		z80::opcode opcode2 = mem.read<z80::opcode>(regs.PC + 1);
+	static constexpr dispatch_table build_dispatch_table()
+	{
+		using page = inst_finder::page;
+		constexpr auto ops = std::make_index_sequence<inst_finder::page_size>();
 
-		auto inst = finder.fast_search(opcode, opcode2);
-		exec_and_advance(inst);
+		dispatch_table table{};
+		table.pages = {make_page<page::single>(ops), make_page<page::dd>(ops), make_page<page::fd>(ops),
+					   make_page<page::ed>(ops), make_page<page::cb>(ops)};
+		table.ddcb = make_bit_group_page<addressing_mode::indexed_ix>(ops);
+		table.fdcb = make_bit_group_page<addressing_mode::indexed_iy>(ops);
+		table.im0 = make_im0_page(ops);
+
+		return table;
 	}
 
-private:
-	void exec_and_advance(z80::instruction inst)
+	template <inst_finder::page page, std::size_t... ops>
+	static constexpr dispatch_page make_page(std::index_sequence<ops...>)
+	{
+		return {make_handler<page, static_cast<z80::opcode>(ops)>()...};
+	}
+
+	template <inst_finder::page page, z80::opcode op>
+	static constexpr handler make_handler()
+	{
+		constexpr auto next_page = inst_finder::prefix_page(op);
+		constexpr auto inst = inst_finder::find(page, op);
+
+		if constexpr(page == inst_finder::page::single && next_page != inst_finder::page::single)
+			return &exec_prefixed<next_page>;
+		else if constexpr(inst.op_type == operation_type::bit_group)
+			return &exec_bit_group<inst.destination>;
+		else
+			return &invoke<&executioner::exec_and_advance<inst>>;
+	}
+
+	template <addressing_mode addr_mode, std::size_t... ops>
+	static constexpr dispatch_page make_bit_group_page(std::index_sequence<ops...>)
+	{
+		return {&invoke<&executioner::exec_bit_group_op<addr_mode, static_cast<z80::opcode>(ops)>>...};
+	}
+
+	template <std::size_t... ops>
+	static constexpr dispatch_page make_im0_page(std::index_sequence<ops...>)
+	{
+		return {make_im0_handler<static_cast<z80::opcode>(ops)>()...};
+	}
+
+	template <z80::opcode op>
+	static constexpr handler make_im0_handler()
 	{
-		exec(inst);
-		if(need_advance_pc(inst.op_type))
-			dec.advance_pc(inst);
+		if constexpr(inst_finder::prefix_page(op) != inst_finder::page::single)
+			return &unsupported_im0_instruction;
+		else
+			return &exec_im0<inst_finder::find(inst_finder::page::single, op)>;
+	}
+
+	/* handlers */
+
+	template <inst_finder::page page>
+	static std::uint32_t exec_prefixed(executioner& ex)
+	{
+		z80::opcode opcode2 = ex.cpu.memory().read<z80::opcode>(ex.cpu.registers().PC + 1);
+		return ex.m_dispatch_table.pages[page][opcode2](ex);
+	}
+
+	template <addressing_mode addr_mode>
+	static std::uint32_t exec_bit_group(executioner& ex)
+	{
+		// DD/FD CB d op4
+		z80::opcode opcode4 = ex.cpu.memory().read<z80::opcode>(ex.cpu.registers().PC + 3);
+		if constexpr(addr_mode == addressing_mode::indexed_ix)
+			return ex.m_dispatch_table.ddcb[opcode4](ex);
+		else
+			return ex.m_dispatch_table.fdcb[opcode4](ex);
+	}
+
+	template <std::uint32_t (executioner::*Handler)()>
+	static std::uint32_t invoke(executioner& ex)
+	{
+		return (ex.*Handler)();
+	}
+
+	template <instruction inst>
+	static std::uint32_t exec_im0(executioner& ex)
+	{
+		ex.exec<inst>();
+		return inst.cycles + timings::im0_extra_cycles;
+	}
+
+	static std::uint32_t unsupported_im0_instruction(executioner&)
+	{
+		throw std::runtime_error("exec_maskable_interrupt error: prefixed instructions are not supported in IM0");
+	}
+
+	template <instruction inst>
+	std::uint32_t exec_and_advance()
+	{
+		std::uint32_t cycles = inst.cycles;
+
+		if constexpr(is_block_repeat(inst.op_type))
+		{
+			constexpr std::uint32_t repeat_cycles = inst.cycles + timings::extra_cycles(inst.op_type);
+
+			const auto pc = cpu.registers().PC;
+			const std::uint32_t iterations = exec_block<inst>(block_iterations(repeat_cycles));
+
+			// all the iterations but the last one are repeated
+			cycles = repeat_cycles * iterations;
+			if(cpu.registers().PC != pc)
+				cycles -= timings::extra_cycles(inst.op_type);
+		}
+		else
+		{
+			// must be checked before execution, as the instruction may change the condition (i.e. DJNZ)
+			if constexpr(timings::extra_cycles(inst.op_type) != 0)
+			{
+				if(condition_met<inst>())
+					cycles += timings::extra_cycles(inst.op_type);
+			}
+
+			exec<inst>();
+			if constexpr(need_advance_pc(inst.op_type))
+				dec.advance_pc<inst>();
+		}
+
+		return cycles;
+	}
+
+	// true if conditional jump/call/return is taken
+	template <instruction inst>
+	bool condition_met()
+	{
+		const auto& regs = cpu.registers();
+		if constexpr(inst.op_type == operation_type::jr_z)
+			return regs.main_set.flags.Z == 1;
+		else if constexpr(inst.op_type == operation_type::jr_nz)
+			return regs.main_set.flags.Z == 0;
+		else if constexpr(inst.op_type == operation_type::jr_c)
+			return regs.main_set.flags.C == 1;
+		else if constexpr(inst.op_type == operation_type::jr_nc)
+			return regs.main_set.flags.C == 0;
+		else if constexpr(inst.op_type == operation_type::djnz)
+			return regs.main_set.B != 1;
+		else if constexpr(inst.op_type == operation_type::call_cc || inst.op_type == operation_type::ret_cc)
+			return ops.check_cc(decoder::decode_cc(inst));
+		else
+			static_assert(unsupported_operation<inst.op_type>);
 	}
 
-	void exec(z80::instruction inst)
+	// maximum number of iterations of the repeated block instruction that can be executed at once:
+	// every one of them has to start within the budget and no interrupt may be accepted in between
+	std::uint32_t block_iterations(std::uint32_t repeat_cycles)
+	{
+		auto& bus = cpu.bus();
+		if(bus.is_set(bus::RESET) || bus.is_set(bus::BUSREQ) || bus.is_set(bus::NMI))
+			return 1;
+
+		if(cpu.registers().IFF1 != 0 && bus.is_set(bus::INT))
+			return 1;
+
+		return std::max<std::uint32_t>(1, (m_cycle_budget + repeat_cycles - 1) / repeat_cycles);
+	}
+
+	// returns the number of executed iterations
+	template <instruction inst>
+	std::uint32_t exec_block(std::uint32_t max_iterations)
 	{
 		interrupts_just_enabled = false;
 
-		switch(inst.op_type)
+		if constexpr(inst.op_type == operation_type::ldir)
+			return ops.ldir(max_iterations);
+		else if constexpr(inst.op_type == operation_type::lddr)
+			return ops.lddr(max_iterations);
+		else if constexpr(inst.op_type == operation_type::cpir)
+			return ops.cpir(max_iterations);
+		else if constexpr(inst.op_type == operation_type::cpdr)
+			return ops.cpdr(max_iterations);
+		else if constexpr(inst.op_type == operation_type::inir)
+			return ops.inir(max_iterations);
+		else if constexpr(inst.op_type == operation_type::indr)
+			return ops.indr(max_iterations);
+		else if constexpr(inst.op_type == operation_type::otir)
+			return ops.otir(max_iterations);
+		else if constexpr(inst.op_type == operation_type::otdr)
+			return ops.otdr(max_iterations);
+		else
+			static_assert(unsupported_operation<inst.op_type>);
+	}
+
+	// repeated block instructions don't advance PC till the last iteration
+	static constexpr bool is_block_repeat(operation_type op)
+	{
+		switch(op)
 		{
+		case operation_type::ldir:
+		case operation_type::lddr:
+		case operation_type::cpir:
+		case operation_type::cpdr:
+		case operation_type::inir:
+		case operation_type::indr:
+		case operation_type::otir:
+		case operation_type::otdr:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	template <instruction inst>
+	void exec()
+	{
+		interrupts_just_enabled = false;
+
 		/* 8-Bit Arithmetic Group */
-		case operation_type::add:
-			ops.add(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::adc:
-			ops.adc(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::sub:
-			ops.sub(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::sbc:
-			ops.sbc(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::and_8:
-			ops.and_8(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::or_8:
-			ops.or_8(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::xor_8:
-			ops.xor_8(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::cp:
-			ops.cp(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::inc_reg:
-			ops.inc_reg(dec.decode_reg_8(inst.source));
-			break;
-		case operation_type::dec_reg:
-			ops.dec_reg(dec.decode_reg_8(inst.source));
-			break;
-		case operation_type::inc_at:
-			ops.inc_at(dec.decode_address(inst.source, inst));
-			break;
-		case operation_type::dec_at:
-			ops.dec_at(dec.decode_address(inst.source, inst));
-			break;
+		if constexpr(inst.op_type == operation_type::add)
+			ops.add(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::adc)
+			ops.adc(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::sub)
+			ops.sub(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::sbc)
+			ops.sbc(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::and_8)
+			ops.and_8(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::or_8)
+			ops.or_8(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::xor_8)
+			ops.xor_8(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::cp)
+			ops.cp(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::inc_reg)
+			ops.inc_reg(dec.decode_reg_8<inst.source>());
+		else if constexpr(inst.op_type == operation_type::dec_reg)
+			ops.dec_reg(dec.decode_reg_8<inst.source>());
+		else if constexpr(inst.op_type == operation_type::inc_at)
+			ops.inc_at(dec.decode_address<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::dec_at)
+			ops.dec_at(dec.decode_address<inst.source, inst>());
 
 		/* 16-Bit Arithmetic Group */
-		case operation_type::add_16:
-			ops.add_16(dec.decode_reg_16(inst.source), dec.decode_reg_16(inst.destination));
-			break;
-		case operation_type::adc_hl:
-			ops.adc_hl(dec.decode_reg_16(inst.source));
-			break;
-		case operation_type::sbc_hl:
-			ops.sbc_hl(dec.decode_reg_16(inst.source));
-			break;
-		case operation_type::inc_reg_16:
-			ops.inc_reg_16(dec.decode_reg_16(inst.source));
-			break;
-		case operation_type::dec_reg_16:
-			ops.dec_reg_16(dec.decode_reg_16(inst.source));
-			break;
+		else if constexpr(inst.op_type == operation_type::add_16)
+			ops.add_16(dec.decode_reg_16<inst.source>(), dec.decode_reg_16<inst.destination>());
+		else if constexpr(inst.op_type == operation_type::adc_hl)
+			ops.adc_hl(dec.decode_reg_16<inst.source>());
+		else if constexpr(inst.op_type == operation_type::sbc_hl)
+			ops.sbc_hl(dec.decode_reg_16<inst.source>());
+		else if constexpr(inst.op_type == operation_type::inc_reg_16)
+			ops.inc_reg_16(dec.decode_reg_16<inst.source>());
+		else if constexpr(inst.op_type == operation_type::dec_reg_16)
+			ops.dec_reg_16(dec.decode_reg_16<inst.source>());
 
 		/* 8/16-Bit Load Group */
-		case operation_type::ld_reg:
-			ops.ld_reg(dec.decode_byte(inst.source, inst), dec.decode_reg_8(inst.destination));
-			break;
-		case operation_type::ld_at:
-			ops.ld_at(dec.decode_byte(inst.source, inst), dec.decode_address(inst.destination, inst));
-			break;
-		case operation_type::ld_16_at:
-			ops.ld_at(dec.decode_2_bytes(inst.source, inst), dec.decode_address(inst.destination, inst));
-			break;
-		case operation_type::ld_ir:
-			ops.ld_ir(dec.decode_reg_8(inst.source));
-			break;
-		case operation_type::ld_16_reg:
-			ops.ld_reg(dec.decode_2_bytes(inst.source, inst), dec.decode_reg_16(inst.destination));
-			break;
-		case operation_type::ld_16_reg_from:
-			ops.ld_reg_from(dec.decode_reg_16(inst.destination), dec.decode_address(inst.source, inst));
-			break;
-		case operation_type::push:
-			ops.push(dec.decode_reg_16(inst.source));
-			break;
-		case operation_type::pop:
-			ops.pop(dec.decode_reg_16(inst.destination));
-			break;
+		else if constexpr(inst.op_type == operation_type::ld_reg)
+			ops.ld_reg(dec.decode_byte<inst.source, inst>(), dec.decode_reg_8<inst.destination>());
+		else if constexpr(inst.op_type == operation_type::ld_at)
+			ops.ld_at(dec.decode_byte<inst.source, inst>(), dec.decode_address<inst.destination, inst>());
+		else if constexpr(inst.op_type == operation_type::ld_16_at)
+			ops.ld_at(dec.decode_2_bytes<inst.source, inst>(), dec.decode_address<inst.destination, inst>());
+		else if constexpr(inst.op_type == operation_type::ld_ir)
+			ops.ld_ir(dec.decode_reg_8<inst.source>());
+		else if constexpr(inst.op_type == operation_type::ld_16_reg)
+			ops.ld_reg(dec.decode_2_bytes<inst.source, inst>(), dec.decode_reg_16<inst.destination>());
+		else if constexpr(inst.op_type == operation_type::ld_16_reg_from)
+			ops.ld_reg_from(dec.decode_reg_16<inst.destination>(), dec.decode_address<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::push)
+			ops.push(dec.decode_reg_16<inst.source>());
+		else if constexpr(inst.op_type == operation_type::pop)
+			ops.pop(dec.decode_reg_16<inst.destination>());
 
 		/* Call and Return Group */
-		case operation_type::call:
-			ops.call(dec.decode_address(inst.source, inst));
-			break;
-		case operation_type::call_cc:
-			ops.call_cc(dec.decode_cc(inst), dec.decode_address(inst.source, inst));
-			break;
-		case operation_type::rst:
-			ops.rst(dec.decode_cc(inst));
-			break;
-		case operation_type::ret:
+		else if constexpr(inst.op_type == operation_type::call)
+			ops.call(dec.decode_address<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::call_cc)
+			ops.call_cc(decoder::decode_cc(inst), dec.decode_address<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::rst)
+			ops.rst(decoder::decode_cc(inst));
+		else if constexpr(inst.op_type == operation_type::ret)
 			ops.ret();
-			break;
-		case operation_type::reti:
+		else if constexpr(inst.op_type == operation_type::reti)
 			ops.reti();
-			break;
-		case operation_type::retn:
+		else if constexpr(inst.op_type == operation_type::retn)
 			ops.retn();
-			break;
-		case operation_type::ret_cc:
-			ops.ret_cc(dec.decode_cc(inst));
-			break;
+		else if constexpr(inst.op_type == operation_type::ret_cc)
+			ops.ret_cc(decoder::decode_cc(inst));
 
 		/* Jump Group */
-		case operation_type::jp:
-			ops.jp(dec.decode_2_bytes(inst.source, inst));
-			break;
-		case operation_type::jp_cc:
-			ops.jp_cc(dec.decode_cc(inst), dec.decode_address(inst.source, inst));
-			break;
-		case operation_type::jr:
-			ops.jr(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::jr_z:
-			ops.jr_z(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::jr_nz:
-			ops.jr_nz(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::jr_c:
-			ops.jr_c(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::jr_nc:
-			ops.jr_nc(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::djnz:
-			ops.djnz(dec.decode_byte(inst.source, inst));
-			break;
+		else if constexpr(inst.op_type == operation_type::jp)
+			ops.jp(dec.decode_2_bytes<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::jp_cc)
+			ops.jp_cc(decoder::decode_cc(inst), dec.decode_address<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::jr)
+			ops.jr(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::jr_z)
+			ops.jr_z(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::jr_nz)
+			ops.jr_nz(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::jr_c)
+			ops.jr_c(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::jr_nc)
+			ops.jr_nc(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::djnz)
+			ops.djnz(dec.decode_byte<inst.source, inst>());
 
 		/* CPU Control Groups */
-		case operation_type::nop:
-			break;
-		case operation_type::halt:
+		else if constexpr(inst.op_type == operation_type::nop)
+		{
+			// nothing to do
+		}
+		else if constexpr(inst.op_type == operation_type::halt)
 			ops.halt();
-			break;
-		case operation_type::di:
+		else if constexpr(inst.op_type == operation_type::di)
 			ops.di();
-			break;
-		case operation_type::ei:
+		else if constexpr(inst.op_type == operation_type::ei)
+		{
 			ops.ei();
 			interrupts_just_enabled = true;
-			break;
-		case operation_type::im0:
+		}
+		else if constexpr(inst.op_type == operation_type::im0)
 			ops.im0();
-			break;
-		case operation_type::im1:
+		else if constexpr(inst.op_type == operation_type::im1)
 			ops.im1();
-			break;
-		case operation_type::im2:
+		else if constexpr(inst.op_type == operation_type::im2)
 			ops.im2();
-			break;
 
 		/* Input and Output Group */
-		case operation_type::in:
-			ops.in(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::in_reg:
-			ops.in_reg(dec.decode_reg_8(inst.destination));
-			break;
-		case operation_type::in_c:
+		else if constexpr(inst.op_type == operation_type::in)
+			ops.in(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::in_reg)
+			ops.in_reg(dec.decode_reg_8<inst.destination>());
+		else if constexpr(inst.op_type == operation_type::in_c)
 			ops.in_c();
-			break;
-		case operation_type::ini:
+		else if constexpr(inst.op_type == operation_type::ini)
 			ops.ini();
-			break;
-		case operation_type::inir:
-			ops.inir();
-			break;
-		case operation_type::ind:
+		else if constexpr(inst.op_type == operation_type::ind)
 			ops.ind();
-			break;
-		case operation_type::indr:
-			ops.indr();
-			break;
-		case operation_type::out:
-			ops.out(dec.decode_byte(inst.source, inst));
-			break;
-		case operation_type::out_reg:
-			ops.out_reg(dec.decode_reg_8(inst.source));
-			break;
-		case operation_type::outi:
+		else if constexpr(inst.op_type == operation_type::out)
+			ops.out(dec.decode_byte<inst.source, inst>());
+		else if constexpr(inst.op_type == operation_type::out_reg)
+			ops.out_reg(dec.decode_reg_8<inst.source>());
+		else if constexpr(inst.op_type == operation_type::outi)
 			ops.outi();
-			break;
-		case operation_type::otir:
-			ops.otir();
-			break;
-		case operation_type::outd:
+		else if constexpr(inst.op_type == operation_type::outd)
 			ops.outd();
-			break;
-		case operation_type::otdr:
-			ops.otdr();
-			break;
 
 		/* Exchange, Block Transfer, and Search Group */
-		case operation_type::ex_de_hl:
+		else if constexpr(inst.op_type == operation_type::ex_de_hl)
 			ops.ex_de_hl();
-			break;
-		case operation_type::ex_af_afs:
+		else if constexpr(inst.op_type == operation_type::ex_af_afs)
 			ops.ex_af_afs();
-			break;
-		case operation_type::exx:
+		else if constexpr(inst.op_type == operation_type::exx)
 			ops.exx();
-			break;
-		case operation_type::ex_16_at:
-			ops.ex_16_at(dec.decode_reg_16(inst.source), dec.decode_address(inst.destination, inst));
-			break;
-		case operation_type::ldi:
+		else if constexpr(inst.op_type == operation_type::ex_16_at)
+			ops.ex_16_at(dec.decode_reg_16<inst.source>(), dec.decode_address<inst.destination, inst>());
+		else if constexpr(inst.op_type == operation_type::ldi)
 			ops.ldi();
-			break;
-		case operation_type::ldir:
-			ops.ldir();
-			break;
-		case operation_type::cpd:
+		else if constexpr(inst.op_type == operation_type::cpd)
 			ops.cpd();
-			break;
-		case operation_type::cpdr:
-			ops.cpdr();
-			break;
-		case operation_type::cpi:
+		else if constexpr(inst.op_type == operation_type::cpi)
 			ops.cpi();
-			break;
-		case operation_type::cpir:
-			ops.cpir();
-			break;
-		case operation_type::ldd:
+		else if constexpr(inst.op_type == operation_type::ldd)
 			ops.ldd();
-			break;
-		case operation_type::lddr:
-			ops.lddr();
-			break;
 
 		/* Rotate and Shift Group */
-		case operation_type::rlca:
+		else if constexpr(inst.op_type == operation_type::rlca)
 			ops.rlca();
-			break;
-		case operation_type::rrca:
+		else if constexpr(inst.op_type == operation_type::rrca)
 			ops.rrca();
-			break;
-		case operation_type::rla:
+		else if constexpr(inst.op_type == operation_type::rla)
 			ops.rla();
-			break;
-		case operation_type::rra:
+		else if constexpr(inst.op_type == operation_type::rra)
 			ops.rra();
-			break;
-		case operation_type::rld:
+		else if constexpr(inst.op_type == operation_type::rld)
 			ops.rld();
-			break;
-		case operation_type::rrd:
+		else if constexpr(inst.op_type == operation_type::rrd)
 			ops.rrd();
-			break;
-		case operation_type::rlc:
-			ops.rlc(dec.decode_reg_8(inst.destination));
-			break;
-		case operation_type::rlc_at:
-			ops.rlc_at(dec.decode_address(inst.destination, inst));
-			break;
-		case operation_type::rrc:
-			ops.rrc(dec.decode_reg_8(inst.destination));
-			break;
-		case operation_type::rrc_at:
-			ops.rrc_at(dec.decode_address(inst.destination, inst));
-			break;
-		case operation_type::rl:
-			ops.rl(dec.decode_reg_8(inst.destination));
-			break;
-		case operation_type::rl_at:
-			ops.rl_at(dec.decode_address(inst.destination, inst));
-			break;
-		case operation_type::rr:
-			ops.rr(dec.decode_reg_8(inst.destination));
-			break;
-		case operation_type::rr_at:
-			ops.rr_at(dec.decode_address(inst.destination, inst));
-			break;
-		case operation_type::sla:
-			ops.sla(dec.decode_reg_8(inst.destination));
-			break;
-		case operation_type::sla_at:
-			ops.sla_at(dec.decode_address(inst.destination, inst));
-			break;
-		case operation_type::sra:
-			ops.sra(dec.decode_reg_8(inst.destination));
-			break;
-		case operation_type::sra_at:
-			ops.sra_at(dec.decode_address(inst.destination, inst));
-			break;
-		case operation_type::srl:
-			ops.srl(dec.decode_reg_8(inst.destination));
-			break;
-		case operation_type::srl_at:
-			ops.srl_at(dec.decode_address(inst.destination, inst));
-			break;
-		case operation_type::sll:
-			ops.sll(dec.decode_reg_8(inst.destination));
-			break;
-		case operation_type::sll_at:
-			ops.sll_at(dec.decode_address(inst.destination, inst));
-			break;
+		else if constexpr(inst.op_type == operation_type::rlc)
+			ops.rlc(dec.decode_reg_8<inst.destination>());
+		else if constexpr(inst.op_type == operation_type::rlc_at)
+			ops.rlc_at(dec.decode_address<inst.destination, inst>());
+		else if constexpr(inst.op_type == operation_type::rrc)
+			ops.rrc(dec.decode_reg_8<inst.destination>());
+		else if constexpr(inst.op_type == operation_type::rrc_at)
+			ops.rrc_at(dec.decode_address<inst.destination, inst>());
+		else if constexpr(inst.op_type == operation_type::rl)
+			ops.rl(dec.decode_reg_8<inst.destination>());
+		else if constexpr(inst.op_type == operation_type::rl_at)
+			ops.rl_at(dec.decode_address<inst.destination, inst>());
+		else if constexpr(inst.op_type == operation_type::rr)
+			ops.rr(dec.decode_reg_8<inst.destination>());
+		else if constexpr(inst.op_type == operation_type::rr_at)
+			ops.rr_at(dec.decode_address<inst.destination, inst>());
+		else if constexpr(inst.op_type == operation_type::sla)
+			ops.sla(dec.decode_reg_8<inst.destination>());
+		else if constexpr(inst.op_type == operation_type::sla_at)
+			ops.sla_at(dec.decode_address<inst.destination, inst>());
+		else if constexpr(inst.op_type == operation_type::sra)
+			ops.sra(dec.decode_reg_8<inst.destination>());
+		else if constexpr(inst.op_type == operation_type::sra_at)
+			ops.sra_at(dec.decode_address<inst.destination, inst>());
+		else if constexpr(inst.op_type == operation_type::srl)
+			ops.srl(dec.decode_reg_8<inst.destination>());
+		else if constexpr(inst.op_type == operation_type::srl_at)
+			ops.srl_at(dec.decode_address<inst.destination, inst>());
+		else if constexpr(inst.op_type == operation_type::sll)
+			ops.sll(dec.decode_reg_8<inst.destination>());
+		else if constexpr(inst.op_type == operation_type::sll_at)
+			ops.sll_at(dec.decode_address<inst.destination, inst>());
 
 		/* Bit Set, Reset, and Test Group */
-		case operation_type::tst_bit:
-			ops.tst_bit(dec.decode_byte(inst.destination, inst), dec.decode_bit(inst.source, inst));
-			break;
-		case operation_type::tst_bit_at:
-			ops.tst_bit_at(dec.decode_address(inst.destination, inst), dec.decode_bit(inst.source, inst));
-			break;
-		case operation_type::set_bit:
-			ops.set_bit(dec.decode_reg_8(inst.destination), dec.decode_bit(inst.source, inst));
-			break;
-		case operation_type::set_bit_at:
-			ops.set_bit_at(dec.decode_address(inst.destination, inst), dec.decode_bit(inst.source, inst));
-			break;
-		case operation_type::res_bit:
-			ops.res_bit(dec.decode_reg_8(inst.destination), dec.decode_bit(inst.source, inst));
-			break;
-		case operation_type::res_bit_at:
-			ops.res_bit_at(dec.decode_address(inst.destination, inst), dec.decode_bit(inst.source, inst));
-			break;
-		case operation_type::bit_group:
-			exec_bit_group(inst);
-			break;
+		else if constexpr(inst.op_type == operation_type::tst_bit)
+			ops.tst_bit(dec.decode_byte<inst.destination, inst>(), decoder::decode_bit(inst));
+		else if constexpr(inst.op_type == operation_type::tst_bit_at)
+			ops.tst_bit_at(dec.decode_address<inst.destination, inst>(), decoder::decode_bit(inst));
+		else if constexpr(inst.op_type == operation_type::set_bit)
+			ops.set_bit(dec.decode_reg_8<inst.destination>(), decoder::decode_bit(inst));
+		else if constexpr(inst.op_type == operation_type::set_bit_at)
+			ops.set_bit_at(dec.decode_address<inst.destination, inst>(), decoder::decode_bit(inst));
+		else if constexpr(inst.op_type == operation_type::res_bit)
+			ops.res_bit(dec.decode_reg_8<inst.destination>(), decoder::decode_bit(inst));
+		else if constexpr(inst.op_type == operation_type::res_bit_at)
+			ops.res_bit_at(dec.decode_address<inst.destination, inst>(), decoder::decode_bit(inst));
 
 		/* General-Purpose Arithmetic */
-		case operation_type::daa:
+		else if constexpr(inst.op_type == operation_type::daa)
 			ops.daa();
-			break;
-		case operation_type::cpl:
+		else if constexpr(inst.op_type == operation_type::cpl)
 			ops.cpl();
-			break;
-		case operation_type::neg:
+		else if constexpr(inst.op_type == operation_type::neg)
 			ops.neg();
-			break;
-		case operation_type::ccf:
+		else if constexpr(inst.op_type == operation_type::ccf)
 			ops.ccf();
-			break;
-		case operation_type::scf:
+		else if constexpr(inst.op_type == operation_type::scf)
 			ops.scf();
-			break;
-
-		default:
-			throw std::runtime_error("exec_inst error: unsupported operation " + std::to_string(inst.op_type));
-		}
+		else
+			static_assert(unsupported_operation<inst.op_type>);
 	}
 
-	void exec_bit_group(instruction inst)
+	// DDCB/FDCB instructions, op4 is the 4th byte of the instruction
+	template <addressing_mode addr_mode, z80::opcode op4>
+	std::uint32_t exec_bit_group_op()
 	{
-		std::uint8_t imm = dec.decode_immediate<std::uint8_t>(inst);
+		constexpr instruction inst = inst_finder::find(
+			addr_mode == addressing_mode::indexed_ix ? inst_finder::page::dd : inst_finder::page::fd, 0xCB);
+		constexpr auto op_type = decoder::decode_bit_op(op4);
+		constexpr auto bit = decoder::decode_indexed_bit(op4);
+		constexpr std::uint8_t bit_reg = op4 & 0b00000111;
 
-		std::uint8_t bin_reg = imm & 0b00000111;
-		optional_reg_ref reg = std::nullopt;
+		interrupts_just_enabled = false;
 
-		if(bin_reg != 0b110)
-		{
-			reg = dec.decode_bit_reg(bin_reg);
-		}
+		// undocumented instructions also copy the result to the register
+		optional_reg_ref reg = std::nullopt;
+		if constexpr(bit_reg != 0b110)
+			reg = dec.decode_bit_reg<bit_reg>();
+
+		const auto addr = dec.decode_indexed<addr_mode>();
+
+		if constexpr(op_type == operation_type::tst_bit_at)
+			ops.tst_bit_at(addr, bit);
+		else if constexpr(op_type == operation_type::set_bit_at)
+			ops.set_bit_at(addr, bit, reg);
+		else if constexpr(op_type == operation_type::res_bit_at)
+			ops.res_bit_at(addr, bit, reg);
+		else if constexpr(op_type == operation_type::rlc_at)
+			ops.rlc_at(addr, reg);
+		else if constexpr(op_type == operation_type::rrc_at)
+			ops.rrc_at(addr, reg);
+		else if constexpr(op_type == operation_type::rl_at)
+			ops.rl_at(addr, reg);
+		else if constexpr(op_type == operation_type::rr_at)
+			ops.rr_at(addr, reg);
+		else if constexpr(op_type == operation_type::sla_at)
+			ops.sla_at(addr, reg);
+		else if constexpr(op_type == operation_type::sra_at)
+			ops.sra_at(addr, reg);
+		else if constexpr(op_type == operation_type::srl_at)
+			ops.srl_at(addr, reg);
+		else if constexpr(op_type == operation_type::sll_at)
+			ops.sll_at(addr, reg);
+		else
+			static_assert(unsupported_operation<op_type>);
 
-		auto op_type = dec.decode_bit_op(inst);
-		switch(op_type)
-		{
-		case operation_type::tst_bit_at:
-			ops.tst_bit_at(dec.decode_address(inst.destination, inst), dec.decode_bit(inst.source, inst));
-			break;
-		case operation_type::set_bit_at:
-			ops.set_bit_at(dec.decode_address(inst.destination, inst), dec.decode_bit(inst.source, inst), reg);
-			break;
-		case operation_type::res_bit_at:
-			ops.res_bit_at(dec.decode_address(inst.destination, inst), dec.decode_bit(inst.source, inst), reg);
-			break;
-
-		case operation_type::rlc_at:
-			ops.rlc_at(dec.decode_address(inst.destination, inst), reg);
-			break;
-		case operation_type::rrc_at:
-			ops.rrc_at(dec.decode_address(inst.destination, inst), reg);
-			break;
-		case operation_type::rl_at:
-			ops.rl_at(dec.decode_address(inst.destination, inst), reg);
-			break;
-		case operation_type::rr_at:
-			ops.rr_at(dec.decode_address(inst.destination, inst), reg);
-			break;
-		case operation_type::sla_at:
-			ops.sla_at(dec.decode_address(inst.destination, inst), reg);
-			break;
-		case operation_type::sra_at:
-			ops.sra_at(dec.decode_address(inst.destination, inst), reg);
-			break;
-		case operation_type::srl_at:
-			ops.srl_at(dec.decode_address(inst.destination, inst), reg);
-			break;
-		case operation_type::sll_at:
-			ops.sll_at(dec.decode_address(inst.destination, inst), reg);
-			break;
-		default:
-			throw std::runtime_error("exec_bit_group error: unsupported operation " + std::to_string(op_type));
-		}
+		dec.advance_pc<inst>();
+		return timings::indexed_bit_cycles(op4);
 	}
 
 	// TODO: move to decoder?
-	bool need_advance_pc(operation_type op)
+	static constexpr bool need_advance_pc(operation_type op)
 	{
 		switch(op)
 		{
@@ -507,14 +629,15 @@ private:
 		}
 	}
 
-	bool check_interrupts()
+	// returns the number of T-states taken to accept the interrupt, 0 if no interrupt is accepted
+	std::uint32_t check_interrupts()
 	{
 		auto& bus = cpu.bus();
 
 		if(bus.is_set(bus::BUSREQ))
 		{
 			// no interrupts if BUSREQ is set
-			return false;
+			return 0;
 		}
 
 		if(bus.is_set(bus::NMI))
@@ -523,59 +646,65 @@ private:
 			// TODO: should we clear NMI? Or somehow indicate interrupt is processing
 			// otherwise we going to handle the same interrupt second time on the next cycle
 			throw std::runtime_error("check_interrupts nonmaskable interrupts are not implmeneted properly");
-			return true;
+			return nmi_cycles;
 		}
 
 		if(interrupts_just_enabled)
 		{
 			// we have to execute 1 instruction after enabling interrupts
-			return false;
+			return 0;
 		}
 
 		if(cpu.registers().IFF1 == 0)
 		{
 			// maskable interrupts are disabled
-			return false;
+			return 0;
 		}
 
 		if(bus.is_set(bus::INT))
 		{
 			// we had to accept interrupt first, then wait till get data,
 			// but for simplicity assume data already on the bus
-			exec_maskable_interrupt(bus.get_data());
-			return true;
+			return exec_maskable_interrupt(bus.get_data());
 		}
 
-		return false;
+		return 0;
 	}
 
-	void exec_maskable_interrupt(std::uint8_t data)
+	std::uint32_t exec_maskable_interrupt(std::uint8_t data)
 	{
 		switch(cpu.interrupt_mode())
 		{
-		case cpu_interrupt_mode::im0: {
+		case cpu_interrupt_mode::im0:
 			ops.maskable_interrupt_m0();
-			instruction inst = finder.fast_search(data);
-			exec(inst);
-			break;
-		}
+			return m_dispatch_table.im0[data](*this);
 		case cpu_interrupt_mode::im1:
 			ops.maskable_interrupt_m1();
-			break;
+			return timings::im1_cycles;
 		case cpu_interrupt_mode::im2:
 			ops.maskable_interrupt_m2(data);
-			break;
+			return timings::im2_cycles;
 		default:
 			throw std::runtime_error("exec_maskable_interrupt internal error: unknown interrupt mode");
 		}
 	}
 
+	// must be defined after all the handlers, so the table can be built at compile time
+	static const dispatch_table& get_dispatch_table()
+	{
+		static constexpr dispatch_table table = build_dispatch_table();
+		return table;
+	}
+
 private:
 	z80::cpu& cpu;
 	z80::decoder dec;
 	z80::operations ops;
-	z80::inst_finder finder;
+	const dispatch_table& m_dispatch_table;
 	bool interrupts_just_enabled = false;
+
+	// T-states left in the current execute call (including the current instruction)
+	std::uint32_t m_cycle_budget = 0;
 };
 
 } // namespace genesis::z80
@@ -2,18 +2,23 @@
 #define __INST_FINDER_HPP__
 
 #include "instructions.hpp"
+#include "timings.hpp"
 
 #include <array>
 #include <cstdint>
+#include <stdexcept>
 
 
 namespace genesis::z80
 {
 
+/* Flattened instruction table built at compile time from the instructions list:
+ * 256 entries for every opcode page (no prefix, DD, FD, ED, CB), annotated with T-states.
+ * Opcodes missing from the list act as NOP of the page instruction size. */
 class inst_finder
 {
-private:
-	enum map_index
+public:
+	enum page : std::uint8_t
 	{
 		single,
 		dd,
@@ -22,128 +27,79 @@ private:
 		cb,
 		count,
 	};
-	constexpr static std::uint16_t no_index = 0xFFFF;
+
+	static constexpr std::size_t page_size = 0x100;
+
+private:
+	using instruction_table = std::array<instruction, page::count * page_size>;
+
+	// prefix of every page, single page has no prefix
+	static constexpr std::array<z80::opcode, page::count> prefixes = {0x00, 0xDD, 0xFD, 0xED, 0xCB};
 
 public:
-	inst_finder()
-	{
-		build_maps();
-	}
+	inst_finder() = delete;
 
-	instruction fast_search(z80::opcode op1)
+	static constexpr const instruction& find(page p, z80::opcode op)
 	{
-		switch(op1)
-		{
-		case 0xDD:
-		case 0xFD:
-		case 0xED:
-		case 0xCB:
-			throw std::runtime_error("fast_search error: 2 byte instruction prefix was supplied");
-		}
-
-		return fast_search(op1, 0x00);
+		return table[p * page_size + op];
 	}
 
-	instruction fast_search(z80::opcode op1, z80::opcode op2)
+	// returns the page selected by the prefix, single if op is not a prefix
+	static constexpr page prefix_page(z80::opcode op)
 	{
-		std::uint16_t idx = no_index;
-		switch(op1)
-		{
-		case 0xDD:
-			idx = get_idx(map_index::dd, op2);
-			break;
-		case 0xFD:
-			idx = get_idx(map_index::fd, op2);
-			break;
-		case 0xED:
-			idx = get_idx(map_index::ed, op2);
-			break;
-		case 0xCB:
-			idx = get_idx(map_index::cb, op2);
-			break;
-		default:
-			idx = get_idx(map_index::single, op1);
-			break;
-		}
-
-		// TODO: test-only
-		if(idx == no_index)
-			return make_nop(op1, op2);
-
-		// self-check
-		auto inst = instructions[idx];
-		if(op1 != inst.opcodes[0] || (inst.opcodes[1] != 0x0 && inst.opcodes[1] != op2))
+		for(std::uint8_t p = page::dd; p < page::count; ++p)
 		{
-			throw std::runtime_error("internal error: self-check failed, we popped up a wrong instruction!");
+			if(prefixes[p] == op)
+				return static_cast<page>(p);
 		}
 
-		return instructions[idx];
+		return page::single;
 	}
 
 private:
-	instruction make_nop(z80::opcode op1, z80::opcode op2)
-	{
-		return {operation_type::nop, {op1, op2}, addressing_mode::none, addressing_mode::none};
-	}
+	static constexpr instruction_table table = []() {
+		instruction_table res{};
+		std::array<bool, page::count * page_size> taken{};
 
-	void build_maps()
-	{
-		for(auto& map : maps)
+		for(std::size_t p = 0; p < page::count; ++p)
 		{
-			for(auto& idx : map)
-				idx = no_index;
+			for(std::size_t op = 0; op < page_size; ++op)
+			{
+				// TODO: prefixed opcodes missing from the list should act as a prefix + unprefixed instruction
+				instruction nop{operation_type::nop, {prefixes[p], static_cast<z80::opcode>(op)},
+								addressing_mode::none, addressing_mode::none};
+				if(p == page::single)
+					nop.opcodes = {static_cast<z80::opcode>(op), 0x00};
+
+				nop.cycles = timings::cycles(nop.opcodes[0], nop.opcodes[1]);
+				res[p * page_size + op] = nop;
+			}
 		}
 
-		for(std::uint16_t i = 0; i < std::size(instructions); ++i)
+		for(auto inst : instructions)
 		{
-			auto& inst = instructions[i];
-			switch(inst.opcodes[0])
+			std::size_t p = page::single;
+			for(std::size_t prefixed = page::dd; prefixed < page::count; ++prefixed)
 			{
-			case 0xDD:
-				store_idx(map_index::dd, i, inst.opcodes[1]);
-				break;
-			case 0xFD:
-				store_idx(map_index::fd, i, inst.opcodes[1]);
-				break;
-			case 0xED:
-				store_idx(map_index::ed, i, inst.opcodes[1]);
-				break;
-			case 0xCB:
-				store_idx(map_index::cb, i, inst.opcodes[1]);
-				break;
-			default:
-				// so far assume it's 1 byte opcode
-				if(inst.opcodes[1] != 0x00)
-				{
-					throw std::runtime_error("build_maps internal error: unknown 2 byte opcode");
-				}
-				store_idx(map_index::single, i, inst.opcodes[0]);
+				if(prefixes[prefixed] == inst.opcodes[0])
+					p = prefixed;
 			}
-		}
-	}
 
-	void store_idx(map_index map_idx, std::uint16_t inst_idx, z80::opcode op)
-	{
-		auto& map = maps[map_idx];
-		if(map[op] != no_index)
-		{
-			throw std::runtime_error(
-				"store_idx error: failed to save instruction index - the position is already taken (map " +
-				std::to_string(map_idx) + ", op2 " + std::to_string(op) + ")");
-		}
+			// so far assume it's 1 byte opcode
+			if(p == page::single && inst.opcodes[1] != 0x00)
+				throw std::logic_error("inst_finder internal error: unknown 2 byte opcode");
 
-		map[op] = inst_idx;
-	}
+			const std::size_t idx = p * page_size + (p == page::single ? inst.opcodes[0] : inst.opcodes[1]);
+			if(taken[idx])
+				throw std::logic_error("inst_finder error: the position is already taken");
 
-	std::uint16_t get_idx(map_index map_idx, z80::opcode op)
-	{
-		return maps[map_idx][op];
-	}
+			inst.cycles = timings::cycles(inst.opcodes[0], inst.opcodes[1]);
+			res[idx] = inst;
+			taken[idx] = true;
+		}
 
-private:
-	// isn't it too much for the stack?
-	using map = std::array<std::uint16_t, 0x100>;
-	std::array<map, map_index::count> maps;
+		return res;
+	}();
 };
 
 } // namespace genesis::z80
@@ -202,9 +202,12 @@ public:
 
 	addressing_mode source;
 	addressing_mode destination;
+
+	// T-states (see timings), filled by inst_finder
+	std::uint8_t cycles = 0;
 };
 
-const instruction instructions[] = {
+constexpr instruction instructions[] = {
 	{operation_type::add, {0x87}, addressing_mode::register_a, addressing_mode::implied},
 	{operation_type::add, {0x80}, addressing_mode::register_b, addressing_mode::implied},
 	{operation_type::add, {0x81}, addressing_mode::register_c, addressing_mode::implied},
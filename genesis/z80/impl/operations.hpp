@@ -5,6 +5,7 @@
 #include "string_utils.hpp"
 #include "z80/cpu.h"
 
+#include <algorithm>
 #include <bit>
 #include <cstdint>
 #include <iostream>
@@ -803,6 +804,80 @@ public:
 		}
 	}
 
+	/* Repeated block instructions, several iterations at once.
+	 * Run up to max_iterations iterations (at least 1) and return the number of executed ones,
+	 * the result is the same as executing the instruction that many times.
+	 * Flags depend on the last iteration only, so all the previous ones just move the data. */
+	std::uint32_t ldir(std::uint32_t max_iterations)
+	{
+		auto count = std::min({max_iterations, block_length(regs.main_set.BC), iterations_till_overwrite<1>(regs.main_set.DE)});
+		move_block<1>(count - 1);
+		ldir();
+		return count;
+	}
+
+	std::uint32_t lddr(std::uint32_t max_iterations)
+	{
+		auto count = std::min({max_iterations, block_length(regs.main_set.BC), iterations_till_overwrite<-1>(regs.main_set.DE)});
+		move_block<-1>(count - 1);
+		lddr();
+		return count;
+	}
+
+	// the iteration which finds the match is the last one
+	std::uint32_t cpir(std::uint32_t max_iterations)
+	{
+		auto count = std::min(max_iterations, block_length(regs.main_set.BC));
+		count = skip_mismatched<1>(count - 1) + 1;
+		cpir();
+		return count;
+	}
+
+	std::uint32_t cpdr(std::uint32_t max_iterations)
+	{
+		auto count = std::min(max_iterations, block_length(regs.main_set.BC));
+		count = skip_mismatched<-1>(count - 1) + 1;
+		cpdr();
+		return count;
+	}
+
+	// I/O has side effects, so every iteration accesses the port
+	std::uint32_t inir(std::uint32_t max_iterations)
+	{
+		auto count = std::min({max_iterations, io_block_length(), iterations_till_overwrite<1>(regs.main_set.HL)});
+		for(std::uint32_t i = 1; i < count; ++i)
+			ini();
+		inir();
+		return count;
+	}
+
+	std::uint32_t indr(std::uint32_t max_iterations)
+	{
+		auto count = std::min({max_iterations, io_block_length(), iterations_till_overwrite<-1>(regs.main_set.HL)});
+		for(std::uint32_t i = 1; i < count; ++i)
+			ind();
+		indr();
+		return count;
+	}
+
+	std::uint32_t otir(std::uint32_t max_iterations)
+	{
+		auto count = std::min(max_iterations, io_block_length());
+		for(std::uint32_t i = 1; i < count; ++i)
+			outi();
+		otir();
+		return count;
+	}
+
+	std::uint32_t otdr(std::uint32_t max_iterations)
+	{
+		auto count = std::min(max_iterations, io_block_length());
+		for(std::uint32_t i = 1; i < count; ++i)
+			outd();
+		otdr();
+		return count;
+	}
+
 	/* Rotate and Shift Group */
 	inline void rlca()
 	{
@@ -1298,6 +1373,121 @@ private:
 		regs.main_set.flags.Y = (n & 0b00000010) >> 1;
 	}
 
+private:
+	// number of iterations left (BC = 0 means 64K)
+	static std::uint32_t block_length(std::uint16_t bc)
+	{
+		return bc == 0 ? 0x10000 : bc;
+	}
+
+	// number of iterations left (B = 0 means 256)
+	std::uint32_t io_block_length() const
+	{
+		std::uint8_t b = regs.main_set.B;
+		return b == 0 ? 0x100 : b;
+	}
+
+	// number of iterations writing from dest in the Step direction till the one which overwrites
+	// the block instruction itself (including it), the instruction has to be fetched again after that.
+	// RAM (0x0000-0x1FFF) is mirrored at 0x2000-0x3FFF, so the instruction may be overwritten via either alias.
+	template <int Step>
+	std::uint32_t iterations_till_overwrite(std::uint16_t dest) const
+	{
+		auto iterations = [dest](std::uint16_t inst_byte) -> std::uint32_t {
+			std::uint32_t res = static_cast<std::uint16_t>((inst_byte - dest) * Step) + 1u;
+			if(inst_byte < 0x4000)
+			{
+				const std::uint16_t alias = inst_byte ^ 0x2000;
+				res = std::min(res, static_cast<std::uint16_t>((alias - dest) * Step) + 1u);
+			}
+			return res;
+		};
+
+		const std::uint16_t pc = regs.PC;
+		return std::min(iterations(pc), iterations(static_cast<std::uint16_t>(pc + 1)));
+	}
+
+	// host memory backing n bytes from addr in the Step direction, nullptr if it's not plain memory
+	template <int Step>
+	std::uint8_t* direct_block(std::uint16_t addr, std::uint32_t n, bool writable)
+	{
+		std::int32_t first = Step > 0 ? addr : addr - static_cast<std::int32_t>(n) + 1;
+		if(first < 0)
+			return nullptr;
+
+		auto data = mem.direct_range(static_cast<std::uint32_t>(first), first + n - 1, writable);
+		return data == nullptr ? nullptr : data + (addr - first);
+	}
+
+	static std::int16_t advance(std::int16_t reg, std::int32_t offset)
+	{
+		return static_cast<std::int16_t>(static_cast<std::uint16_t>(reg + offset));
+	}
+
+	// moves n bytes from (HL) to (DE) byte by byte (as LDI/LDD does), but doesn't affect flags
+	template <int Step>
+	void move_block(std::uint32_t n)
+	{
+		if(n == 0)
+			return;
+
+		std::uint16_t src = regs.main_set.HL;
+		std::uint16_t dest = regs.main_set.DE;
+
+		auto src_data = direct_block<Step>(src, n, false);
+		auto dest_data = direct_block<Step>(dest, n, true);
+		if(src_data != nullptr && dest_data != nullptr)
+		{
+			// blocks may overlap, so don't use memmove (i.e. LDIR with DE = HL + 1 fills the memory)
+			for(std::int32_t i = 0; i < static_cast<std::int32_t>(n); ++i)
+				dest_data[i * Step] = src_data[i * Step];
+		}
+		else
+		{
+			for(std::uint32_t i = 0; i < n; ++i)
+			{
+				mem.write(dest, mem.read<std::int8_t>(src));
+				src = static_cast<std::uint16_t>(src + Step);
+				dest = static_cast<std::uint16_t>(dest + Step);
+			}
+		}
+
+		const std::int32_t offset = Step * static_cast<std::int32_t>(n);
+		regs.main_set.HL = advance(regs.main_set.HL, offset);
+		regs.main_set.DE = advance(regs.main_set.DE, offset);
+		regs.main_set.BC = advance(regs.main_set.BC, -static_cast<std::int32_t>(n));
+	}
+
+	// skips up to n bytes from (HL) which don't match A (as CPI/CPD does), but doesn't affect flags
+	// returns the number of skipped bytes
+	template <int Step>
+	std::uint32_t skip_mismatched(std::uint32_t n)
+	{
+		const std::uint8_t a = regs.main_set.A;
+		std::uint16_t addr = regs.main_set.HL;
+
+		std::uint32_t skipped = 0;
+		if(auto data = direct_block<Step>(addr, n, false))
+		{
+			while(skipped < n && data[static_cast<std::int32_t>(skipped) * Step] != a)
+				++skipped;
+		}
+		else
+		{
+			while(skipped < n && mem.read<std::uint8_t>(addr) != a)
+			{
+				++skipped;
+				addr = static_cast<std::uint16_t>(addr + Step);
+			}
+		}
+
+		const std::int32_t offset = Step * static_cast<std::int32_t>(skipped);
+		regs.main_set.HL = advance(regs.main_set.HL, offset);
+		regs.main_set.BC = advance(regs.main_set.BC, -static_cast<std::int32_t>(skipped));
+
+		return skipped;
+	}
+
 private:
 	z80::memory& mem;
 	z80::cpu_registers& regs;
@@ -0,0 +1,174 @@
+#ifndef __Z80_TIMINGS_HPP__
+#define __Z80_TIMINGS_HPP__
+
+#include "instructions.hpp"
+
+#include <array>
+#include <cstdint>
+
+
+namespace genesis::z80
+{
+
+/* Returns the amount of T-states per instruction.
+ * Conditional instructions take the base amount if the condition is not met (or the block instruction
+ * is not repeated), extra_cycles() is added otherwise. */
+class timings
+{
+private:
+	using table = std::array<std::uint8_t, 0x100>;
+
+public:
+	timings() = delete;
+
+	// op2 is only used for prefixed instructions (DD, FD, ED, CB)
+	static constexpr std::uint8_t cycles(z80::opcode op1, z80::opcode op2)
+	{
+		switch(op1)
+		{
+		case 0xDD:
+		case 0xFD:
+			if(op2 == 0xCB)
+				return indexed_bit_table[0x00]; // the exact value depends on the 4th byte
+			return indexed_table[op2];
+		case 0xED:
+			return ed_table[op2];
+		case 0xCB:
+			return cb_table[op2];
+		default:
+			return main_table[op1];
+		}
+	}
+
+	// DDCB/FDCB instructions, op4 is the 4th byte of the instruction
+	static constexpr std::uint8_t indexed_bit_cycles(z80::opcode op4)
+	{
+		return indexed_bit_table[op4];
+	}
+
+	// T-states added if the condition is met or the block instruction is repeated
+	static constexpr std::uint8_t extra_cycles(operation_type op)
+	{
+		switch(op)
+		{
+		case operation_type::jr_z:
+		case operation_type::jr_nz:
+		case operation_type::jr_c:
+		case operation_type::jr_nc:
+		case operation_type::djnz:
+		case operation_type::ldir:
+		case operation_type::lddr:
+		case operation_type::cpir:
+		case operation_type::cpdr:
+		case operation_type::inir:
+		case operation_type::indr:
+		case operation_type::otir:
+		case operation_type::otdr:
+			return 5;
+		case operation_type::call_cc:
+			return 7;
+		case operation_type::ret_cc:
+			return 6;
+		default:
+			return 0;
+		}
+	}
+
+	// T-states to accept maskable interrupt in IM1/IM2
+	static constexpr std::uint8_t im1_cycles = 13;
+	static constexpr std::uint8_t im2_cycles = 19;
+
+	// IM0 executes the instruction from the data bus, it takes 2 extra T-states
+	static constexpr std::uint8_t im0_extra_cycles = 2;
+
+private:
+	// clang-format off
+	static constexpr table main_table = {
+	//  0   1   2   3   4   5   6   7   8   9   A   B   C   D   E   F
+		4, 10,  7,  6,  4,  4,  7,  4,  4, 11,  7,  6,  4,  4,  7,  4, // 0
+		8, 10,  7,  6,  4,  4,  7,  4, 12, 11,  7,  6,  4,  4,  7,  4, // 1
+		7, 10, 16,  6,  4,  4,  7,  4,  7, 11, 16,  6,  4,  4,  7,  4, // 2
+		7, 10, 13,  6, 11, 11, 10,  4,  7, 11, 13,  6,  4,  4,  7,  4, // 3
+		4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4, // 4
+		4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4, // 5
+		4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4, // 6
+		7,  7,  7,  7,  7,  7,  4,  7,  4,  4,  4,  4,  4,  4,  7,  4, // 7
+		4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4, // 8
+		4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4, // 9
+		4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4, // A
+		4,  4,  4,  4,  4,  4,  7,  4,  4,  4,  4,  4,  4,  4,  7,  4, // B
+		5, 10, 10, 10, 10, 11,  7, 11,  5, 10, 10,  0, 10, 17,  7, 11, // C
+		5, 10, 10, 11, 10, 11,  7, 11,  5,  4, 10, 11, 10,  0,  7, 11, // D
+		5, 10, 10, 19, 10, 11,  7, 11,  5,  4, 10,  4, 10,  0,  7, 11, // E
+		5, 10, 10,  4, 10, 11,  7, 11,  5,  6, 10,  4, 10,  0,  7, 11, // F
+	};
+
+	// undocumented ED instructions act as 8 T-states NOP
+	static constexpr table ed_table = {
+	//  0   1   2   3   4   5   6   7   8   9   A   B   C   D   E   F
+		8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8, // 0
+		8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8, // 1
+		8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8, // 2
+		8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8, // 3
+	   12, 12, 15, 20,  8, 14,  8,  9, 12, 12, 15, 20,  8, 14,  8,  9, // 4
+	   12, 12, 15, 20,  8, 14,  8,  9, 12, 12, 15, 20,  8, 14,  8,  9, // 5
+	   12, 12, 15, 20,  8, 14,  8, 18, 12, 12, 15, 20,  8, 14,  8, 18, // 6
+	   12, 12, 15, 20,  8, 14,  8,  8, 12, 12, 15, 20,  8, 14,  8,  8, // 7
+		8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8, // 8
+		8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8, // 9
+	   16, 16, 16, 16,  8,  8,  8,  8, 16, 16, 16, 16,  8,  8,  8,  8, // A
+	   16, 16, 16, 16,  8,  8,  8,  8, 16, 16, 16, 16,  8,  8,  8,  8, // B
+		8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8, // C
+		8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8, // D
+		8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8, // E
+		8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8,  8, // F
+	};
+	// clang-format on
+
+	// register operations take 8 T-states, (HL) - 15, BIT n,(HL) - 12
+	static constexpr table cb_table = []() {
+		table res{};
+		for(unsigned op = 0; op < res.size(); ++op)
+		{
+			if((op & 0b111) != 0b110)
+				res[op] = 8;
+			else
+				res[op] = (op >> 6) == 0b01 ? 12 : 15;
+		}
+		return res;
+	}();
+
+	// DD/FD prefix adds 4 T-states, except instructions with (IX+d)/(IY+d) operand
+	static constexpr table indexed_table = []() {
+		table res{};
+		for(unsigned op = 0; op < res.size(); ++op)
+		{
+			// LD r,(IX+d) / LD (IX+d),r / ALU (IX+d), 0x76 is HALT
+			const bool load_or_alu = (op >= 0x40 && op <= 0xBF && (op & 0b111) == 0b110) || (op >= 0x70 && op <= 0x77);
+
+			if(op == 0xCB)
+				res[op] = 0; // DDCB/FDCB prefix
+			else if(op == 0x34 || op == 0x35)
+				res[op] = 23; // INC/DEC (IX+d)
+			else if(op == 0x36)
+				res[op] = 19; // LD (IX+d),n
+			else if(load_or_alu && op != 0x76)
+				res[op] = 19;
+			else
+				res[op] = static_cast<std::uint8_t>(main_table[op] + 4);
+		}
+		return res;
+	}();
+
+	// BIT n,(IX+d) takes 20 T-states, all the others - 23
+	static constexpr table indexed_bit_table = []() {
+		table res{};
+		for(unsigned op = 0; op < res.size(); ++op)
+			res[op] = (op >> 6) == 0b01 ? 20 : 23;
+		return res;
+	}();
+};
+
+} // namespace genesis::z80
+
+#endif // __Z80_TIMINGS_HPP__
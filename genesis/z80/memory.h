@@ -5,6 +5,7 @@
 #include "memory/addressable.h"
 #include "memory/memory_unit.h"
 
+#include <array>
 #include <memory>
 
 namespace genesis::z80
@@ -25,6 +26,8 @@ public:
 
 		// if(addressable->max_address() < 0xFFFF)
 		// throw genesis::internal_error();
+
+		build_pages();
 	}
 
 	// Use this default constructable objects for backword compatability
@@ -37,6 +40,11 @@ public:
 	{
 		static_assert(sizeof(T) == 1 || sizeof(T) == 2);
 
+		// fast path: plain memory (word must not cross the page boundary)
+		auto& page = m_pages[addr >> page_bits];
+		if(page.data != nullptr && (sizeof(T) == 1 || (addr & page_mask) != page_mask))
+			return page.read<T>(addr);
+
 		// assume the result is available immediately, should be good enough for now
 		if constexpr(sizeof(T) == 1)
 		{
@@ -55,14 +63,57 @@ public:
 	{
 		static_assert(sizeof(T) == 1 || sizeof(T) == 2);
 
+		auto& page = m_pages[addr >> page_bits];
+		if(page.writable && (sizeof(T) == 1 || (addr & page_mask) != page_mask))
+		{
+			page.write<T>(addr, data);
+			return;
+		}
+
 		if constexpr(sizeof(T) == 1)
 			addressable->init_write(addr, std::uint8_t(data));
 		else
 			addressable->init_write(addr, std::uint16_t(data));
 	}
 
+	// host memory backing [first; last] if the whole range is plain memory (writable if requested),
+	// nullptr otherwise (the range has to be accessed byte by byte via read/write)
+	std::uint8_t* direct_range(std::uint32_t first, std::uint32_t last, bool writable)
+	{
+		if(first > last || last > max_address)
+			return nullptr;
+
+		auto& page = m_pages[first >> page_bits];
+		if(page.data == nullptr || !page.contains(first, last) || (writable && !page.writable))
+			return nullptr;
+
+		return page.data + (first - page.first_address);
+	}
+
 private:
+	void build_pages()
+	{
+		for(std::uint32_t page = 0; page < m_pages.size(); ++page)
+		{
+			std::uint32_t first = page << page_bits;
+			std::uint32_t last = first + page_mask;
+
+			auto region = addressable->direct_access(first);
+			if(region.has_value() && region->contains(first, last))
+				m_pages[page] = region.value();
+			else
+				m_pages[page] = {nullptr, first, last, std::endian::native, false};
+		}
+	}
+
+private:
+	static constexpr std::uint32_t page_bits = 8;
+	static constexpr std::uint32_t page_mask = (1 << page_bits) - 1;
+
 	std::shared_ptr<genesis::memory::addressable> addressable;
+
+	// directly accessible memory per page, data is nullptr if page has to be accessed via addressable
+	std::array<genesis::memory::direct_region, ((max_address + 1) >> page_bits)> m_pages;
 };
 
 } // namespace genesis::z80
@@ -0,0 +1,25 @@
+#ifndef __TEST_COMPRESSED_PATTERN_H__
+#define __TEST_COMPRESSED_PATTERN_H__
+
+#include <cstdint>
+#include <vector>
+
+
+namespace genesis::test
+{
+
+// data behind the deflate streams and archives of the inflate/ROM tests,
+// repetitive enough to be compressed with back references and of odd size
+inline std::vector<std::uint8_t> compressed_pattern()
+{
+	const char pattern[] = "GENESIS ROM TEST";
+
+	std::vector<std::uint8_t> data(0x801);
+	for(std::size_t i = 0; i < data.size(); ++i)
+		data[i] = pattern[i % 16] ^ static_cast<std::uint8_t>(i >> 8);
+	return data;
+}
+
+} // namespace genesis::test
+
+#endif // __TEST_COMPRESSED_PATTERN_H__
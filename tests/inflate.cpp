@@ -0,0 +1,113 @@
+#include "helpers/compressed_pattern.h"
+#include "inflate.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+using namespace genesis;
+
+
+namespace deflate_data
+{
+
+// raw deflate streams of compressed_pattern(), generated with zlib (level 9, default and fixed strategies)
+const std::array<std::uint8_t, 118> dynamic_block = {
+	0xe5, 0xc7, 0x45, 0x01, 0xc4, 0x40, 0x0c, 0x00, 0x40, 0x2b, 0xed, 0x95, 0x6c, 0x2c, 0x33, 0x26,
+	0x0b, 0xfe, 0x9d, 0x9c, 0x90, 0xcc, 0x6f, 0xac, 0x2e, 0x1a, 0x3d, 0x1e, 0x50, 0xf3, 0x31, 0x34,
+	0x0e, 0x4b, 0xec, 0x46, 0x55, 0x05, 0x0e, 0x4e, 0x2c, 0xe9, 0x9c, 0x0a, 0x26, 0xb5, 0x6b, 0x9b,
+	0x6c, 0x8f, 0xfd, 0xd7, 0x72, 0xfd, 0x2d, 0xdb, 0x17, 0xb5, 0x2b, 0x93, 0x4d, 0x0b, 0xed, 0xea,
+	0xa9, 0x5c, 0xdb, 0xb4, 0x4d, 0xed, 0x92, 0x07, 0xbe, 0xf3, 0xbe, 0x57, 0xf4, 0x77, 0xe3, 0xbb,
+	0x51, 0xbb, 0x60, 0x91, 0xad, 0xb4, 0x9e, 0x1d, 0xdc, 0xd3, 0xd9, 0xea, 0xd4, 0xce, 0xa5, 0x93,
+	0xb3, 0xce, 0x77, 0xf8, 0xf8, 0x82, 0x9c, 0x40, 0xed, 0x4c, 0x78, 0x31, 0xca, 0xf8, 0xa6, 0x0b,
+	0x1f, 0x8a, 0x81, 0xd4, 0x5e, 0xff};
+
+const std::array<std::uint8_t, 152> fixed_block = {
+	0x73, 0x77, 0xf5, 0x73, 0x0d, 0xf6, 0x0c, 0x56, 0x08, 0xf2, 0xf7, 0x55, 0x08, 0x71, 0x0d, 0x0e,
+	0x71, 0x1f, 0x61, 0x7c, 0x37, 0x17, 0x7f, 0x97, 0x20, 0x8f, 0x20, 0xc5, 0x60, 0x3f, 0x1f, 0xc5,
+	0x50, 0x97, 0xa0, 0xd0, 0x91, 0xc6, 0x77, 0x75, 0xf7, 0x71, 0x0f, 0xf4, 0x0e, 0x54, 0x0a, 0xf0,
+	0xf5, 0x57, 0x0a, 0x73, 0x0f, 0x0c, 0x1b, 0x69, 0x7c, 0x17, 0x37, 0x5f, 0xb7, 0x00, 0xaf, 0x00,
+	0xe5, 0x40, 0x1f, 0x3f, 0xe5, 0x70, 0xb7, 0x80, 0xf0, 0x91, 0xc6, 0x77, 0x76, 0xf4, 0x72, 0x0c,
+	0xf7, 0x0d, 0x57, 0x09, 0xf3, 0xf6, 0x54, 0x09, 0x70, 0x0c, 0x0f, 0x18, 0x69, 0x7c, 0x27, 0x07,
+	0x6f, 0x87, 0x30, 0x9f, 0x30, 0xd5, 0x70, 0x2f, 0x0f, 0xd5, 0x40, 0x87, 0xb0, 0xc0, 0x91, 0xc6,
+	0x77, 0x74, 0xf6, 0x70, 0x0e, 0xf5, 0x0f, 0x55, 0x0b, 0xf1, 0xf4, 0x56, 0x0b, 0x72, 0x0e, 0x0d,
+	0x1a, 0x69, 0x7c, 0x07, 0x27, 0x4f, 0xa7, 0x10, 0xbf, 0x10, 0xf5, 0x50, 0x0f, 0x2f, 0xf5, 0x60,
+	0xa7, 0x90, 0xe0, 0x91, 0xc6, 0xf7, 0x07, 0x00};
+
+} // namespace deflate_data
+
+void check_inflate(std::span<const std::uint8_t> input)
+{
+	auto expected = test::compressed_pattern();
+
+	std::vector<std::uint8_t> output(expected.size());
+	ASSERT_EQ(expected.size(), genesis::inflate(input, output));
+	ASSERT_EQ(expected, output);
+}
+
+TEST(INFLATE, DYNAMIC_BLOCK)
+{
+	check_inflate(deflate_data::dynamic_block);
+}
+
+TEST(INFLATE, FIXED_BLOCK)
+{
+	check_inflate(deflate_data::fixed_block);
+}
+
+TEST(INFLATE, STORED_BLOCK)
+{
+	auto expected = test::compressed_pattern();
+
+	// split data into 2 stored blocks
+	std::vector<std::uint8_t> input;
+	input.reserve(expected.size() + 10);
+
+	auto add_block = [&](std::size_t offset, std::size_t size, bool last) {
+		input.push_back(last ? 1 : 0);
+		input.push_back(size & 0xFF);
+		input.push_back(size >> 8);
+		input.push_back(~size & 0xFF);
+		input.push_back((~size >> 8) & 0xFF);
+		input.insert(input.end(), expected.begin() + offset, expected.begin() + offset + size);
+	};
+
+	add_block(0, 0x100, false);
+	add_block(0x100, expected.size() - 0x100, true);
+
+	check_inflate(input);
+}
+
+TEST(INFLATE, SMALL_OUTPUT_BUFFER)
+{
+	std::vector<std::uint8_t> output(test::compressed_pattern().size() - 1);
+	ASSERT_THROW(genesis::inflate(deflate_data::dynamic_block, output), std::runtime_error);
+}
+
+TEST(INFLATE, CORRUPTED_INPUT)
+{
+	std::vector<std::uint8_t> output(test::compressed_pattern().size());
+
+	// truncated stream
+	auto truncated = std::span(deflate_data::dynamic_block).first(deflate_data::dynamic_block.size() / 2);
+	ASSERT_THROW(genesis::inflate(truncated, output), std::runtime_error);
+
+	// reserved block type
+	const std::array<std::uint8_t, 4> reserved = {0x07, 0x00, 0x00, 0x00};
+	ASSERT_THROW(genesis::inflate(reserved, output), std::runtime_error);
+
+	// wrong stored block length
+	const std::array<std::uint8_t, 6> stored = {0x01, 0x01, 0x00, 0x00, 0x00, 0xAA};
+	ASSERT_THROW(genesis::inflate(stored, output), std::runtime_error);
+}
+
+TEST(INFLATE, CRC32)
+{
+	const std::array<std::uint8_t, 9> check = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+	ASSERT_EQ(0xCBF43926, genesis::crc32(check));
+	ASSERT_EQ(0xD8A6E9BE, genesis::crc32(test::compressed_pattern()));
+	ASSERT_EQ(0u, genesis::crc32({}));
+}
@@ -49,8 +49,9 @@ static inline void load_mcl(test_cpu& cpu)
 } // namespace __impl
 
 // The test program is taken from: https://github.com/MicroCoreLabs/Projects/blob/master/MCL68/MC68000_Test_Code/
-template <class Callable>
-bool run_mcl(test_cpu& cpu, Callable&& after_cycle_hook)
+// step function advances the cpu (by a single cycle or by a whole instruction)
+template <class Step>
+bool run_mcl_steps(test_cpu& cpu, Step&& step)
 {
 	__impl::load_mcl(cpu);
 	__impl::nop_some_tests(cpu.memory());
@@ -74,10 +75,9 @@ bool run_mcl(test_cpu& cpu, Callable&& after_cycle_hook)
 	while(true)
 	{
 		if(++cycles == cycles_threshld)
-			throw internal_error("run_mcl exceed cycles limit");
+			throw internal_error("run_mcl_steps exceed cycles limit");
 
-		cpu.cycle();
-		after_cycle_hook();
+		step();
 
 		if(testing::Test::HasFatalFailure())
 			return false;
@@ -124,6 +124,15 @@ bool run_mcl(test_cpu& cpu, Callable&& after_cycle_hook)
 	}
 }
 
+template <class Callable>
+bool run_mcl(test_cpu& cpu, Callable&& after_cycle_hook)
+{
+	return run_mcl_steps(cpu, [&]() {
+		cpu.cycle();
+		after_cycle_hook();
+	});
+}
+
 } // namespace genesis::test
 
 #endif // __M68K_TEST_MCL_H__
@@ -24,3 +24,29 @@ TEST(M68K, MCL)
 	ASSERT_NE(0, cycles);
 	ASSERT_LT(ns_per_cycle, genesis::test::cycle_time_threshold_ns);
 }
+
+TEST(M68K, MCL_INSTRUCTION_LEVEL)
+{
+	test_cpu cpu;
+
+	long cycles = 0;
+	bool succeed = run_mcl(cpu, [&cycles]() { ++cycles; });
+	ASSERT_TRUE(succeed);
+
+	long instructions = 0;
+	long instruction_level_cycles = 0;
+	auto total_ns_time = time::measure_in_ns([&]() {
+		succeed = run_mcl_steps(cpu, [&]() {
+			instruction_level_cycles += cpu.execute_one();
+			++instructions;
+		});
+	});
+
+	std::cout << "NS per cycle for executing MCL test program at instruction level: "
+			  << total_ns_time / instruction_level_cycles << ", total instructions: " << instructions << std::endl;
+
+	ASSERT_TRUE(succeed);
+
+	// instruction level execution must take exactly the same number of cycles
+	ASSERT_EQ(cycles, instruction_level_cycles);
+}
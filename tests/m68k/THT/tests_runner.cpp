@@ -343,7 +343,14 @@ bool run_test(test::test_cpu& cpu, const test_case& test)
 	bool post = check_postconditions(cpu, test.final_state);
 	bool trans = check_transitions(res, test.transitions, test.length);
 
-	return post && trans;
+	// instruction level execution must end up in the same state after the same number of cycles
+	set_preconditions(cpu, test.initial_state);
+	auto cycles = cpu.execute_one();
+	EXPECT_EQ(test.length, cycles) << "instruction level execution";
+
+	bool inst_post = check_postconditions(cpu, test.final_state);
+
+	return post && trans && inst_post && cycles == test.length;
 }
 
 bool should_skip_test(std::string_view test_name)
@@ -1,8 +1,14 @@
 #include "../test_cpu.hpp"
+#include "m68k/impl/instruction_unit.hpp"
 #include "time_utils.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
 
 using namespace genesis::m68k;
 
@@ -30,33 +36,50 @@ TEST(M68K_PERFORMANCE, TMP)
 
 TEST(M68K_PERFORMANCE, DECODING)
 {
-	GTEST_SKIP();
-
-	const unsigned num_measurements = 100'000;
-
-	int num_unknown = 0; // to prevent optimization
-
-	auto ns_per_decode = genesis::time::measure_in_ns([&]() {
-							 for(unsigned i = 0; i < num_measurements; ++i)
-							 {
-								 std::uint16_t opcode = 0;
-								 while(true)
-								 {
-									 auto res = opcode_decoder::decode(opcode);
-
-									 if(opcode == 0xFFFF)
-										 break;
-									 ++opcode;
-
-									 if(res == inst_type::NONE)
-										 ++num_unknown;
-								 }
-							 }
-						 }) /
-						 0x10000 / num_measurements;
-
-	// NOTE: ns_per_decode is 1 or 0
-	std::cout << "NS per decode: " << ns_per_decode << ", unknown: " << num_unknown << std::endl;
+	const unsigned num_opcodes = 0xFFFF + 1;
+	const unsigned num_measurements = 100;
+
+	// opcodes in random order, so branch prediction cannot follow the switches
+	std::vector<std::uint16_t> opcodes(num_opcodes);
+	std::iota(opcodes.begin(), opcodes.end(), std::uint16_t(0));
+	std::shuffle(opcodes.begin(), opcodes.end(), std::mt19937(42));
+
+	// warm up and make sure the dispatch table matches decoding
+	for(auto opcode : opcodes)
+	{
+		auto resolved = instruction_unit::resolve(opcode);
+		const auto& looked_up = instruction_unit::lookup(opcode);
+		ASSERT_EQ(resolved.exec, looked_up.exec);
+		ASSERT_EQ(resolved.inst, looked_up.inst);
+		ASSERT_EQ(resolved.privileged, looked_up.privileged);
+	}
+
+	std::size_t checksum = 0; // to prevent optimization
+
+	// decoding and switching to the handler, as instruction_unit did per instruction before the table
+	auto ns_per_resolve = double(genesis::time::measure_in_ns([&]() {
+		for(unsigned i = 0; i < num_measurements; ++i)
+			for(auto opcode : opcodes)
+			{
+				auto decoded = instruction_unit::resolve(opcode);
+				checksum += reinterpret_cast<std::uintptr_t>(decoded.exec) + decoded.privileged;
+			}
+	})) / num_opcodes / num_measurements;
+
+	// the dispatch table access instruction_unit performs now
+	auto ns_per_lookup = double(genesis::time::measure_in_ns([&]() {
+		for(unsigned i = 0; i < num_measurements; ++i)
+			for(auto opcode : opcodes)
+			{
+				const auto& decoded = instruction_unit::lookup(opcode);
+				checksum += reinterpret_cast<std::uintptr_t>(decoded.exec) + decoded.privileged;
+			}
+	})) / num_opcodes / num_measurements;
+
+	std::cout << "NS per resolve: " << ns_per_resolve << ", NS per lookup: " << ns_per_lookup
+			  << ", checksum: " << checksum << std::endl;
+
+	ASSERT_LT(ns_per_lookup, ns_per_resolve);
 }
 
 TEST(M68K_PERFORMANCE, BUS_READ)
@@ -100,7 +123,7 @@ TEST(M68K_PERFORMANCE, BUS_READ)
 	const auto test_threshold_ns = genesis::test::cycle_time_threshold_ns / 3;
 
 	// Takes 10-20 ns per cycle for bus_manager read operation
-	// Takes ~37 ns per cycle for scheduler read operation
+	// Takes ~12 ns per cycle for scheduler read operation (was ~37 ns with std::function callbacks)
 	std::cout << "NS per cycle for read operation: " << ns_per_cycle << ", threshold: " << test_threshold_ns
 			  << std::endl;
 
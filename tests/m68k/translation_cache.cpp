@@ -0,0 +1,176 @@
+#include "helpers/random.h"
+#include "m68k/impl/translation_cache.h"
+#include "test_cpu.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace genesis;
+using namespace genesis::test;
+
+
+void randomize_registers(m68k::cpu_registers& regs)
+{
+	for(int i = 0; i < 8; ++i)
+		regs.D(i).LW = random::next<std::uint32_t>();
+
+	for(int i = 0; i < 7; ++i)
+		regs.A(i).LW = random::next<std::uint32_t>();
+
+	regs.USP.LW = random::next<std::uint32_t>();
+	regs.SSP.LW = random::next<std::uint32_t>();
+
+	// keep trace off, interrupts are never raised by the test device
+	regs.SR = random::next<std::uint16_t>() & 0b0010011100011111;
+}
+
+void prefetch(test_cpu& cpu, std::uint32_t PC)
+{
+	auto& regs = cpu.registers();
+	auto& mem = cpu.memory();
+
+	regs.PC = PC;
+	regs.IRD = regs.IR = mem.read<std::uint16_t>(PC & 0xFFFFFF);
+	regs.IRC = mem.read<std::uint16_t>((PC + 2) & 0xFFFFFF);
+}
+
+void expect_same_state(m68k::cpu_registers& expected, m68k::cpu_registers& actual)
+{
+	for(int i = 0; i < 8; ++i)
+		ASSERT_EQ(expected.D(i).LW, actual.D(i).LW) << "D" << i;
+
+	for(int i = 0; i < 7; ++i)
+		ASSERT_EQ(expected.A(i).LW, actual.A(i).LW) << "A" << i;
+
+	ASSERT_EQ(expected.USP.LW, actual.USP.LW);
+	ASSERT_EQ(expected.SSP.LW, actual.SSP.LW);
+	ASSERT_EQ(expected.SR, actual.SR);
+
+	ASSERT_EQ(expected.PC, actual.PC);
+	ASSERT_EQ(expected.SPC, actual.SPC);
+	ASSERT_EQ(expected.IRD, actual.IRD);
+	ASSERT_EQ(expected.IR, actual.IR);
+	ASSERT_EQ(expected.IRC, actual.IRC);
+	ASSERT_EQ(expected.SIRD, actual.SIRD);
+}
+
+TEST(M68K_TRANSLATION_CACHE, REPLAY_ALL_OPCODES)
+{
+	test_cpu cpu;
+	auto& mem = cpu.memory();
+
+	m68k::cpu_registers regs;
+	m68k::cpu_bus bus;
+	m68k::impl::translation_cache cache(regs, bus, mem);
+
+	std::uint32_t replayed = 0;
+	for(std::uint32_t opcode = 0; opcode <= 0xFFFF; ++opcode)
+	{
+		// place the instruction far enough from the memory bounds for any branch
+		std::uint32_t PC = random::in_range<std::uint32_t>(0x10000, 0xFE0000) & ~1;
+		if(opcode % 4 == 0)
+			PC |= 0xFF000000; // sign-extended addresses are mapped to the same memory
+
+		mem.write<std::uint16_t>(PC & 0xFFFFFF, opcode);
+		for(std::uint32_t i = 2; i <= 8; i += 2)
+			mem.write<std::uint16_t>((PC + i) & 0xFFFFFF, random::next<std::uint16_t>());
+
+		randomize_registers(cpu.registers());
+		prefetch(cpu, PC);
+		regs = cpu.registers();
+
+		std::uint32_t cycles = cache.replay();
+		if(cycles == 0)
+			continue;
+
+		++replayed;
+
+		auto expected_cycles = cpu.cycle_till_idle();
+		ASSERT_EQ(expected_cycles, cycles) << "opcode: " << opcode;
+		expect_same_state(cpu.registers(), regs);
+		ASSERT_EQ(cpu.bus().address(), bus.address());
+		ASSERT_EQ(cpu.bus().data(), bus.data());
+	}
+
+	// register and immediate forms of the most frequent instructions
+	ASSERT_GT(replayed, 10'000u);
+}
+
+/* Run the same program instruction by instruction on two CPUs: cycle by cycle and by execute_one */
+class M68K_TRANSLATION_CACHE_PROGRAM : public testing::Test
+{
+protected:
+	void load(std::uint32_t address, std::initializer_list<std::uint16_t> program)
+	{
+		for(auto word : program)
+		{
+			expected.memory().write<std::uint16_t>(address, word);
+			actual.memory().write<std::uint16_t>(address, word);
+			address += 2;
+		}
+	}
+
+	void start(std::uint32_t PC)
+	{
+		prefetch(expected, PC);
+		prefetch(actual, PC);
+	}
+
+	void run(int instructions)
+	{
+		for(int i = 0; i < instructions; ++i)
+		{
+			auto expected_cycles = expected.cycle_till_idle();
+			auto cycles = actual.execute_one();
+
+			ASSERT_EQ(expected_cycles, cycles);
+			expect_same_state(expected.registers(), actual.registers());
+		}
+	}
+
+	test_cpu expected;
+	test_cpu actual;
+};
+
+TEST_F(M68K_TRANSLATION_CACHE_PROGRAM, LOOP)
+{
+	load(0x1000, {
+					 0x7009,		 // moveq #9, d0
+					 0x5281,		 // addq.l #1, d1
+					 0xE54A,		 // lsl.w #2, d2
+					 0x0682, 0x0001, // addi.l #$10000, d2
+					 0x0000,		 //
+					 0x51C8, 0xFFF4, // dbf d0, -12
+					 0x41F9, 0x0000, // lea $2000, a0
+					 0x2000,		 //
+					 0x3010,		 // move.w (a0), d0 - not translated
+					 0x60E6,		 // bra.s -26
+				 });
+
+	start(0x1000);
+	run(1000);
+}
+
+TEST_F(M68K_TRANSLATION_CACHE_PROGRAM, SELF_MODIFYING_CODE)
+{
+	load(0x1000, {
+					 0x7009,		 // moveq #9, d0
+					 0x5281,		 // addq.l #1, d1
+					 0x51C8, 0xFFFC, // dbf d0, -4
+					 0x60F6,		 // bra.s -10
+				 });
+
+	start(0x1000);
+	run(100);
+
+	// addq.l #2, d1
+	load(0x1002, {0x5481});
+	run(100);
+
+	// addi.l #$10000, d1
+	load(0x1002, {0x0681, 0x0001, 0x0000, 0x51C8, 0xFFF8, 0x60F2});
+	run(100);
+
+	// addi.l #$10100, d1 (the second extension word is never in the prefetch queue)
+	load(0x1006, {0x0100});
+	run(100);
+}
@@ -1,7 +1,9 @@
 #include "memory/memory_builder.h"
 
 #include "helper.h"
+#include "memory/dummy_memory.h"
 #include "memory/memory_unit.h"
+#include "memory/read_only_memory_unit.h"
 
 #include <gtest/gtest.h>
 
@@ -74,6 +76,20 @@ TEST(MEMORY, MEMORY_BUILDER_READ_WRITE_16)
 	test::test_read_write<std::uint16_t>(*composite_memory);
 }
 
+TEST(MEMORY, MEMORY_BUILDER_CROSS_PAGE_DEVICES)
+{
+	// devices which don't match page boundaries
+	for(unsigned mem_per_device : {2, 100, 300, 1000})
+	{
+		auto composite_memory = build(8, mem_per_device);
+		test::test_read_write<std::uint8_t>(*composite_memory);
+		test::test_read_write<std::uint16_t>(*composite_memory);
+	}
+
+	auto composite_memory = build(200, 3);
+	test::test_read_write<std::uint8_t>(*composite_memory);
+}
+
 TEST(MEMORY, MEMORY_BUILDER_GAP)
 {
 	memory::memory_builder builder;
@@ -83,7 +99,7 @@ TEST(MEMORY, MEMORY_BUILDER_GAP)
 
 	auto mem = builder.build();
 
-	for(auto addr : {33, 512, 1057})
+	for(auto addr : {33, 255, 256, 512, 1023, 1057, 0x10000})
 	{
 		ASSERT_THROW(mem->init_write(addr, std::uint8_t(0)), std::runtime_error);
 		ASSERT_THROW(mem->init_write(addr, std::uint16_t(0)), std::runtime_error);
@@ -178,3 +194,43 @@ TEST(MEMORY, MEMORY_BUILDER_MIRROR)
 		ASSERT_EQ(data, mem->latched_byte());
 	}
 }
+
+TEST(MEMORY, MEMORY_BUILDER_DIRECT_ACCESS)
+{
+	memory::memory_builder builder;
+
+	auto ram = std::make_shared<memory::memory_unit>(0x1FF, std::endian::big);
+	builder.add(ram, 0x100);																// [0x100 ; 0x2FF]
+	builder.add_unique(std::make_unique<memory::read_only_memory_unit>(0xFF), 0x300);		// [0x300 ; 0x3FF]
+	builder.add_unique(std::make_unique<memory::dummy_memory>(0xFF, std::endian::big), 0x400); // [0x400 ; 0x4FF]
+
+	auto mem = builder.build();
+
+	auto region = mem->direct_access(0x180);
+	ASSERT_TRUE(region.has_value());
+	ASSERT_EQ(0x100u, region->first_address);
+	ASSERT_EQ(0x2FFu, region->last_address);
+	ASSERT_TRUE(region->writable);
+
+	region = mem->direct_access(0x3FF);
+	ASSERT_TRUE(region.has_value());
+	ASSERT_FALSE(region->writable);
+
+	// devices with side effects and gaps must not be accessed directly
+	ASSERT_FALSE(mem->direct_access(0x400).has_value());
+	ASSERT_FALSE(mem->direct_access(0x0).has_value());
+	ASSERT_FALSE(mem->direct_access(0x500).has_value());
+
+	// direct writes must be visible through the device and vice versa
+	mem->init_write(0x100, std::uint16_t(0x1234));
+	ASSERT_EQ(0x1234, ram->read<std::uint16_t>(0x0));
+
+	ram->write<std::uint16_t>(0x1FE, 0xABCD);
+	mem->init_read_word(0x2FE);
+	ASSERT_EQ(0xABCD, mem->latched_word());
+	mem->init_read_byte(0x2FF);
+	ASSERT_EQ(0xCD, mem->latched_byte());
+
+	// read-only memory must reject writes
+	ASSERT_THROW(mem->init_write(0x300, std::uint8_t(0)), std::runtime_error);
+}
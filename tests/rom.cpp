@@ -1,16 +1,23 @@
 #include "rom.h"
 
 #include "endian.hpp"
+#include "helpers/compressed_pattern.h"
 #include "rom_debug.hpp"
 #include "string_utils.hpp"
 
 #include <array>
 #include <atomic>
 #include <cstdio>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <gtest/gtest.h>
+#include <iterator>
+#include <optional>
+#include <random>
 #include <span>
+#include <string>
+#include <string_view>
 #include <sstream>
 
 
@@ -141,10 +148,53 @@ const std::vector<std::uint8_t> raw_body = {
 
 } // namespace builtin_rom
 
+namespace archived_rom
+{
+
+// compressed_pattern() packed with gzip and zip (deflate), generated with python's gzip/zipfile modules
+const std::array<std::uint8_t, 145> gzip_rom = {
+	0x1f, 0x8b, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0x74, 0x65, 0x73, 0x74, 0x2e, 0x62,
+	0x69, 0x6e, 0x00, 0xe5, 0xc7, 0x45, 0x01, 0xc4, 0x40, 0x0c, 0x00, 0x40, 0x2b, 0xed, 0x95, 0x6c,
+	0x2c, 0x33, 0x26, 0x0b, 0xfe, 0x9d, 0x9c, 0x90, 0xcc, 0x6f, 0xac, 0x2e, 0x1a, 0x3d, 0x1e, 0x50,
+	0xf3, 0x31, 0x34, 0x0e, 0x4b, 0xec, 0x46, 0x55, 0x05, 0x0e, 0x4e, 0x2c, 0xe9, 0x9c, 0x0a, 0x26,
+	0xb5, 0x6b, 0x9b, 0x6c, 0x8f, 0xfd, 0xd7, 0x72, 0xfd, 0x2d, 0xdb, 0x17, 0xb5, 0x2b, 0x93, 0x4d,
+	0x0b, 0xed, 0xea, 0xa9, 0x5c, 0xdb, 0xb4, 0x4d, 0xed, 0x92, 0x07, 0xbe, 0xf3, 0xbe, 0x57, 0xf4,
+	0x77, 0xe3, 0xbb, 0x51, 0xbb, 0x60, 0x91, 0xad, 0xb4, 0x9e, 0x1d, 0xdc, 0xd3, 0xd9, 0xea, 0xd4,
+	0xce, 0xa5, 0x93, 0xb3, 0xce, 0x77, 0xf8, 0xf8, 0x82, 0x9c, 0x40, 0xed, 0x4c, 0x78, 0x31, 0xca,
+	0xf8, 0xa6, 0x0b, 0x1f, 0x8a, 0x81, 0xd4, 0x5e, 0xff, 0xbe, 0xe9, 0xa6, 0xd8, 0x01, 0x08, 0x00,
+	0x00};
+
+const std::array<std::uint8_t, 343> zip_rom = {
+	0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x00, 0x86, 0xa6,
+	0x10, 0x36, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x72, 0x65,
+	0x61, 0x64, 0x6d, 0x65, 0x2e, 0x74, 0x78, 0x74, 0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x50, 0x4b, 0x03,
+	0x04, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x21, 0x00, 0xbe, 0xe9, 0xa6, 0xd8, 0x76,
+	0x00, 0x00, 0x00, 0x01, 0x08, 0x00, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x67, 0x61, 0x6d, 0x65, 0x2f,
+	0x74, 0x65, 0x73, 0x74, 0x2e, 0x42, 0x49, 0x4e, 0xe5, 0xc7, 0x45, 0x01, 0xc4, 0x40, 0x0c, 0x00,
+	0x40, 0x2b, 0xed, 0x95, 0x6c, 0x2c, 0x33, 0x26, 0x0b, 0xfe, 0x9d, 0x9c, 0x90, 0xcc, 0x6f, 0xac,
+	0x2e, 0x1a, 0x3d, 0x1e, 0x50, 0xf3, 0x31, 0x34, 0x0e, 0x4b, 0xec, 0x46, 0x55, 0x05, 0x0e, 0x4e,
+	0x2c, 0xe9, 0x9c, 0x0a, 0x26, 0xb5, 0x6b, 0x9b, 0x6c, 0x8f, 0xfd, 0xd7, 0x72, 0xfd, 0x2d, 0xdb,
+	0x17, 0xb5, 0x2b, 0x93, 0x4d, 0x0b, 0xed, 0xea, 0xa9, 0x5c, 0xdb, 0xb4, 0x4d, 0xed, 0x92, 0x07,
+	0xbe, 0xf3, 0xbe, 0x57, 0xf4, 0x77, 0xe3, 0xbb, 0x51, 0xbb, 0x60, 0x91, 0xad, 0xb4, 0x9e, 0x1d,
+	0xdc, 0xd3, 0xd9, 0xea, 0xd4, 0xce, 0xa5, 0x93, 0xb3, 0xce, 0x77, 0xf8, 0xf8, 0x82, 0x9c, 0x40,
+	0xed, 0x4c, 0x78, 0x31, 0xca, 0xf8, 0xa6, 0x0b, 0x1f, 0x8a, 0x81, 0xd4, 0x5e, 0xff, 0x50, 0x4b,
+	0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x00, 0x86, 0xa6,
+	0x10, 0x36, 0x05, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0x72, 0x65, 0x61, 0x64,
+	0x6d, 0x65, 0x2e, 0x74, 0x78, 0x74, 0x50, 0x4b, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00,
+	0x08, 0x00, 0x00, 0x00, 0x21, 0x00, 0xbe, 0xe9, 0xa6, 0xd8, 0x76, 0x00, 0x00, 0x00, 0x01, 0x08,
+	0x00, 0x00, 0x0d, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01,
+	0x2d, 0x00, 0x00, 0x00, 0x67, 0x61, 0x6d, 0x65, 0x2f, 0x74, 0x65, 0x73, 0x74, 0x2e, 0x42, 0x49,
+	0x4e, 0x50, 0x4b, 0x05, 0x06, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x73, 0x00, 0x00,
+	0x00, 0xce, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+} // namespace archived_rom
+
 class TempFile
 {
 public:
-	TempFile() : _path(gen_temp_path()), _stream(_path, std::ios::trunc | std::ios::binary | std::ios::out)
+	TempFile(std::string_view extension = ".bin")
+		: _path(gen_temp_path(extension)), _stream(_path, std::ios::trunc | std::ios::binary | std::ios::out)
 	{
 		if(!_stream.is_open())
 			throw std::runtime_error("failed to open temporary ('" + _path + "') file");
@@ -176,13 +226,13 @@ private:
 private:
 	static std::atomic_uint64_t file_id;
 
-	static std::string gen_temp_path()
+	static std::string gen_temp_path(std::string_view extension)
 	{
 		// TODO: generate random name?
 		std::stringstream ss;
 		ss << "__genesis_tmp_file__";
 		ss << '.' << file_id.fetch_add(1);
-		ss << ".bin";
+		ss << extension;
 
 		return ss.str();
 	}
@@ -265,6 +315,168 @@ TEST(ROM, DATA_PARSING)
 	ASSERT_EQ(builtin_rom::header, test_rom.header());
 }
 
+template <class Archive>
+std::vector<std::uint8_t> read_archived_rom(const Archive& archive, std::string_view extension)
+{
+	TempFile tmp_file(extension);
+	tmp_file.stream().write(reinterpret_cast<const char*>(archive.data()), archive.size());
+	tmp_file.stream().flush();
+
+	genesis::rom test_rom(tmp_file.path());
+	auto data = test_rom.data();
+
+	// odd sized ROM must be padded
+	EXPECT_EQ(0, test_rom.shared_data().get()[data.size()]);
+
+	return {data.begin(), data.end()};
+}
+
+/* Archived ROMs are decompressed into the per-user cache, it's pointed to a fresh directory,
+ * so tests neither touch the real cache nor depend on what is left there */
+class ROM_ARCHIVE : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		std::random_device rd;
+		do
+			cache_home = std::filesystem::temp_directory_path() / ("__genesis_tmp_cache__." + std::to_string(rd()));
+		while(!std::filesystem::create_directory(cache_home));
+
+		if(const char* prev = std::getenv(cache_env))
+			saved_cache_home = prev;
+		set_env(cache_home.string().c_str());
+	}
+
+	void TearDown() override
+	{
+		if(saved_cache_home)
+			set_env(saved_cache_home->c_str());
+		else
+			unset_env();
+		std::filesystem::remove_all(cache_home);
+	}
+
+	std::filesystem::path cache_home;
+
+private:
+#if defined(_WIN32)
+	static constexpr const char* cache_env = "LOCALAPPDATA";
+
+	static void set_env(const char* value)
+	{
+		_putenv_s(cache_env, value);
+	}
+
+	static void unset_env()
+	{
+		_putenv_s(cache_env, "");
+	}
+#else
+	static constexpr const char* cache_env = "XDG_CACHE_HOME";
+
+	static void set_env(const char* value)
+	{
+		setenv(cache_env, value, 1);
+	}
+
+	static void unset_env()
+	{
+		unsetenv(cache_env);
+	}
+#endif
+
+	std::optional<std::string> saved_cache_home;
+};
+
+TEST_F(ROM_ARCHIVE, GZIP)
+{
+	auto expected = genesis::test::compressed_pattern();
+
+	ASSERT_EQ(expected, read_archived_rom(archived_rom::gzip_rom, ".gz"));
+
+	// the second time ROM is loaded from the decompression cache
+	ASSERT_EQ(expected, read_archived_rom(archived_rom::gzip_rom, ".gz"));
+}
+
+TEST_F(ROM_ARCHIVE, ZIP)
+{
+	auto expected = genesis::test::compressed_pattern();
+
+	ASSERT_EQ(expected, read_archived_rom(archived_rom::zip_rom, ".zip"));
+	ASSERT_EQ(expected, read_archived_rom(archived_rom::zip_rom, ".zip"));
+}
+
+#if !defined(_WIN32)
+TEST_F(ROM_ARCHIVE, CORRUPTED_CACHE)
+{
+	auto expected = genesis::test::compressed_pattern();
+	ASSERT_EQ(expected, read_archived_rom(archived_rom::gzip_rom, ".gz"));
+
+	const auto cache_dir = cache_home / "genesis" / "rom_cache";
+	ASSERT_EQ(std::filesystem::perms::owner_all,
+			  std::filesystem::status(cache_dir).permissions() & std::filesystem::perms::all);
+
+	std::vector<std::filesystem::path> cached(std::filesystem::directory_iterator(cache_dir), {});
+	ASSERT_EQ(1u, cached.size());
+
+	// the same size, but different content
+	{
+		std::fstream fs(cached[0], std::ios::in | std::ios::out | std::ios::binary);
+		fs.seekp(0x100);
+		fs.put(static_cast<char>(expected[0x100] ^ 0xFF));
+	}
+
+	// corrupted cache is ignored and replaced
+	ASSERT_EQ(expected, read_archived_rom(archived_rom::gzip_rom, ".gz"));
+	ASSERT_EQ(expected, read_archived_rom(archived_rom::gzip_rom, ".gz"));
+
+	std::ifstream fs(cached[0], std::ios::binary);
+	std::vector<std::uint8_t> content((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+	ASSERT_EQ(expected, content);
+}
+#endif
+
+TEST_F(ROM_ARCHIVE, CORRUPTED_ARCHIVE)
+{
+	// corrupt CRC
+	auto gzip = archived_rom::gzip_rom;
+	gzip[gzip.size() - 8] ^= 0xFF;
+	EXPECT_THROW(read_archived_rom(gzip, ".gz"), std::runtime_error);
+
+	// corrupt compressed data
+	auto zip = archived_rom::zip_rom;
+	for(std::size_t i = 0x60; i < 0x80; ++i)
+		zip[i] = 0xFF;
+	EXPECT_THROW(read_archived_rom(zip, ".zip"), std::runtime_error);
+
+	// not an archive
+	auto truncated = std::span(archived_rom::zip_rom).first(20);
+	EXPECT_THROW(read_archived_rom(truncated, ".zip"), std::runtime_error);
+	EXPECT_THROW(read_archived_rom(truncated, ".gz"), std::runtime_error);
+}
+
+TEST(ROM, SHARED_DATA)
+{
+	// odd sized body
+	const std::array<std::uint8_t, 3> body = {0x11, 0x22, 0x33};
+	ROMConstructor rom(builtin_rom::raw_vectors, builtin_rom::raw_header, body);
+
+	auto shared = [&]() {
+		genesis::rom test_rom(rom.path());
+		auto data = test_rom.shared_data();
+
+		EXPECT_EQ(data.get(), test_rom.data().data());
+		EXPECT_EQ(1u, test_rom.data().size() % 2);
+		return std::make_pair(data, test_rom.data().size());
+	}();
+
+	// storage outlives ROM object and is padded with zero up to the even size
+	auto [data, size] = shared;
+	ASSERT_EQ(0x33, data.get()[size - 1]);
+	ASSERT_EQ(0x00, data.get()[size]);
+}
+
 template <class Vectors, class Header, class Body>
 void check_ill_formatted_rom(const Vectors& vectors, const Header& header, const Body& body)
 {
@@ -0,0 +1,179 @@
+#include "smd/smd.h"
+
+#include "endian.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+using namespace genesis;
+
+
+class null_input_device : public io_ports::input_device
+{
+public:
+	bool is_key_pressed(io_ports::key_type) override
+	{
+		return false;
+	}
+};
+
+// ROM file running the m68k program from 0x200
+class test_rom_file
+{
+public:
+	test_rom_file(const std::vector<std::uint16_t>& program) : m_path("__genesis_smd_test_rom__.bin")
+	{
+		std::vector<std::uint16_t> words(0x100, 0);
+
+		// SP and PC vectors
+		words[0] = 0x00FF;
+		words[1] = 0xFE00;
+		words[2] = 0x0000;
+		words[3] = 0x0200;
+
+		words.insert(words.end(), program.begin(), program.end());
+
+		std::ofstream fs(m_path, std::ios::binary | std::ios::trunc);
+		for(auto word : words)
+		{
+			endian::sys_to_big(word);
+			fs.write(reinterpret_cast<const char*>(&word), sizeof(word));
+		}
+	}
+
+	~test_rom_file()
+	{
+		std::error_code ec;
+		std::filesystem::remove(m_path, ec);
+	}
+
+	std::string path() const
+	{
+		return m_path.string();
+	}
+
+private:
+	std::filesystem::path m_path;
+};
+
+// gives access to the CPUs state
+class test_smd : public smd
+{
+public:
+	using smd::smd;
+
+	z80::cpu& z80_cpu()
+	{
+		return *m_z80_cpu;
+	}
+
+	m68k::cpu& m68k_cpu()
+	{
+		return *m_m68k_cpu;
+	}
+};
+
+TEST(SMD, Z80_RUNS_BEHIND_M68K)
+{
+	const std::vector<std::uint8_t> z80_program = {
+		0x21, 0x00, 0x00, // LD HL, 0x0000
+		0x11, 0x00, 0x10, // LD DE, 0x1000
+		0x01, 0x00, 0x04, // LD BC, 0x0400
+		0xED, 0xB0,		  // LDIR
+		0x3E, 0x55,		  // LD A, 0x55
+		0x32, 0x00, 0x0F, // LD (0x0F00), A
+		0x18, 0xFE,		  // JR $
+	};
+
+	std::vector<std::uint16_t> program;
+
+	// upload the Z80 program, Z80 bus is granted at power on
+	for(std::size_t i = 0; i < z80_program.size(); ++i)
+		program.insert(program.end(), {0x13FC, z80_program[i], 0x00A0, static_cast<std::uint16_t>(i)}); // MOVE.B
+
+	program.insert(program.end(), {
+		0x33FC, 0x0100, 0x00A1, 0x1200, // MOVE.W #0x100, 0xA11200 (clear Z80 reset)
+		0x33FC, 0x0000, 0x00A1, 0x1100, // MOVE.W #0x0, 0xA11100 (release Z80 bus)
+
+		// do not touch Z80 for a while
+		0x203C, 0x0000, 0x0BB8, // MOVE.L #3000, D0
+		0x5380,					// SUBQ.L #1, D0
+		0x66FC,					// BNE.S -4
+
+		// wait till Z80 is done
+		0x0C39, 0x0055, 0x00A0, 0x0F00, // CMPI.B #0x55, 0xA00F00
+		0x66F6,							// BNE.S -10
+
+		0x60FE, // BRA.S *
+	});
+
+	test_rom_file file(program);
+	genesis::rom rom(file.path());
+
+	for(auto mode : {smd::m68k_mode::cycle_accurate, smd::m68k_mode::instruction_level})
+	{
+		test_smd sys(rom, std::make_shared<null_input_device>(), mode);
+		auto& z80_mem = sys.z80_cpu().memory();
+		const std::uint64_t slice = 3420;
+
+		// calls are counted only while profiling
+		sys.enable_profiling(true);
+		const auto& z80_calls = sys.profiling_data().z80.calls;
+
+		// Z80 runs only when nobody touches its state, so it gets the whole slice in a single call
+		std::uint64_t max_iterations_per_call = 0;
+		for(int i = 0; i < 200; ++i)
+		{
+			auto bc = static_cast<std::uint16_t>(sys.z80_cpu().registers().main_set.BC);
+			auto calls = z80_calls;
+			sys.run_until(sys.mclk() + slice);
+
+			auto new_bc = static_cast<std::uint16_t>(sys.z80_cpu().registers().main_set.BC);
+			if(new_bc < bc)
+				max_iterations_per_call = std::max(max_iterations_per_call, (bc - new_bc) / (z80_calls - calls));
+		}
+
+		// 21 T-states per iteration, 228 T-states per slice
+		ASSERT_LE(10u, max_iterations_per_call);
+
+		for(std::size_t i = 0; i < z80_program.size(); ++i)
+			ASSERT_EQ(z80_program[i], z80_mem.read<std::uint8_t>(static_cast<std::uint16_t>(0x1000 + i)));
+		ASSERT_EQ(0x55, z80_mem.read<std::uint8_t>(0x0F00));
+
+		// M68K has seen the Z80 result and reached the last BRA
+		const auto last_instruction = static_cast<std::uint32_t>(0x200 + (program.size() - 1) * 2);
+		ASSERT_EQ(last_instruction, sys.m68k_cpu().registers().PC);
+	}
+}
+
+TEST(SMD, PROFILE_FITS_WALL_TIME)
+{
+	// BRA.S *
+	test_rom_file file({0x60FE});
+	genesis::rom rom(file.path());
+
+	for(auto mode : {smd::m68k_mode::cycle_accurate, smd::m68k_mode::instruction_level})
+	{
+		smd sys(rom, std::make_shared<null_input_device>(), mode);
+		sys.enable_profiling(true);
+
+		auto start = std::chrono::steady_clock::now();
+		for(int i = 0; i < 10; ++i)
+			sys.run_frame();
+		auto wall_time = std::chrono::steady_clock::now() - start;
+
+		const auto& prof = sys.profiling_data();
+		auto devices_time = prof.time(prof.m68k) + prof.time(prof.z80) + prof.time(prof.vdp);
+
+		ASSERT_NE(0u, prof.m68k.sampled_calls);
+		ASSERT_NE(0u, prof.vdp.sampled_calls);
+		ASSERT_LE(devices_time, prof.total_time);
+		ASSERT_LE(prof.total_time, wall_time);
+	}
+}
@@ -0,0 +1,69 @@
+#include "memory/memory_builder.h"
+#include "memory/memory_unit.h"
+#include "smd/impl/z80_68bank.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+
+using namespace genesis;
+
+
+static std::uint8_t bank_byte(std::uint32_t m68k_address)
+{
+	return static_cast<std::uint8_t>((m68k_address >> 15) * 31 + m68k_address * 7);
+}
+
+static void select_bank(memory::addressable& bank_register, std::uint32_t bank)
+{
+	// 9 bits, LSB first
+	for(int i = 0; i < 9; ++i)
+		bank_register.init_write(0, static_cast<std::uint8_t>((bank >> i) & 1));
+}
+
+static std::uint8_t read_byte(memory::addressable& bank_area, std::uint32_t address)
+{
+	bank_area.init_read_byte(address);
+	return bank_area.latched_byte();
+}
+
+TEST(SMD_Z80_68BANK, READ_SELECTED_BANK)
+{
+	// banks 0-1 are backed by a single device, bank 2 is split between 2 devices
+	memory::memory_builder builder;
+	builder.add_unique(memory::make_memory_unit(0xFFFF, std::endian::big), 0x0);
+	builder.add_unique(memory::make_memory_unit(0x3FFF, std::endian::big), 0x10000);
+	builder.add_unique(memory::make_memory_unit(0x3FFF, std::endian::big), 0x14000);
+	auto m68k_area = builder.build();
+
+	for(std::uint32_t addr = 0; addr <= 0x17FFF; ++addr)
+		m68k_area->init_write(addr, bank_byte(addr));
+
+	impl::z80_68bank z80_bank(m68k_area);
+	auto& bank_register = *z80_bank.bank_register();
+	auto& bank_area = *z80_bank.bank_area();
+
+	for(std::uint32_t bank : {0, 1, 2, 1, 0})
+	{
+		select_bank(bank_register, bank);
+
+		for(std::uint32_t addr : {0x0000, 0x0001, 0x3FFF, 0x4000, 0x7FFE, 0x7FFF})
+			ASSERT_EQ(bank_byte((bank << 15) | addr), read_byte(bank_area, addr)) << "bank: " << bank;
+	}
+}
+
+TEST(SMD_Z80_68BANK, WRITE_SELECTED_BANK)
+{
+	auto m68k_area = std::shared_ptr<memory::addressable>(memory::make_memory_unit(0xFFFF, std::endian::big));
+
+	impl::z80_68bank z80_bank(m68k_area);
+	auto& bank_area = *z80_bank.bank_area();
+
+	select_bank(*z80_bank.bank_register(), 1);
+	bank_area.init_write(0x10, std::uint8_t(0xAB));
+
+	// writes go to the 68k memory and are visible via the bank
+	ASSERT_EQ(0xAB, read_byte(bank_area, 0x10));
+
+	m68k_area->init_read_byte(0x8010);
+	ASSERT_EQ(0xAB, m68k_area->latched_byte());
+}
@@ -0,0 +1,112 @@
+#include "helpers/random.h"
+#include "vdp/impl/compositor.h"
+#include "vdp/memory.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace genesis;
+using namespace genesis::vdp;
+using namespace genesis::vdp::impl;
+
+using isa_t = compositor::instruction_set;
+
+// straightforward implementation of the VDP layers priority
+static std::uint8_t expected_index(internal_pixel a, internal_pixel b, internal_pixel s, std::uint8_t bg_index)
+{
+	if(s.transparent())
+	{
+		if(a.transparent())
+			return b.transparent() ? bg_index : b.color_index();
+		if(a.priority())
+			return a.color_index();
+		if(b.priority() && !b.transparent())
+			return b.color_index();
+		return a.color_index();
+	}
+
+	if(s.priority())
+		return s.color_index();
+
+	if(a.priority() && !a.transparent())
+		return a.color_index();
+	if(b.priority() && !b.transparent())
+		return b.color_index();
+	return s.color_index();
+}
+
+static cram_t::color_table make_colors()
+{
+	cram_t::color_table colors;
+	for(std::size_t i = 0; i < colors.size(); ++i)
+		colors[i] = output_color(std::uint16_t(i << 1));
+	return colors;
+}
+
+static std::vector<internal_pixel> random_layer(std::size_t size)
+{
+	std::vector<internal_pixel> layer(size);
+	for(auto& px : layer)
+	{
+		// make transparent pixels more common
+		auto color = test::random::in_range<unsigned>(0, 2) == 0 ? 0 : test::random::in_range<unsigned>(1, 15);
+		px = internal_pixel(test::random::in_range<unsigned>(0, 3), color, test::random::in_range<unsigned>(0, 1) == 1);
+	}
+	return layer;
+}
+
+static void check_compose(isa_t isa)
+{
+	compositor comp(isa);
+	ASSERT_EQ(isa, comp.isa());
+
+	const auto colors = make_colors();
+
+	// check sizes which are not multiple of the batch size as well
+	for(std::size_t size : {0, 1, 15, 16, 17, 31, 32, 33, 256, 320, 333})
+	{
+		for(int i = 0; i < 20; ++i)
+		{
+			auto a = random_layer(size);
+			auto b = random_layer(size);
+			auto s = random_layer(size);
+			auto bg = std::uint8_t(test::random::next<std::uint8_t>() & 0x3F);
+
+			std::vector<output_color> dest(size);
+			comp.compose(a, b, s, bg, colors, std::span<output_color>(dest));
+
+			for(std::size_t px = 0; px < size; ++px)
+			{
+				auto expected = colors.at(expected_index(a[px], b[px], s[px], bg));
+				ASSERT_EQ(expected, dest[px]) << "size: " << size << ", pixel: " << px;
+			}
+		}
+	}
+}
+
+TEST(VDP_COMPOSITOR, SCALAR)
+{
+	ASSERT_TRUE(compositor::is_supported(isa_t::scalar));
+	check_compose(isa_t::scalar);
+}
+
+TEST(VDP_COMPOSITOR, SSE2)
+{
+	if(!compositor::is_supported(isa_t::sse2))
+		GTEST_SKIP() << "SSE2 is not supported";
+	check_compose(isa_t::sse2);
+}
+
+TEST(VDP_COMPOSITOR, AVX2)
+{
+	if(!compositor::is_supported(isa_t::avx2))
+		GTEST_SKIP() << "AVX2 is not supported";
+	check_compose(isa_t::avx2);
+}
+
+TEST(VDP_COMPOSITOR, BEST_SUPPORTED)
+{
+	auto best = compositor::best_supported();
+	ASSERT_TRUE(compositor::is_supported(best));
+	ASSERT_EQ(best, compositor().isa());
+}
@@ -620,6 +620,86 @@ TEST(VDP_DMA, BASIC_VRAM_COPY)
 }
 
 
+// run the second vdp by run() in chunks the same number of cycles the first one needs to complete DMA cycle by cycle
+void assert_run_matches_cycles(test::vdp& by_cycle, test::vdp& by_run, std::uint32_t chunk)
+{
+	const std::uint32_t cycles = by_cycle.wait_dma();
+
+	for(std::uint32_t done = 0; done < cycles - 1;)
+	{
+		std::uint32_t n = std::min(chunk, cycles - 1 - done);
+		by_run.run(n);
+		done += n;
+	}
+
+	// DMA must take exactly the same number of cycles
+	ASSERT_EQ(1, by_run.registers().SR.DMA);
+	by_run.run(1);
+	ASSERT_EQ(0, by_run.registers().SR.DMA);
+
+	for(std::uint32_t addr = 0; addr <= by_cycle.vram().max_address(); ++addr)
+		ASSERT_EQ(by_cycle.vram().read<std::uint8_t>(addr), by_run.vram().read<std::uint8_t>(addr)) << "address: " << addr;
+
+	for(std::uint16_t addr = 0; addr <= 126; addr += 2)
+		ASSERT_EQ(by_cycle.cram().read(addr), by_run.cram().read(addr)) << "address: " << addr;
+
+	for(std::uint16_t addr = 0; addr <= 78; addr += 2)
+		ASSERT_EQ(by_cycle.vsram().read(addr), by_run.vsram().read(addr)) << "address: " << addr;
+
+	ASSERT_EQ(by_cycle.registers().control.address(), by_run.registers().control.address());
+	ASSERT_EQ(by_cycle.sett().dma_length(), by_run.sett().dma_length());
+	ASSERT_EQ(by_cycle.sett().dma_source(), by_run.sett().dma_source());
+	ASSERT_EQ(by_cycle.registers().h_counter, by_run.registers().h_counter);
+	ASSERT_EQ(by_cycle.registers().v_counter, by_run.registers().v_counter);
+}
+
+TEST(VDP_DMA, BLOCK_FILL_MATCHES_CYCLE_BY_CYCLE)
+{
+	const auto fill_data = test::random::next<std::uint16_t>();
+
+	for(auto mem_type : {vmem_type::vram, vmem_type::cram, vmem_type::vsram})
+	{
+		test::vdp vdps[2];
+		for(auto& vdp : vdps)
+		{
+			vdp.zero_vram();
+			vdp.zero_cram();
+			vdp.zero_vsram();
+
+			// VRAM fill wraps around the end of VRAM
+			vdp.registers().R15.INC = 2;
+			if(mem_type != vmem_type::vram)
+				prepare_fill_data_for_cram_vsram(vdp, fill_data);
+			setup_dma_fill(vdp, 0xF000, 0x3000, mem_type, fill_data);
+		}
+
+		assert_run_matches_cycles(vdps[0], vdps[1], 1000);
+	}
+}
+
+TEST(VDP_DMA, BLOCK_VRAM_COPY_MATCHES_CYCLE_BY_CYCLE)
+{
+	const auto data = test::random::next_few<std::uint8_t>(0x3000);
+
+	// odd chunks split reading and writing of the same byte
+	for(std::uint32_t chunk : {37u, 1000u})
+	{
+		test::vdp vdps[2];
+		for(auto& vdp : vdps)
+		{
+			for(std::uint16_t i = 0; i < data.size(); ++i)
+				vdp.vram().write<std::uint8_t>(0x1000 + i, data[i]);
+
+			// overlapping ranges
+			vdp.registers().R15.INC = 1;
+			setup_dma_vram_copy(vdp, 0x1000, 0x1001, 0x2000);
+		}
+
+		assert_run_matches_cycles(vdps[0], vdps[1], chunk);
+	}
+}
+
+
 std::uint32_t setup_dma_m68k(test::vdp& vdp, std::uint32_t src_addr, std::uint16_t dst_addr, std::uint16_t length,
 							 vmem_type mem_type)
 {
@@ -772,3 +852,126 @@ TEST(VDP_DMA, BASIC_M68K_COPY_INTEGRATION_TEST)
 		ASSERT_EQ(expected_data, vdp_mem.read<std::uint16_t>(addr)) << "address: " << addr;
 	}
 }
+
+// M68K running a loop while VDP copies its memory, the devices are clocked the same way smd does
+class m68k_dma_system
+{
+public:
+	static constexpr std::uint32_t vdp_cycles_per_m68k_cycle = 7;
+	static constexpr std::uint32_t source_address = 0x10000;
+
+	m68k_dma_system(const std::vector<std::uint16_t>& data)
+		: vdp(std::make_shared<genesis::impl::m68k_bus_access_impl>(cpu.bus_access(), cpu.memory(),
+																	  vdp_cycles_per_m68k_cycle))
+	{
+		auto& mem = cpu.memory();
+
+		// SSP, PC
+		mem.write<std::uint32_t>(0x0, 0x00FF8000);
+		mem.write<std::uint32_t>(0x4, 0x100);
+
+		// loop: MULU D0, D1; MOVE.L D1, $FF0000; BRA.S loop
+		const std::uint16_t program[] = {0xC2C0, 0x23C1, 0x00FF, 0x0000, 0x60F6};
+		for(std::uint32_t i = 0; i < std::size(program); ++i)
+			mem.write<std::uint16_t>(0x100 + i * 2, program[i]);
+
+		for(std::uint32_t i = 0; i < data.size(); ++i)
+			mem.write<std::uint16_t>(source_address + i * 2, data[i]);
+
+		cpu.reset();
+		cpu.registers().D0.LW = 0x5555;
+
+		vdp.zero_vram();
+		vdp.zero_cram();
+		vdp.zero_vsram();
+		vdp.registers().R15.INC = 2;
+	}
+
+	// M68K cycle followed by VDP cycles till the next M68K cycle
+	void step(bool run_by_blocks)
+	{
+		cpu.cycle();
+
+		if(run_by_blocks)
+		{
+			vdp.run(vdp_cycles_per_m68k_cycle);
+			return;
+		}
+
+		for(std::uint32_t i = 0; i < vdp_cycles_per_m68k_cycle; ++i)
+			vdp.cycle();
+	}
+
+	test::test_cpu cpu;
+	test::vdp vdp;
+};
+
+TEST(VDP_DMA, BLOCK_M68K_COPY_MATCHES_CYCLE_BY_CYCLE)
+{
+	const auto data = test::random::next_few<std::uint16_t>(0x400);
+
+	m68k_dma_system by_cycle(data);
+	m68k_dma_system by_block(data);
+
+	struct dma_setup
+	{
+		std::uint16_t dest_address;
+		std::uint16_t length;
+		vmem_type mem_type;
+	};
+
+	// odd VRAM address swaps bytes
+	const dma_setup setups[] = {
+		{0x1000, 0x400, vmem_type::vram},
+		{0x2001, 0x100, vmem_type::vram},
+		{0x0, 64, vmem_type::cram},
+		{0x0, 40, vmem_type::vsram},
+	};
+
+	for(const auto& setup : setups)
+	{
+		for(auto* sys : {&by_cycle, &by_block})
+			setup_dma_m68k(sys->vdp, m68k_dma_system::source_address, setup.dest_address, setup.length,
+						   setup.mem_type);
+
+		// M68K must be stalled for exactly the same time, so compare the state after every M68K cycle
+		std::uint32_t cycles = 0;
+		while(by_cycle.vdp.registers().SR.DMA == 1)
+		{
+			by_cycle.step(false);
+			by_block.step(true);
+
+			ASSERT_EQ(by_cycle.vdp.registers().SR.DMA, by_block.vdp.registers().SR.DMA) << "cycle: " << cycles;
+			ASSERT_EQ(by_cycle.cpu.bus_access().bus_granted(), by_block.cpu.bus_access().bus_granted());
+			ASSERT_EQ(by_cycle.vdp.registers().control.address(), by_block.vdp.registers().control.address());
+			ASSERT_EQ(by_cycle.vdp.sett().dma_length(), by_block.vdp.sett().dma_length());
+			ASSERT_EQ(by_cycle.vdp.sett().dma_source(), by_block.vdp.sett().dma_source());
+			ASSERT_EQ(by_cycle.cpu.registers().PC, by_block.cpu.registers().PC);
+
+			ASSERT_LT(++cycles, 100'000u);
+		}
+
+		// let M68K run for a while
+		for(int i = 0; i < 1000; ++i)
+		{
+			by_cycle.step(false);
+			by_block.step(true);
+		}
+
+		ASSERT_EQ(by_cycle.cpu.registers().PC, by_block.cpu.registers().PC);
+		ASSERT_EQ(by_cycle.cpu.registers().D1.LW, by_block.cpu.registers().D1.LW);
+	}
+
+	for(std::uint32_t addr = 0; addr <= by_cycle.vdp.vram().max_address(); ++addr)
+		ASSERT_EQ(by_cycle.vdp.vram().read<std::uint8_t>(addr), by_block.vdp.vram().read<std::uint8_t>(addr))
+			<< "address: " << addr;
+
+	for(std::uint16_t addr = 0; addr <= 126; addr += 2)
+		ASSERT_EQ(by_cycle.vdp.cram().read(addr), by_block.vdp.cram().read(addr)) << "address: " << addr;
+
+	for(std::uint16_t addr = 0; addr <= 78; addr += 2)
+		ASSERT_EQ(by_cycle.vdp.vsram().read(addr), by_block.vdp.vsram().read(addr)) << "address: " << addr;
+
+	for(std::uint16_t i = 0; i < 0x400; ++i)
+		ASSERT_EQ(data[i], by_block.vdp.vram().read<std::uint16_t>(0x1000 + i * 2));
+}
@@ -0,0 +1,119 @@
+#include "vdp/framebuffer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace genesis::vdp;
+
+// fill the whole back buffer with the value
+static void render_frame(framebuffer& fb, std::uint32_t value)
+{
+	for(unsigned row = 0; row < framebuffer::max_height; ++row)
+	{
+		for(auto& px : fb.back_row<std::uint32_t>(row))
+			px = value;
+	}
+}
+
+static std::uint32_t first_pixel(const frame_view& frame)
+{
+	return *static_cast<const std::uint32_t*>(frame.pixels);
+}
+
+TEST(VDP_FRAMEBUFFER, NO_COMPLETED_FRAMES)
+{
+	framebuffer fb;
+	render_frame(fb, 1);
+
+	auto frame = fb.front();
+	ASSERT_EQ(0u, frame.width);
+	ASSERT_EQ(0u, frame.height);
+}
+
+TEST(VDP_FRAMEBUFFER, FRONT_RETURNS_LATEST_FRAME)
+{
+	framebuffer fb;
+
+	for(std::uint32_t value : {1, 2, 3})
+	{
+		render_frame(fb, value);
+		fb.swap(256 + value, 224);
+	}
+
+	auto frame = fb.front();
+	ASSERT_EQ(259u, frame.width);
+	ASSERT_EQ(224u, frame.height);
+	ASSERT_EQ(3u, first_pixel(frame));
+}
+
+TEST(VDP_FRAMEBUFFER, FRONT_IS_STABLE_TILL_NEXT_FRAME)
+{
+	framebuffer fb;
+
+	render_frame(fb, 1);
+	fb.swap(320, 224);
+	auto frame = fb.front();
+
+	// rendering of next frames does not touch the front buffer
+	for(std::uint32_t value : {2, 3, 4})
+	{
+		render_frame(fb, value);
+		ASSERT_EQ(1u, first_pixel(frame));
+		fb.swap(320, 240);
+		ASSERT_EQ(1u, first_pixel(frame));
+	}
+
+	// no new frames, so the same frame is returned
+	frame = fb.front();
+	ASSERT_EQ(4u, first_pixel(frame));
+	ASSERT_EQ(frame.pixels, fb.front().pixels);
+	ASSERT_EQ(240u, fb.front().height);
+}
+
+TEST(VDP_FRAMEBUFFER, CONCURRENT_PRODUCER_AND_CONSUMER)
+{
+	framebuffer fb;
+	const std::uint32_t frames = 2'000;
+	std::atomic<bool> done = false;
+
+	std::thread producer([&]() {
+		for(std::uint32_t value = 1; value <= frames; ++value)
+		{
+			render_frame(fb, value);
+			fb.swap(320, 240);
+		}
+		done = true;
+	});
+
+	// every picked up frame must be completed and frames must never go back in time
+	// (do not assert till the producer is joined)
+	std::uint32_t last_value = 0;
+	bool consistent = true;
+	bool finished = false;
+	while(!finished && consistent)
+	{
+		finished = done;
+
+		auto frame = fb.front();
+		if(frame.height == 0)
+			continue;
+
+		auto value = first_pixel(frame);
+		consistent = value >= last_value;
+		last_value = value;
+
+		for(unsigned row = 0; row < frame.height; ++row)
+		{
+			auto pixels = reinterpret_cast<const std::uint32_t*>(static_cast<const std::uint8_t*>(frame.pixels) +
+																 row * frame.pitch);
+			for(unsigned col = 0; col < frame.width; ++col)
+				consistent = consistent && pixels[col] == value;
+		}
+	}
+
+	producer.join();
+	ASSERT_TRUE(consistent);
+	ASSERT_EQ(frames, last_value);
+}
@@ -1,7 +1,11 @@
 #include "vdp/impl/hv_counters.h"
+#include "vdp/vdp.h"
 
+#include <algorithm>
+#include <cstring>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <vector>
 
 using namespace genesis::vdp;
 
@@ -89,3 +93,76 @@ TEST(VDP_V_COUNTER, NTSC_V30)
 	test_counter(0x00, 0xFF, 0x00, 0xFF, counter,
 				 [&counter]() { return counter.inc(display_height::c30, mode::NTSC); });
 }
+
+TEST(VDP_H_COUNTER, INCREMENTS_TO)
+{
+	for(auto width : {display_width::c32, display_width::c40})
+	{
+		genesis::vdp::impl::h_counter counter;
+
+		// walk through 2 periods to check every start position
+		for(int i = 0; i < 420; ++i)
+		{
+			auto targets = width == display_width::c32 ? std::vector<int>{0x02, 0x05, 0x85, 0x86, 0x93}
+													   : std::vector<int>{0x02, 0x06, 0xA5, 0xA6, 0xB3};
+			for(int target : targets)
+			{
+				auto copy = counter;
+				int expected = 0;
+				do
+				{
+					copy.inc(width);
+					++expected;
+				} while(copy.raw_value() != target);
+
+				ASSERT_EQ(expected, counter.increments_to(target, width))
+					<< "raw: " << counter.raw_value() << ", target: " << target;
+			}
+
+			counter.inc(width);
+		}
+	}
+}
+
+TEST(VDP, RUN_MATCHES_CYCLE)
+{
+	genesis::vdp::vdp expected;
+	genesis::vdp::vdp actual;
+
+	auto check_equal = [&]() {
+		ASSERT_EQ(expected.registers().h_counter, actual.registers().h_counter);
+		ASSERT_EQ(expected.registers().v_counter, actual.registers().v_counter);
+		ASSERT_EQ(expected.registers().sr_raw, actual.registers().sr_raw);
+		ASSERT_EQ(expected.frame_count(), actual.frame_count());
+
+		auto expected_row = expected.framebuffer().back_row<std::uint32_t>(100);
+		auto actual_row = actual.framebuffer().back_row<std::uint32_t>(100);
+		ASSERT_TRUE(std::equal(expected_row.begin(), expected_row.end(), actual_row.begin()));
+
+		auto expected_frame = expected.framebuffer().front();
+		auto actual_frame = actual.framebuffer().front();
+		ASSERT_EQ(expected_frame.width, actual_frame.width);
+		ASSERT_EQ(expected_frame.height, actual_frame.height);
+		ASSERT_EQ(0, std::memcmp(expected_frame.pixels, actual_frame.pixels,
+								 expected_frame.pitch * genesis::vdp::framebuffer::max_height));
+	};
+
+	const std::uint32_t batches[] = {1, 7, 15, 16, 3420, 5000, 100'000};
+	for(int step = 0; step < 50; ++step)
+	{
+		// switch display width from time to time
+		if(step % 10 == 5)
+		{
+			std::uint16_t reg12 = step % 20 == 5 ? 0x8C81 : 0x8C00;
+			expected.io_ports().init_write_control(reg12);
+			actual.io_ports().init_write_control(reg12);
+		}
+
+		auto cycles = batches[step % std::size(batches)];
+		for(std::uint32_t i = 0; i < cycles; ++i)
+			expected.cycle();
+		actual.run(cycles);
+
+		check_equal();
+	}
+}
@@ -0,0 +1,150 @@
+#include "helpers/random.h"
+#include "vdp/impl/line_state_log.h"
+#include "vdp/memory.h"
+#include "vdp/register_set.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace genesis;
+using namespace genesis::vdp;
+using namespace genesis::vdp::impl;
+using namespace genesis::test;
+
+struct log_fixture
+{
+	register_set regs;
+	vram_t vram;
+	cram_t cram;
+	vsram_t vsram;
+	line_state_log log;
+
+	void record(unsigned line)
+	{
+		log.record(line, regs, vram, cram, vsram);
+	}
+};
+
+TEST(VDP_LINE_STATE_LOG, REGISTERS_ARE_CAPTURED_PER_LINE)
+{
+	log_fixture f;
+
+	auto values = random::next_few<std::uint8_t>(24);
+	for(std::uint8_t reg = 0; reg < 24; ++reg)
+		f.regs.set_register(reg, values[reg]);
+	f.regs.sr_raw = random::next<std::uint16_t>();
+	f.record(0);
+
+	f.regs.set_register(7, static_cast<std::uint8_t>(~values[7]));
+	f.record(1);
+
+	auto lines = f.log.lines();
+	ASSERT_EQ(2u, lines.size());
+	for(std::uint8_t reg = 0; reg < 24; ++reg)
+		ASSERT_EQ(values[reg], lines[0].registers[reg]);
+	ASSERT_EQ(f.regs.sr_raw, lines[0].status);
+
+	ASSERT_EQ(0u, lines[0].line);
+	ASSERT_EQ(1u, lines[1].line);
+	ASSERT_EQ(std::uint8_t(~values[7]), lines[1].registers[7]);
+}
+
+TEST(VDP_LINE_STATE_LOG, MEMORIES_ARE_CAPTURED_ONLY_IF_MODIFIED)
+{
+	log_fixture f;
+
+	auto color = random::next<std::uint16_t>() & 0x0EEE;
+	auto vscroll = random::next<std::uint16_t>() & 0x07FF;
+	auto data = random::next<std::uint8_t>();
+
+	f.record(0);
+	f.record(1);
+
+	f.cram.write(10, color);
+	f.record(2);
+
+	f.vsram.write(4, vscroll);
+	f.record(3);
+
+	f.vram.write<std::uint8_t>(0x1234, data);
+	f.record(4);
+	f.record(5);
+
+	auto lines = f.log.lines();
+	ASSERT_EQ(6u, lines.size());
+
+	const std::uint32_t expected_cram[] = {0, 0, 1, 1, 1, 1};
+	const std::uint32_t expected_vsram[] = {0, 0, 0, 1, 1, 1};
+	const std::uint32_t expected_vram[] = {0, 0, 0, 0, 1, 1};
+	for(std::size_t i = 0; i < lines.size(); ++i)
+	{
+		ASSERT_EQ(expected_cram[i], lines[i].cram_version) << "line: " << i;
+		ASSERT_EQ(expected_vsram[i], lines[i].vsram_version) << "line: " << i;
+		ASSERT_EQ(expected_vram[i], lines[i].vram_version) << "line: " << i;
+	}
+
+	ASSERT_EQ(0, f.log.cram(0)[5]);
+	ASSERT_EQ(color, f.log.cram(1)[5]);
+
+	ASSERT_EQ(0, f.log.vsram(0)[2]);
+	ASSERT_EQ(vscroll, f.log.vsram(1)[2]);
+
+	ASSERT_EQ(0, f.log.vram_base()[0x1234]);
+
+	// only the modified pattern is kept
+	auto patterns = f.log.vram_patterns(1);
+	ASSERT_EQ(1u, patterns.size());
+	ASSERT_EQ(1u, f.log.vram_delta(1).count());
+	ASSERT_TRUE(f.log.vram_delta(1).test(0x1234 / vram_t::pattern_size));
+	ASSERT_EQ(data, patterns[0][0x1234 % vram_t::pattern_size]);
+}
+
+TEST(VDP_LINE_STATE_LOG, VRAM_IS_REBUILT_FROM_BASE_AND_DELTAS)
+{
+	log_fixture f;
+
+	for(int i = 0; i < 100; ++i)
+		f.vram.write(random::next<std::uint16_t>(), random::next<std::uint8_t>());
+
+	std::vector<vram_t::content> expected(5);
+	for(unsigned line = 0; line < expected.size(); ++line)
+	{
+		for(int i = 0; i < 10; ++i)
+			f.vram.write(random::next<std::uint16_t>() & 0xFFFE, random::next<std::uint16_t>());
+		f.vram.snapshot(expected[line]);
+		f.record(line);
+	}
+
+	ASSERT_EQ(expected[0], f.log.vram_base());
+	ASSERT_TRUE(f.log.vram_patterns(0).empty());
+
+	vram_t rebuilt;
+	rebuilt.restore(f.log.vram_base());
+	for(std::uint32_t version = 1; version < expected.size(); ++version)
+	{
+		ASSERT_LE(f.log.vram_patterns(version).size(), 20u);
+		rebuilt.restore(f.log.vram_delta(version), f.log.vram_patterns(version));
+
+		vram_t::content content;
+		rebuilt.snapshot(content);
+		ASSERT_EQ(expected[version], content) << "version: " << version;
+	}
+}
+
+TEST(VDP_LINE_STATE_LOG, LINE_0_STARTS_NEW_FRAME)
+{
+	log_fixture f;
+
+	f.record(0);
+	f.record(1);
+	f.cram.write(0, 0x0EEE);
+	f.record(2);
+
+	auto id = f.log.id();
+	f.record(0);
+
+	ASSERT_NE(id, f.log.id());
+	ASSERT_EQ(1u, f.log.lines().size());
+	ASSERT_EQ(0u, f.log.lines()[0].cram_version);
+	ASSERT_EQ(0x0EEE, f.log.cram(0)[0]);
+}
@@ -0,0 +1,111 @@
+#include "helpers/random.h"
+#include "vdp/impl/name_table.h"
+#include "vdp/impl/plane_cache.h"
+#include "vdp/memory.h"
+#include "vdp/register_set.h"
+#include "vdp/settings.h"
+
+#include <gtest/gtest.h>
+
+using namespace genesis;
+using namespace genesis::vdp;
+using namespace genesis::vdp::impl;
+
+static bool operator==(const name_table_entry& a, const name_table_entry& b)
+{
+	return a.effective_pattern_address() == b.effective_pattern_address() &&
+		   a.horizontal_flip == b.horizontal_flip && a.vertical_flip == b.vertical_flip &&
+		   a.palette == b.palette && a.priority == b.priority;
+}
+
+static void check_entries(plane_cache& cache, plane_type plane, settings& sett, vram_t& vram)
+{
+	cache.update();
+
+	name_table table(plane, sett, vram);
+	ASSERT_EQ(table.entries_per_row(), cache.entries_per_row());
+	ASSERT_EQ(table.row_count(), cache.row_count());
+
+	for(int row = 0; row < table.row_count(); ++row)
+	{
+		for(int col = 0; col < table.entries_per_row(); ++col)
+		{
+			ASSERT_TRUE(table.get(row, col) == cache.get(row, col)) << "row: " << row << ", col: " << col;
+		}
+	}
+}
+
+static void fill_vram(vram_t& vram)
+{
+	for(std::uint32_t address = 0; address < 0x10000; address += 2)
+		vram.write<std::uint16_t>(address, test::random::next<std::uint16_t>());
+}
+
+TEST(VDP_PLANE_CACHE, DECODE_ENTRIES)
+{
+	register_set regs;
+	settings sett(regs);
+	vram_t vram;
+	fill_vram(vram);
+
+	regs.R2.PA5_3 = 0b011;
+	regs.R16.W = 0b01;
+	regs.R16.H = 0b00;
+
+	plane_cache cache(plane_type::a, regs, sett, vram);
+	check_entries(cache, plane_type::a, sett, vram);
+}
+
+TEST(VDP_PLANE_CACHE, INVALIDATE_ON_VRAM_WRITE)
+{
+	register_set regs;
+	settings sett(regs);
+	vram_t vram;
+	fill_vram(vram);
+
+	regs.R4.PB2_0 = 0b101;
+
+	plane_cache cache(plane_type::b, regs, sett, vram);
+	check_entries(cache, plane_type::b, sett, vram);
+
+	for(int i = 0; i < 50; ++i)
+	{
+		std::uint32_t address = sett.plane_b_address() + test::random::in_range<std::uint32_t>(0, 32 * 32 - 1) * 2;
+		vram.write<std::uint16_t>(address, test::random::next<std::uint16_t>());
+		check_entries(cache, plane_type::b, sett, vram);
+	}
+
+	// write through the addressable interface
+	vram.init_write(sett.plane_b_address() + 10, std::uint16_t(0xFFFF));
+	check_entries(cache, plane_type::b, sett, vram);
+}
+
+TEST(VDP_PLANE_CACHE, INVALIDATE_ON_REGISTERS_CHANGE)
+{
+	register_set regs;
+	settings sett(regs);
+	vram_t vram;
+	fill_vram(vram);
+
+	plane_cache a_cache(plane_type::a, regs, sett, vram);
+	plane_cache w_cache(plane_type::w, regs, sett, vram);
+	check_entries(a_cache, plane_type::a, sett, vram);
+	check_entries(w_cache, plane_type::w, sett, vram);
+
+	// plane address
+	regs.R2.PA5_3 = 0b110;
+	check_entries(a_cache, plane_type::a, sett, vram);
+
+	// plane size
+	regs.R16.W = 0b11;
+	regs.R16.H = 0b00;
+	check_entries(a_cache, plane_type::a, sett, vram);
+
+	// window address
+	regs.R3.W5_1 = 0b10011;
+	check_entries(w_cache, plane_type::w, sett, vram);
+
+	// display width changes window width
+	regs.R12.RS0 = regs.R12.RS1 = 1;
+	check_entries(w_cache, plane_type::w, sett, vram);
+}
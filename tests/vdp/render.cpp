@@ -3,8 +3,13 @@
 #include "renderer_builder.hpp"
 #include "test_vdp.h"
 #include "vdp/impl/plane_type.h"
+#include "vdp/impl/render_pool.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <gtest/gtest.h>
+#include <thread>
 using genesis::vdp::impl::plane_type;
 
 using namespace genesis::test;
@@ -533,6 +538,151 @@ TEST(VDP_RENDERER, ACTIVE_AB_PLANE_DRAW_TAIL)
 	}
 }
 
+TEST(VDP_RENDERER, FRAMEBUFFER_RENDERED_DURING_EMULATION)
+{
+	for(auto format : {genesis::vdp::pixel_format::argb8888, genesis::vdp::pixel_format::rgb565})
+	{
+		vdp vdp;
+		renderer_builder builder(vdp);
+		vdp.set_pixel_format(format);
+
+		builder.setup_plane(plane_type::a, random_tail(), random::is_true(), random::is_true(), random_palette(),
+							false);
+		builder.setup_plane(plane_type::b, transparent_tail());
+		builder.setup_plane(plane_type::w, transparent_tail());
+		fill_cram(vdp);
+
+		// there are no completed frames yet
+		ASSERT_EQ(0, vdp.framebuffer().front().height);
+
+		// run a bit more than a frame, so every row of the active display is rendered
+		const std::uint32_t mclk_per_frame = 3420 * 313;
+		vdp.run(mclk_per_frame + 3420);
+
+		auto& render = vdp.render();
+		auto frame = vdp.framebuffer().front();
+		ASSERT_EQ(format, frame.format);
+		ASSERT_EQ(render.active_display_width(), frame.width);
+		ASSERT_EQ(render.active_display_height(), frame.height);
+
+		for(unsigned row_idx = 0; row_idx < frame.height; ++row_idx)
+		{
+			auto expected = render.get_active_display_row(row_idx, plane_buffer);
+			auto row = static_cast<const std::uint8_t*>(frame.pixels) + row_idx * frame.pitch;
+
+			for(unsigned col = 0; col < frame.width; ++col)
+			{
+				if(format == genesis::vdp::pixel_format::argb8888)
+				{
+					std::uint32_t pixel;
+					std::memcpy(&pixel, row + col * sizeof(pixel), sizeof(pixel));
+					ASSERT_EQ(genesis::vdp::to_argb8888(expected[col]), pixel) << "row: " << row_idx;
+				}
+				else
+				{
+					std::uint16_t pixel;
+					std::memcpy(&pixel, row + col * sizeof(pixel), sizeof(pixel));
+					ASSERT_EQ(genesis::vdp::to_rgb565(expected[col]), pixel) << "row: " << row_idx;
+				}
+			}
+		}
+	}
+}
+
+// copy memories and registers, so both VDPs render the same output
+static void copy_vdp_state(vdp& src, vdp& dest)
+{
+	for(std::uint32_t addr = 0; addr <= 0xFFFF; ++addr)
+		dest.vram().write<std::uint8_t>(addr, src.vram().read<std::uint8_t>(addr));
+	for(std::uint16_t addr = 0; addr < 128; addr += 2)
+		dest.cram().write(addr, src.cram().read(addr));
+	for(std::uint16_t addr = 0; addr < 80; addr += 2)
+		dest.vsram().write(addr, src.vsram().read(addr));
+	for(std::uint8_t reg = 0; reg < 24; ++reg)
+		dest.registers().set_register(reg, src.registers().get_register(reg));
+}
+
+TEST(VDP_RENDERER, PARALLEL_RENDER_MATCHES_SERIAL)
+{
+	vdp serial;
+	renderer_builder builder(serial);
+
+	builder.setup_plane(plane_type::a, random_tail(), random::is_true(), random::is_true(), random_palette(), false);
+	builder.setup_plane(plane_type::b, random_tail(), random::is_true(), random::is_true(), random_palette(), true);
+	builder.set_screen_hscroll(random::next<std::uint16_t>(), random::next<std::uint16_t>());
+	fill_cram(serial);
+
+	vdp parallel;
+	copy_vdp_state(serial, parallel);
+	parallel.set_render_threads(3);
+
+	// modify memories in the middle of the active display, lines must be rendered from the state at their time
+	const auto cram_addr = static_cast<std::uint16_t>(random::in_range<unsigned>(0, 63) * 2);
+	const auto cram_data = random::next<std::uint16_t>();
+	const auto vsram_data = random::next<std::uint16_t>();
+	// renderer_builder keeps plane tails at the end of VRAM
+	const auto tails = random::next_few<std::uint8_t>(0x60);
+
+	const std::uint32_t mclk_per_line = 3420;
+	const std::uint32_t mclk_per_frame = mclk_per_line * 313;
+	for(auto* v : {&serial, &parallel})
+	{
+		v->run(mclk_per_frame + mclk_per_line * 50);
+
+		v->cram().write(cram_addr, cram_data);
+		v->run(mclk_per_line * 30);
+
+		v->vsram().write(0, vsram_data);
+		v->run(mclk_per_line * 30);
+
+		for(std::uint32_t i = 0; i < tails.size(); ++i)
+			v->vram().write<std::uint8_t>(0xFFA0 + i, tails[i]);
+		v->run(mclk_per_frame - mclk_per_line * 110);
+	}
+
+	parallel.wait_render();
+	ASSERT_EQ(serial.registers().sr_raw, parallel.registers().sr_raw);
+
+	auto expected = serial.framebuffer().front();
+	auto actual = parallel.framebuffer().front();
+	ASSERT_NE(0u, expected.height);
+	ASSERT_EQ(expected.width, actual.width);
+	ASSERT_EQ(expected.height, actual.height);
+
+	for(unsigned row = 0; row < expected.height; ++row)
+	{
+		auto expected_row = static_cast<const std::uint8_t*>(expected.pixels) + row * expected.pitch;
+		auto actual_row = static_cast<const std::uint8_t*>(actual.pixels) + row * actual.pitch;
+		ASSERT_EQ(0, std::memcmp(expected_row, actual_row, expected.width * 4)) << "row: " << row;
+	}
+}
+
+TEST(VDP_RENDERER, RENDER_POOL_BACK_TO_BACK_FRAMES)
+{
+	vdp vdp;
+	renderer_builder builder(vdp);
+	builder.setup_plane(plane_type::a, random_tail(), random::is_true(), random::is_true(), random_palette(), false);
+	fill_cram(vdp);
+
+	// every frame gives workers the same shares, so a late stealer could mix up ranges of consecutive frames
+	genesis::vdp::impl::line_state_log log;
+	for(unsigned line = 0; line < 32; ++line)
+		log.record(line, vdp.registers(), vdp.vram(), vdp.cram(), vdp.vsram());
+
+	// more workers than cores, so they get preempted in the middle of stealing
+	const unsigned threads = std::max(2u, std::thread::hardware_concurrency()) * 4;
+	genesis::vdp::impl::render_pool pool(threads);
+	genesis::vdp::framebuffer fb;
+
+	const unsigned frames = 10000;
+	std::atomic<unsigned> completed = 0;
+	for(unsigned frame = 0; frame < frames; ++frame)
+		pool.render(log, fb, [&]() { completed.fetch_add(1, std::memory_order_relaxed); });
+	pool.wait();
+
+	ASSERT_EQ(frames, completed.load());
+}
+
 TEST(VDP_RENDERER, ACTIVE_W_PLANE_DRAW_TAIL)
 {
 	vdp vdp;
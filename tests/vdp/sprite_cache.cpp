@@ -0,0 +1,140 @@
+#include "helpers/random.h"
+#include "vdp/impl/sprite_cache.h"
+#include "vdp/impl/sprite_table.h"
+#include "vdp/memory.h"
+#include "vdp/register_set.h"
+#include "vdp/settings.h"
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace genesis;
+using namespace genesis::vdp;
+using namespace genesis::vdp::impl;
+
+// walk the link chain and collect entries intersecting the line
+static std::vector<sprite_table_entry> expected_line_sprites(unsigned line, settings& sett, vram_t& vram)
+{
+	std::vector<sprite_table_entry> res;
+	sprite_table stable(sett, vram);
+
+	int sprite_number = 0;
+	for(int i = 0; i < stable.num_entries(); ++i)
+	{
+		auto entry = stable.get(sprite_number);
+
+		unsigned last_line = entry.vertical_position + (entry.vertical_size + 1) * 8;
+		if(entry.vertical_position <= line && line < last_line)
+			res.push_back(entry);
+
+		sprite_number = entry.link;
+		if(sprite_number == 0 || sprite_number >= stable.num_entries())
+			break;
+	}
+
+	return res;
+}
+
+static bool equal(const sprite_table_entry& a, const sprite_table_entry& b)
+{
+	return a.vertical_position == b.vertical_position && a.horizontal_position == b.horizontal_position &&
+		   a.vertical_size == b.vertical_size && a.horizontal_size == b.horizontal_size &&
+		   a.vertical_flip == b.vertical_flip && a.horizontal_flip == b.horizontal_flip &&
+		   a.pattern_address == b.pattern_address && a.palette == b.palette && a.link == b.link &&
+		   a.priority_flag == b.priority_flag;
+}
+
+static void check_lines(sprite_cache& cache, settings& sett, vram_t& vram)
+{
+	cache.update();
+
+	for(unsigned line = 0; line < sprite_cache::num_lines; ++line)
+	{
+		auto expected = expected_line_sprites(line, sett, vram);
+		auto actual = cache.line_sprites(line);
+
+		ASSERT_EQ(expected.size(), actual.size()) << "line: " << line;
+		for(std::size_t i = 0; i < expected.size(); ++i)
+		{
+			ASSERT_TRUE(equal(expected[i], cache.entry(actual[i]))) << "line: " << line << ", sprite: " << i;
+		}
+	}
+}
+
+// fill SAT with random sprites linked one by one
+static void fill_sat(settings& sett, vram_t& vram, int num_sprites)
+{
+	std::uint32_t address = sett.sprite_address();
+	for(int i = 0; i < num_sprites; ++i)
+	{
+		std::uint32_t entry = address + i * 8;
+		for(std::uint32_t offset = 0; offset < 8; ++offset)
+			vram.write<std::uint8_t>(entry + offset, test::random::next<std::uint8_t>());
+
+		// place sprites close to the active display
+		vram.write<std::uint16_t>(entry, test::random::in_range<std::uint16_t>(100, 400));
+
+		auto link = std::uint8_t(i + 1 < num_sprites ? i + 1 : 0);
+		vram.write<std::uint8_t>(entry + 3, link);
+	}
+}
+
+TEST(VDP_SPRITE_CACHE, LINE_SPRITES)
+{
+	register_set regs;
+	settings sett(regs);
+	vram_t vram;
+
+	regs.R5.ST6_0 = 0b1010100;
+
+	for(int i = 0; i < 10; ++i)
+	{
+		sprite_cache cache(regs, sett, vram);
+		fill_sat(sett, vram, 80);
+		check_lines(cache, sett, vram);
+	}
+}
+
+TEST(VDP_SPRITE_CACHE, INVALIDATE_ON_SAT_WRITE)
+{
+	register_set regs;
+	settings sett(regs);
+	vram_t vram;
+
+	regs.R5.ST6_0 = 0b0110100;
+
+	sprite_cache cache(regs, sett, vram);
+	fill_sat(sett, vram, 64);
+	check_lines(cache, sett, vram);
+
+	for(int i = 0; i < 20; ++i)
+	{
+		std::uint32_t address = sett.sprite_address() + test::random::in_range<std::uint32_t>(0, 64 * 8 - 1);
+		vram.write<std::uint8_t>(address, test::random::next<std::uint8_t>());
+		check_lines(cache, sett, vram);
+	}
+}
+
+TEST(VDP_SPRITE_CACHE, INVALIDATE_ON_REGISTERS_CHANGE)
+{
+	register_set regs;
+	settings sett(regs);
+	vram_t vram;
+
+	// fill 2 tables, so only the registers change between the checks
+	regs.R5.ST6_0 = 0b1000000;
+	fill_sat(sett, vram, 80);
+	regs.R5.ST6_0 = 0b0100000;
+	fill_sat(sett, vram, 80);
+
+	sprite_cache cache(regs, sett, vram);
+	check_lines(cache, sett, vram);
+
+	// SAT address
+	regs.R5.ST6_0 = 0b1000000;
+	check_lines(cache, sett, vram);
+
+	// H40 mode has 80 sprites
+	regs.R12.RS0 = regs.R12.RS1 = 1;
+	check_lines(cache, sett, vram);
+}
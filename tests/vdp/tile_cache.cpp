@@ -0,0 +1,102 @@
+#include "helpers/random.h"
+#include "vdp/impl/tile_cache.h"
+#include "vdp/memory.h"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+
+using namespace genesis;
+using namespace genesis::vdp;
+
+// decode pattern pixel directly from VRAM (row/col - zero based, before flipping)
+static std::uint8_t expected_pixel(vram_t& vram, std::uint32_t pattern_address, int row, int col, bool hflip,
+								   bool vflip)
+{
+	if(hflip)
+		col = 7 - col;
+	if(vflip)
+		row = 7 - row;
+
+	std::uint8_t data = vram.read<std::uint8_t>(pattern_address + row * 4 + col / 2);
+	return col % 2 == 0 ? data >> 4 : data & 0xF;
+}
+
+static void check_pattern(impl::tile_cache& cache, vram_t& vram, std::uint32_t pattern_address)
+{
+	for(bool hflip : {false, true})
+	{
+		for(bool vflip : {false, true})
+		{
+			for(int row = 0; row < 8; ++row)
+			{
+				const std::uint8_t* line = cache.line(pattern_address, row, hflip, vflip);
+				for(int col = 0; col < 8; ++col)
+				{
+					ASSERT_EQ(expected_pixel(vram, pattern_address, row, col, hflip, vflip), line[col])
+						<< "row: " << row << ", col: " << col << ", hflip: " << hflip << ", vflip: " << vflip;
+				}
+			}
+		}
+	}
+}
+
+static void fill_pattern(vram_t& vram, std::uint32_t pattern_address)
+{
+	for(std::uint32_t i = 0; i < vram_t::pattern_size; ++i)
+		vram.write<std::uint8_t>(pattern_address + i, test::random::next<std::uint8_t>());
+}
+
+TEST(VDP_TILE_CACHE, DECODE_PATTERNS)
+{
+	vram_t vram;
+	impl::tile_cache cache(vram);
+
+	for(std::uint32_t pattern = 0; pattern < vram_t::num_patterns; ++pattern)
+		fill_pattern(vram, pattern * vram_t::pattern_size);
+
+	for(std::uint32_t pattern = 0; pattern < vram_t::num_patterns; ++pattern)
+	{
+		check_pattern(cache, vram, pattern * vram_t::pattern_size);
+		if(testing::Test::HasFatalFailure())
+			FAIL() << "pattern: " << pattern;
+	}
+}
+
+TEST(VDP_TILE_CACHE, INVALIDATE_ON_WRITE)
+{
+	vram_t vram;
+	impl::tile_cache cache(vram);
+
+	const std::uint32_t pattern_address = 0x1240;
+	fill_pattern(vram, pattern_address);
+	check_pattern(cache, vram, pattern_address);
+
+	// byte write
+	vram.write<std::uint8_t>(pattern_address + 5, 0x9A);
+	check_pattern(cache, vram, pattern_address);
+
+	// word write
+	vram.write<std::uint16_t>(pattern_address + 30, 0x1F2E);
+	check_pattern(cache, vram, pattern_address);
+
+	// addressable interface
+	vram.init_write(pattern_address + 12, std::uint16_t(0x3C4D));
+	check_pattern(cache, vram, pattern_address);
+
+	// write crossing the pattern boundary
+	vram.write<std::uint16_t>(pattern_address - 1, 0x5E6F);
+	check_pattern(cache, vram, pattern_address);
+	check_pattern(cache, vram, pattern_address - vram_t::pattern_size);
+}
+
+TEST(VDP_TILE_CACHE, PATTERN_ADDRESS_WRAPS)
+{
+	vram_t vram;
+	impl::tile_cache cache(vram);
+
+	fill_pattern(vram, 0);
+
+	const std::uint8_t* line = cache.line(0x10000, 0, false, false);
+	const std::uint8_t* expected = cache.line(0, 0, false, false);
+	ASSERT_TRUE(std::equal(line, line + 8, expected));
+}
@@ -0,0 +1,122 @@
+#include "helpers/random.h"
+#include "vdp/memory.h"
+#include "vdp/write_tracker.h"
+
+#include <gtest/gtest.h>
+
+using namespace genesis;
+using namespace genesis::vdp;
+using namespace genesis::test;
+
+TEST(VDP_WRITE_TRACKER, INITIAL_CONTENT_IS_MODIFIED_SINCE_0)
+{
+	write_tracker<64, 8> tracker;
+
+	ASSERT_NE(0u, tracker.generation());
+	ASSERT_TRUE(tracker.modified_since(0));
+	ASSERT_TRUE(tracker.modified_since(0, 10, 10));
+	ASSERT_TRUE(tracker.modified_blocks(0).all());
+
+	ASSERT_FALSE(tracker.modified_since(tracker.generation()));
+	ASSERT_TRUE(tracker.modified_blocks(tracker.generation()).none());
+}
+
+TEST(VDP_WRITE_TRACKER, ONLY_WRITTEN_BLOCKS_ARE_MODIFIED)
+{
+	write_tracker<64, 8> tracker;
+	auto gen = tracker.generation();
+
+	tracker.mark(15, 17);
+	ASSERT_EQ(gen + 1, tracker.generation());
+	ASSERT_EQ(tracker.generation(), tracker.block_generation(16));
+	ASSERT_EQ(gen, tracker.block_generation(18));
+
+	ASSERT_TRUE(tracker.modified_since(gen, 0, 15));
+	ASSERT_TRUE(tracker.modified_since(gen, 17, 63));
+	ASSERT_FALSE(tracker.modified_since(gen, 0, 14));
+	ASSERT_FALSE(tracker.modified_since(gen, 18, 63));
+
+	// blocks of the same region which were not written
+	ASSERT_FALSE(tracker.modified_since(gen, 8, 14));
+	ASSERT_FALSE(tracker.modified_since(gen, 18, 23));
+
+	auto blocks = tracker.modified_blocks(gen);
+	ASSERT_EQ(3u, blocks.count());
+	ASSERT_TRUE(blocks.test(15) && blocks.test(16) && blocks.test(17));
+
+	// nothing is modified since the latest generation
+	gen = tracker.generation();
+	ASSERT_FALSE(tracker.modified_since(gen, 0, 63));
+}
+
+TEST(VDP_WRITE_TRACKER, VRAM_RANGE_WRAPS_AROUND)
+{
+	vram_t vram;
+	auto gen = vram.generation();
+
+	vram.write<std::uint8_t>(0x0010, random::next<std::uint8_t>());
+
+	ASSERT_TRUE(vram.modified_since(gen, 0xFFF0, 0x40));
+	ASSERT_TRUE(vram.modified_since(gen, 0x0000, 0x20));
+	ASSERT_FALSE(vram.modified_since(gen, 0x0020, 0xFFC0));
+	ASSERT_FALSE(vram.modified_since(gen, 0x0010, 0));
+
+	auto patterns = vram.modified_patterns(gen);
+	ASSERT_EQ(1u, patterns.count());
+	ASSERT_TRUE(patterns.test(0));
+}
+
+TEST(VDP_WRITE_TRACKER, VRAM_WORD_WRITE_MARKS_BOTH_PATTERNS)
+{
+	vram_t vram;
+	auto gen = vram.generation();
+
+	vram.write<std::uint16_t>(0x003F, random::next<std::uint16_t>());
+
+	auto patterns = vram.modified_patterns(gen);
+	ASSERT_EQ(2u, patterns.count());
+	ASSERT_TRUE(patterns.test(1) && patterns.test(2));
+}
+
+TEST(VDP_WRITE_TRACKER, VRAM_PARTIAL_RESTORE)
+{
+	vram_t src;
+	src.write<std::uint8_t>(0x0000, 0x11);
+	src.write<std::uint8_t>(0x0100, 0x22);
+
+	vram_t::content snapshot;
+	src.snapshot(snapshot);
+
+	vram_t dst;
+	auto gen = dst.generation();
+
+	vram_t::pattern_set patterns;
+	patterns.set(0x0100 / vram_t::pattern_size);
+	dst.restore(snapshot, patterns);
+
+	ASSERT_EQ(0, dst.read<std::uint8_t>(0x0000));
+	ASSERT_EQ(0x22, dst.read<std::uint8_t>(0x0100));
+	ASSERT_EQ(patterns, dst.modified_patterns(gen));
+}
+
+TEST(VDP_WRITE_TRACKER, CRAM_AND_VSRAM_TRACK_ENTRIES)
+{
+	cram_t cram;
+	vsram_t vsram;
+	auto cram_gen = cram.generation();
+	auto vsram_gen = vsram.generation();
+
+	cram.write(0x0A, 0x0EEE);
+	vsram.write(0x4E, 0x07FF);
+
+	// out of range VSRAM writes are ignored
+	vsram.write(0x50, 0x07FF);
+
+	auto colors = cram.modified_colors(cram_gen);
+	ASSERT_EQ(1u, colors.count());
+	ASSERT_TRUE(colors.test(5));
+
+	auto entries = vsram.modified_entries(vsram_gen);
+	ASSERT_EQ(1u, entries.count());
+	ASSERT_TRUE(entries.test(39));
+}
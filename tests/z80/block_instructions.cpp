@@ -0,0 +1,158 @@
+#include "helpers/random.h"
+#include "memory/memory_builder.h"
+#include "memory/memory_unit.h"
+#include "z80/cpu.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+
+using namespace genesis;
+using namespace genesis::test;
+
+
+struct block_setup
+{
+	z80::opcode opcode;
+	std::uint16_t bc;
+	std::uint16_t de;
+	std::uint16_t hl;
+	std::uint8_t a = 0;
+	bool mirrored_ram = false;
+};
+
+static std::shared_ptr<z80::memory> make_memory(bool mirrored_ram)
+{
+	if(!mirrored_ram)
+		return std::make_shared<z80::memory>();
+
+	// RAM is mirrored at 0x2000-0x3FFF as on Genesis
+	memory::memory_builder builder;
+	builder.add_unique(memory::make_memory_unit(0x1FFF, std::endian::little), 0x0, 0x1FFF);
+	builder.mirror(0x0, 0x1FFF, 0x2000, 0x3FFF);
+	builder.add_unique(memory::make_memory_unit(0xBFFF, std::endian::little), 0x4000, 0xFFFF);
+	return std::make_shared<z80::memory>(builder.build());
+}
+
+static void setup(z80::cpu& cpu, const block_setup& setup, std::uint32_t seed)
+{
+	// the same random content for the cpus under comparison
+	for(std::uint32_t addr = 0x1000; addr < 0x4000; ++addr)
+		cpu.memory().write<std::uint8_t>(static_cast<std::uint16_t>(addr), static_cast<std::uint8_t>(addr * seed >> 7));
+
+	cpu.memory().write<std::uint8_t>(0x0000, 0xED);
+	cpu.memory().write<std::uint8_t>(0x0001, setup.opcode);
+	cpu.memory().write<std::uint8_t>(0x0002, 0x76); // HALT
+
+	auto& regs = cpu.registers();
+	regs.main_set.BC = static_cast<std::int16_t>(setup.bc);
+	regs.main_set.DE = static_cast<std::int16_t>(setup.de);
+	regs.main_set.HL = static_cast<std::int16_t>(setup.hl);
+	regs.main_set.A = static_cast<std::int8_t>(setup.a);
+}
+
+static void assert_equal(z80::cpu& expected, z80::cpu& actual)
+{
+	auto& exp_regs = expected.registers();
+	auto& act_regs = actual.registers();
+
+	ASSERT_EQ(exp_regs.PC, act_regs.PC);
+	ASSERT_EQ(exp_regs.main_set.AF, act_regs.main_set.AF);
+	ASSERT_EQ(exp_regs.main_set.BC, act_regs.main_set.BC);
+	ASSERT_EQ(exp_regs.main_set.DE, act_regs.main_set.DE);
+	ASSERT_EQ(exp_regs.main_set.HL, act_regs.main_set.HL);
+
+	for(std::uint32_t addr = 0x1000; addr < 0x4000; ++addr)
+	{
+		auto a = static_cast<std::uint16_t>(addr);
+		ASSERT_EQ(expected.memory().read<std::uint8_t>(a), actual.memory().read<std::uint8_t>(a)) << "address " << addr;
+	}
+}
+
+/* Executing the whole block instruction with budget must give exactly the same result
+ * as executing it iteration by iteration, the budget may end in the middle of the instruction */
+static void check_block_instruction(const block_setup& block)
+{
+	const auto seed = random::next<std::uint8_t>() | 1u;
+
+	z80::cpu expected(make_memory(block.mirrored_ram));
+	z80::cpu actual(make_memory(block.mirrored_ram));
+	setup(expected, block, seed);
+	setup(actual, block, seed);
+
+	// stop somewhere in the middle
+	const std::uint32_t budget = 100 + random::in_range<std::uint32_t>(0, 200);
+
+	std::uint32_t elapsed = 0;
+	while(elapsed < budget)
+		elapsed += expected.execute_one();
+
+	ASSERT_EQ(elapsed, budget + actual.execute(budget));
+	assert_equal(expected, actual);
+
+	// run till the end of instruction
+	std::uint32_t total = 0;
+	while(expected.registers().PC == 0)
+		total += expected.execute_one();
+
+	ASSERT_EQ(0u, actual.execute(total));
+	assert_equal(expected, actual);
+}
+
+TEST(Z80_BLOCK_INSTRUCTIONS, LDIR)
+{
+	check_block_instruction({0xB0, 100, 0x2000, 0x1000});
+	check_block_instruction({0xB0, 3, 0x2000, 0x1000});
+
+	// overlapped blocks
+	check_block_instruction({0xB0, 100, 0x1001, 0x1000});
+	check_block_instruction({0xB0, 100, 0x1000, 0x1010});
+
+	// the instruction overwrites itself with NOPs
+	check_block_instruction({0xB0, 100, 0xFFF0, 0x5000});
+
+	// the same through the RAM mirror
+	check_block_instruction({0xB0, 100, 0x1FFC, 0x5000, 0, true});
+}
+
+TEST(Z80_BLOCK_INSTRUCTIONS, LDDR)
+{
+	check_block_instruction({0xB8, 100, 0x2000, 0x1800});
+	check_block_instruction({0xB8, 100, 0x1FFF, 0x2000});
+	check_block_instruction({0xB8, 100, 0x0010, 0x5000});
+	check_block_instruction({0xB8, 100, 0x2004, 0x5000, 0, true});
+}
+
+TEST(Z80_BLOCK_INSTRUCTIONS, CPIR)
+{
+	// A is likely found in the middle
+	check_block_instruction({0xB1, 100, 0x0000, 0x1000, 0x10});
+	check_block_instruction({0xB1, 100, 0x0000, 0x1000, 0x00});
+}
+
+TEST(Z80_BLOCK_INSTRUCTIONS, CPDR)
+{
+	check_block_instruction({0xB9, 100, 0x0000, 0x3000, 0x10});
+	check_block_instruction({0xB9, 100, 0x0000, 0x3000, 0x00});
+}
+
+TEST(Z80_BLOCK_INSTRUCTIONS, INTERRUPT_BREAKS_BLOCK_INSTRUCTION)
+{
+	z80::cpu cpu(std::make_shared<z80::memory>());
+	setup(cpu, {0xB0, 100, 0x2000, 0x1000}, 1);
+
+	// EI; LDIR
+	cpu.memory().write<std::uint8_t>(0x0000, 0xFB);
+	cpu.memory().write<std::uint8_t>(0x0001, 0xED);
+	cpu.memory().write<std::uint8_t>(0x0002, 0xB0);
+	cpu.registers().SP = 0x0100;
+	cpu.interrupt_mode(z80::cpu_interrupt_mode::im1);
+	cpu.bus().set(z80::bus::INT);
+
+	ASSERT_EQ(0u, cpu.execute(4));
+
+	// the budget covers 2 iterations, but the pending interrupt is accepted right after the first one
+	cpu.execute(21 + 1);
+	ASSERT_EQ(99, cpu.registers().main_set.BC);
+	ASSERT_EQ(0x0038, cpu.registers().PC);
+}
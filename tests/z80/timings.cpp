@@ -0,0 +1,91 @@
+#include "z80/cpu.h"
+
+#include <gtest/gtest.h>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+using namespace genesis;
+
+
+static void load(z80::cpu& cpu, std::initializer_list<std::uint8_t> program)
+{
+	z80::memory::address addr = 0;
+	for(auto byte : program)
+		cpu.memory().write<std::uint8_t>(addr++, byte);
+}
+
+static void assert_cycles(z80::cpu& cpu, const std::vector<std::uint32_t>& expected)
+{
+	for(std::size_t i = 0; i < expected.size(); ++i)
+		ASSERT_EQ(expected[i], cpu.execute_one()) << "instruction: " << i << ", PC: " << cpu.registers().PC;
+}
+
+TEST(Z80_TIMINGS, INSTRUCTION_CYCLES)
+{
+	z80::cpu cpu(std::make_shared<z80::memory>());
+	load(cpu, {
+		0x00,					// NOP
+		0x01, 0x34, 0x12,		// LD BC, 0x1234
+		0xDD, 0x21, 0x00, 0x30, // LD IX, 0x3000
+		0xDD, 0x86, 0x00,		// ADD A, (IX+0)
+		0xDD, 0xCB, 0x00, 0x46, // BIT 0, (IX+0)
+		0xDD, 0xCB, 0x00, 0xC6, // SET 0, (IX+0)
+		0xCB, 0x46,				// BIT 0, (HL)
+		0xED, 0x44,				// NEG
+		0x76,					// HALT
+	});
+
+	assert_cycles(cpu, {4, 10, 14, 19, 20, 23, 12, 8, 4, 4, 4});
+}
+
+TEST(Z80_TIMINGS, CONDITIONAL_INSTRUCTIONS)
+{
+	z80::cpu cpu(std::make_shared<z80::memory>());
+	load(cpu, {
+		0xAF,			  // XOR A (Z = 1)
+		0x28, 0x00,		  // JR Z, +0 (taken)
+		0x20, 0x00,		  // JR NZ, +0 (not taken)
+		0x06, 0x02,		  // LD B, 2
+		0x10, 0xFE,		  // DJNZ $ (taken once)
+		0xC4, 0x00, 0x00, // CALL NZ, 0 (not taken)
+		0xCC, 0x20, 0x00, // CALL Z, 0x0020 (taken)
+	});
+	cpu.memory().write<std::uint8_t>(0x20, 0xC0); // RET NZ (not taken)
+	cpu.memory().write<std::uint8_t>(0x21, 0xC8); // RET Z (taken)
+
+	assert_cycles(cpu, {4, 12, 7, 7, 13, 8, 10, 17, 5, 11});
+	ASSERT_EQ(0x0F, cpu.registers().PC);
+}
+
+TEST(Z80_TIMINGS, REPEATED_BLOCK_INSTRUCTIONS)
+{
+	z80::cpu cpu(std::make_shared<z80::memory>());
+	load(cpu, {
+		0x01, 0x03, 0x00, // LD BC, 3
+		0x21, 0x00, 0x10, // LD HL, 0x1000
+		0x11, 0x00, 0x20, // LD DE, 0x2000
+		0xED, 0xB0,		  // LDIR
+	});
+
+	// every iteration but the last one takes 21 T-states
+	assert_cycles(cpu, {10, 10, 10, 21, 21, 16});
+	ASSERT_EQ(0x0B, cpu.registers().PC);
+}
+
+TEST(Z80_TIMINGS, EXECUTE_RETURNS_OVERSHOOT)
+{
+	// NOPs only
+	z80::cpu cpu(std::make_shared<z80::memory>());
+	load(cpu, {});
+
+	ASSERT_EQ(0u, cpu.execute(0));
+	ASSERT_EQ(0, cpu.registers().PC);
+
+	// 3 NOPs are required to cover 10 T-states
+	ASSERT_EQ(2u, cpu.execute(10));
+	ASSERT_EQ(3, cpu.registers().PC);
+
+	ASSERT_EQ(0u, cpu.execute(8));
+	ASSERT_EQ(5, cpu.registers().PC);
+}